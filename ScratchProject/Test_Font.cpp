@@ -1,5 +1,7 @@
 ﻿#include "pch.h"
 
+#include <chrono>
+
 #include <XivAlexanderCommon/Sqex_FontCsv_CreateConfig.h>
 #include <XivAlexanderCommon/Sqex_FontCsv_Creator.h>
 #include <XivAlexanderCommon/Sqex_FontCsv_DirectWriteFont.h>
@@ -13,6 +15,7 @@
 #include <XivAlexanderCommon/Sqex_Sqpack_EntryRawStream.h>
 #include <XivAlexanderCommon/Sqex_Sqpack_Reader.h>
 #include <XivAlexanderCommon/Sqex_Texture_Mipmap.h>
+#include <XivAlexanderCommon/Utils_Win32_ThreadPool.h>
 
 static const auto* const pszTestString = reinterpret_cast<const char*>(
 	u8"Uppercase: ABCDEFGHIJKLMNOPQRSTUVWXYZ\n"
@@ -152,6 +155,7 @@ void compile() {
 		auto cfg = j.get<Sqex::FontCsv::CreateConfig::FontCreateConfig>();
 		isArgb32 = cfg.textureFormat != Sqex::Texture::Format::RGBA4444;
 
+		const auto start = std::chrono::steady_clock::now();
 		Sqex::FontCsv::FontSetsCreator creator(cfg, R"(C:\Program Files (x86)\FINAL FANTASY XIV - KOREA\game\)");
 		// Sqex::FontCsv::FontSetsCreator creator(cfg, R"(C:\Program Files (x86)\SquareEnix\FINAL FANTASY XIV - A Realm Reborn\game)");
 		while (!creator.Wait(100)) {
@@ -160,9 +164,10 @@ void compile() {
 		}
 		result = creator.GetResult();
 
-		std::cout << "Done!                 \n";
+		std::cout << std::format("Done in {:.2f}s!                 \n", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
 		for (const auto& [t, f] : result.Result) {
-			std::cout << std::format("\t=> {}: {} files\n", t, f.Textures.size());
+			std::cout << std::format("\t=> {}: {} files, {} glyphs in {} planes, {:.1f}% filled\n",
+				t, f.Textures.size(), f.Statistics.GlyphCount, f.Statistics.PlaneCount, f.Statistics.FillRatio() * 100);
 		}
 	} catch (const std::exception& e) {
 		std::cout << e.what() << std::endl;
@@ -243,10 +248,172 @@ void compile() {
 	}
 }
 
+// Draws a block of Hangul syllables with borders of several thicknesses, by drawing the glyph at every offset in the border
+// square as FontCsvCreator used to, and by RenderTarget::DrawGlyph; reports glyphs per second and how far the outputs differ.
+void benchmark_glyph_border(const wchar_t* fontName, int fontSize, size_t glyphCount) {
+	const auto font = std::make_shared<Sqex::FontCsv::FreeTypeDrawingFont<uint8_t>>(fontName, static_cast<float>(fontSize));
+	std::vector<char32_t> glyphs;
+	for (char32_t c = U'\uAC00'; c <= U'\uD7A3' && glyphs.size() < glyphCount; ++c) {
+		if (font->HasCharacter(c))
+			glyphs.push_back(c);
+	}
+
+	for (const uint8_t thickness : {1, 2, 3, 4, 6}) {
+		const auto cell = static_cast<uint16_t>(font->LineHeight() * 2 + 2 * thickness);
+		const auto columns = static_cast<uint16_t>(4096 / cell);
+		const auto rows = static_cast<uint16_t>((glyphs.size() + columns - 1) / columns);
+
+		const auto measure = [&](const char* name, const auto& draw) {
+			const auto atlas = std::make_shared<Sqex::Texture::MemoryBackedMipmap>(static_cast<uint16_t>(cell * columns), static_cast<uint16_t>(cell * rows), Sqex::Texture::Format::L8_1,
+				std::vector<uint8_t>(static_cast<size_t>(cell) * columns * cell * rows));
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < glyphs.size(); ++i)
+				draw(atlas.get(), static_cast<SSIZE_T>(i % columns * cell), static_cast<SSIZE_T>(i / columns * cell), glyphs[i]);
+			const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			std::cout << std::format("Thickness {}, {}: {:.0f} glyphs/s\n", thickness, name, static_cast<double>(glyphs.size()) / elapsed);
+			return atlas->ReadStreamIntoVector<uint8_t>(0);
+		};
+
+		const auto reference = measure("per offset", [&](Sqex::Texture::MemoryBackedMipmap* to, SSIZE_T x, SSIZE_T y, char32_t c) {
+			for (auto i = 0; i <= 2 * thickness; ++i)
+				for (auto j = 0; j <= 2 * thickness; ++j)
+					font->Draw(to, x + i, y + j, c, 0x80, 0, 0xFF, 0);
+			font->Draw(to, x + thickness, y + thickness, c, 0xFF, 0, 0xFF, 0);
+		});
+		const auto dilated = measure("dilation", [&](Sqex::Texture::MemoryBackedMipmap* to, SSIZE_T x, SSIZE_T y, char32_t c) {
+			Sqex::FontCsv::FontCsvCreator::RenderTarget::DrawGlyph(to, x, y, c, font.get(), thickness, 0x80);
+		});
+
+		int maxDifference = 0;
+		uint64_t totalDifference = 0;
+		for (size_t i = 0; i < reference.size(); ++i) {
+			const auto difference = std::abs(static_cast<int>(reference[i]) - dilated[i]);
+			maxDifference = std::max(maxDifference, difference);
+			totalDifference += difference;
+		}
+		std::cout << std::format("Thickness {}: max difference {}, mean difference {:.4f}\n", thickness, maxDifference, static_cast<double>(totalDifference) / static_cast<double>(reference.size()));
+	}
+}
+
+void benchmark_glyph_lookup(size_t repeatCount) {
+	Sqex::FontCsv::ModifiableFontCsvStream stream;
+	const auto addRange = [&](char32_t from, char32_t to) {
+		for (auto c = from; c <= to; ++c)
+			stream.AddFontEntry(c, 0, static_cast<uint16_t>(c % 64 * 16), static_cast<uint16_t>(c / 64 % 64 * 16), 12, 14, static_cast<int8_t>(c % 3), 0);
+	};
+	addRange(U'\u0020', U'\u007E');
+	addRange(U'\u3000', U'\u30FF');
+	addRange(U'\u4E00', U'\u9FFF');
+	addRange(U'\uAC00', U'\uD7A3');
+	addRange(U'\uFF01', U'\uFFEF');
+	for (auto l = U'\u0020'; l <= U'\u007E'; ++l)
+		for (auto r = U'\u0020'; r <= U'\u007E'; ++r)
+			if ((l * 31 + r) % 7 == 0)
+				stream.AddKerning(l, r, static_cast<int>((l + r) % 5) - 2);
+
+	std::u32string text;
+	for (size_t i = 0; i < repeatCount; ++i)
+		text += Sqex::FontCsv::ToU32(pszTestString);
+
+	const auto& entries = stream.GetFontTableEntries();
+	const auto& kernings = stream.GetKerningEntries();
+	const auto binarySearchEntry = [&](char32_t c) -> const Sqex::FontCsv::FontTableEntry* {
+		const auto val = Sqex::FontCsv::UnicodeCodePointToUtf8Uint32(c);
+		const auto it = std::ranges::lower_bound(entries, val, {}, [](const Sqex::FontCsv::FontTableEntry& e) { return e.Utf8Value.Value(); });
+		return it == entries.end() || it->Utf8Value != val ? nullptr : &*it;
+	};
+	const auto binarySearchKerning = [&](char32_t l, char32_t r) -> int {
+		const auto key = std::make_pair(Sqex::FontCsv::UnicodeCodePointToUtf8Uint32(l), Sqex::FontCsv::UnicodeCodePointToUtf8Uint32(r));
+		const auto it = std::ranges::lower_bound(kernings, key, {}, [](const Sqex::FontCsv::KerningEntry& e) {
+			return std::make_pair(e.LeftUtf8Value.Value(), e.RightUtf8Value.Value());
+		});
+		return it == kernings.end() || it->LeftUtf8Value != key.first || it->RightUtf8Value != key.second ? 0 : static_cast<int>(it->RightOffset);
+	};
+
+	const auto layout = [&](const char* name, const auto& getEntry, const auto& getKerning) {
+		const auto start = std::chrono::steady_clock::now();
+		int64_t x = 0;
+		char32_t last = 0;
+		for (const auto c : text) {
+			if (const auto entry = getEntry(c)) {
+				x += getKerning(last, c) + entry->BoundingWidth + entry->NextOffsetX;
+				last = c;
+			}
+		}
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << std::format("{}: {:.1f}M characters/s (width {})\n", name, static_cast<double>(text.size()) / elapsed / 1000000., x);
+		return x;
+	};
+
+	void(stream.GetFontEntry(0));  // build lookup tables outside the measurement
+	const auto reference = layout("binary search", binarySearchEntry, binarySearchKerning);
+	const auto accelerated = layout("lookup table", [&](char32_t c) { return stream.GetFontEntry(c); }, [&](char32_t l, char32_t r) { return stream.GetKerningDistance(l, r); });
+	if (reference != accelerated)
+		throw std::runtime_error("layout mismatch");
+}
+
+void benchmark_atlas_finalize(const wchar_t* fontName, int fontSize, size_t textureCount) {
+	const auto font = std::make_shared<Sqex::FontCsv::FreeTypeDrawingFont<uint8_t>>(fontName, static_cast<float>(fontSize));
+
+	for (const auto format : {Sqex::Texture::Format::RGBA4444, Sqex::Texture::Format::RGBA_1}) {
+		// Finalize consumes the drawn planes, so each format gets its own atlas.
+		Sqex::FontCsv::FontCsvCreator::RenderTarget target(1024, 1024, 1);
+		for (char32_t c = U'\u4E00'; c <= U'\u9FFF' && target.GetPackingStatistics().TextureCount() < textureCount; ++c) {
+			const auto bbox = font->Measure(0, 0, c);
+			if (bbox.EffectivelyEmpty())
+				continue;
+			void(target.QueueDraw(c, font.get(), -bbox.left, -bbox.top, static_cast<uint8_t>(bbox.Width()), static_cast<uint8_t>(bbox.Height()), 0, 0));
+		}
+		Utils::Win32::ParallelFor(std::thread::hardware_concurrency(), [&](size_t) {
+			while (target.WorkOnNextItem());
+		});
+
+		std::vector<std::vector<uint8_t>> planes;
+		for (const auto& plane : target.AsMipmapStreamVector())
+			planes.emplace_back(plane->ReadStreamIntoVector<uint8_t>(0));
+		while (planes.size() % 4)
+			planes.emplace_back(planes[0].size());
+
+		const auto pixelCount = planes[0].size();
+		const auto pageSize = Sqex::Texture::RawDataLength(format, pixelCount, 1);
+		std::vector<uint8_t> reference(planes.size() / 4 * pageSize);
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < planes.size() / 4; ++i) {
+			const auto& b = planes[i * 4 + 0];
+			const auto& g = planes[i * 4 + 1];
+			const auto& r = planes[i * 4 + 2];
+			const auto& a = planes[i * 4 + 3];
+			for (size_t j = 0; j < pixelCount; ++j) {
+				if (format == Sqex::Texture::Format::RGBA4444)
+					reinterpret_cast<Sqex::Texture::RGBA4444*>(&reference[i * pageSize])[j].SetFrom(r[j] * 15 / 255, g[j] * 15 / 255, b[j] * 15 / 255, a[j] * 15 / 255);
+				else
+					reinterpret_cast<Sqex::Texture::RGBA8888*>(&reference[i * pageSize])[j].SetFrom(r[j], g[j], b[j], a[j]);
+			}
+		}
+		const auto scalarElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		target.Finalize(format);
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::vector<uint8_t> result;
+		for (const auto& page : target.AsMipmapStreamVector()) {
+			const auto data = page->ReadStreamIntoVector<uint8_t>(0);
+			result.insert(result.end(), data.begin(), data.end());
+		}
+		std::cout << std::format("{} pages of {}: scalar {:.1f}ms, finalize {:.1f}ms, {}\n",
+			planes.size() / 4, format == Sqex::Texture::Format::RGBA4444 ? "RGBA4444" : "RGBA8888",
+			scalarElapsed * 1000, elapsed * 1000, result == reference ? "identical" : "different");
+	}
+}
+
 int main() {
 	// system("chcp 65001");
 	// test_showcase<true>();
 	// test_direct();
 	compile();
+	// benchmark_glyph_border(L"Gulim", 24, 4096);
+	// benchmark_glyph_lookup(10000);
+	// benchmark_atlas_finalize(L"Microsoft YaHei", 64, 16);
 	return 0;
 }
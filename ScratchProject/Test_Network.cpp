@@ -0,0 +1,175 @@
+#include "pch.h"
+
+#include <XivAlexanderCommon/Sqex_Network_Capture.h>
+#include <XivAlexanderCommon/Sqex_Network_IpcTypeFinder.h>
+#include <XivAlexanderCommon/Sqex_Network_SingleStream.h>
+#include <XivAlexanderCommon/Sqex_Network_Structures.h>
+
+using namespace Sqex::Network;
+
+std::vector<uint8_t> MakeIpcMessage(uint32_t length, uint32_t sourceActor, uint32_t currentActor, uint16_t subType) {
+	std::vector<uint8_t> buf(length);
+	auto& message = *reinterpret_cast<Structures::FFXIVMessage*>(buf.data());
+	message.Length = length;
+	message.SourceActor = sourceActor;
+	message.CurrentActor = currentActor;
+	message.Type = Structures::SegmentType::IPC;
+	message.Data.IPC.Type = Structures::IpcType::InterestedType;
+	message.Data.IPC.SubType = subType;
+	return buf;
+}
+
+std::vector<uint8_t> MakeBundle(const std::vector<std::vector<uint8_t>>& messages) {
+	std::vector<uint8_t> buf(Structures::GamePacketHeaderSize);
+	for (const auto& message : messages)
+		buf.insert(buf.end(), message.begin(), message.end());
+
+	auto& bundle = *reinterpret_cast<Structures::FFXIVBundle*>(buf.data());
+	std::copy_n(Structures::FFXIVBundle::MagicConstant1, sizeof bundle.Magic, bundle.Magic);
+	bundle.TotalLength = static_cast<uint32_t>(buf.size());
+	bundle.MessageCount = static_cast<uint16_t>(messages.size());
+	return buf;
+}
+
+// Writes a capture, cuts it at every length that leaves the last record incomplete, and checks that only that record goes missing.
+void test_capture_round_trip() {
+	const auto path = std::filesystem::temp_directory_path() / L"XivAlexander_Test_Network.xacap";
+	const std::vector<std::pair<Capture::Direction, std::vector<uint8_t>>> records{
+		{Capture::Direction::Recv, std::vector<uint8_t>(100, 0x11)},
+		{Capture::Direction::Send, std::vector<uint8_t>(50, 0x22)},
+		{Capture::Direction::Recv, std::vector<uint8_t>(200, 0x33)},
+	};
+
+	{
+		Capture::Writer writer(path);
+		for (const auto& [direction, data] : records)
+			writer.Write(direction, data);
+	}
+	const auto fullSize = std::filesystem::file_size(path);
+
+	const auto check = [&](size_t expectedCount) {
+		const Capture::Reader reader(path);
+		const auto& read = reader.Records();
+		if (read.size() != expectedCount)
+			throw std::runtime_error(std::format("{} bytes: {} records instead of {}", std::filesystem::file_size(path), read.size(), expectedCount));
+		for (size_t i = 0; i < read.size(); ++i) {
+			if (read[i].Direction != records[i].first || !std::ranges::equal(read[i].Data, records[i].second))
+				throw std::runtime_error(std::format("{} bytes: record {} differs", std::filesystem::file_size(path), i));
+			if (i && read[i].TimestampMicroseconds < read[i - 1].TimestampMicroseconds)
+				throw std::runtime_error(std::format("{} bytes: record {} goes back in time", std::filesystem::file_size(path), i));
+		}
+	};
+
+	check(records.size());
+
+	// Cut inside the data of the last record, then inside its header.
+	const auto lastRecordSize = sizeof(Capture::RecordHeader) + records.back().second.size();
+	for (size_t cut = 1; cut < lastRecordSize; ++cut) {
+		std::filesystem::resize_file(path, fullSize - cut);
+		check(records.size() - 1);
+	}
+
+	std::filesystem::remove(path);
+	std::cout << "Capture round trip: OK\n";
+}
+
+// Replays a capture with bundles split across records through IpcTypeFinder, and checks what it finds.
+void test_capture_replay() {
+	const auto path = std::filesystem::temp_directory_path() / L"XivAlexander_Test_Network.xacap";
+
+	auto actionEffect = MakeIpcMessage(0x9c, 1, 1, 0x0100);
+	reinterpret_cast<Structures::FFXIVMessage*>(actionEffect.data())->Data.IPC.Data.S2C_ActionEffect.ActionId = 0x1234;
+	auto actionRequest = MakeIpcMessage(0x40, 1, 1, 0x0200);
+	reinterpret_cast<Structures::FFXIVMessage*>(actionRequest.data())->Data.IPC.Data.C2S_ActionRequest.ActionId = 0x1234;
+	const auto recvBundle = MakeBundle({actionEffect, MakeIpcMessage(0x38, 2, 1, 0x0300)});
+	const auto sendBundle = MakeBundle({actionRequest});
+
+	{
+		Capture::Writer writer(path);
+		writer.Write(Capture::Direction::Send, sendBundle);
+		writer.Write(Capture::Direction::Recv, std::span(recvBundle).subspan(0, recvBundle.size() / 2));
+		writer.Write(Capture::Direction::Recv, std::span(recvBundle).subspan(recvBundle.size() / 2));
+	}
+
+	std::vector<std::string> incoming, outgoing;
+	const Capture::MessageHandler findIncoming = [&incoming](Structures::FFXIVMessage* pMessage) {
+		IpcTypeFinder::FindIncoming(*pMessage, [&incoming](const std::string& description, bool) { incoming.emplace_back(description); });
+		return true;
+	};
+	const Capture::MessageHandler findOutgoing = [&outgoing](Structures::FFXIVMessage* pMessage) {
+		IpcTypeFinder::FindOutgoing(*pMessage, [&outgoing](const std::string& description, bool) { outgoing.emplace_back(description); });
+		return true;
+	};
+
+	const Capture::Reader reader(path);
+	const auto result = Capture::Replay(reader, false, findIncoming, findOutgoing);
+	std::filesystem::remove(path);
+
+	if (result.Recv.RecordCount != 2 || result.Recv.MessageLatencyNanoseconds.size() != 2)
+		throw std::runtime_error(std::format("recv: {} records, {} messages", result.Recv.RecordCount, result.Recv.MessageLatencyNanoseconds.size()));
+	if (result.Send.RecordCount != 1 || result.Send.MessageLatencyNanoseconds.size() != 1)
+		throw std::runtime_error(std::format("send: {} records, {} messages", result.Send.RecordCount, result.Send.MessageLatencyNanoseconds.size()));
+	if (incoming.size() != 1 || !incoming[0].starts_with("S2C_ActionEffect01(0x0100)") || incoming[0].find("actionId=1234") == std::string::npos)
+		throw std::runtime_error(std::format("incoming: {} candidates{}", incoming.size(), incoming.empty() ? "" : ", first: " + incoming[0]));
+	if (outgoing.size() != 1 || !outgoing[0].starts_with("C2S_ActionRequest/GroundTargeted(0x0200)") || outgoing[0].find("actionId=1234") == std::string::npos)
+		throw std::runtime_error(std::format("outgoing: {} candidates{}", outgoing.size(), outgoing.empty() ? "" : ", first: " + outgoing[0]));
+	std::cout << "Capture replay: OK\n";
+}
+
+// Tunnels a bundle through a handler that modifies every message but throws halfway through the second, and checks that only that one goes through unchanged.
+void test_tunnel_handler_error() {
+	const std::vector messages{MakeIpcMessage(0x38, 1, 1, 0x0100), MakeIpcMessage(0x40, 2, 1, 0x0200), MakeIpcMessage(0x38, 3, 1, 0x0300)};
+	const auto bundle = MakeBundle(messages);
+
+	SingleStream raw, processed;
+	raw.Write(std::span(bundle));
+
+	size_t errors = 0;
+	raw.TunnelXivStream(processed, [](Structures::FFXIVMessage* pMessage) {
+		pMessage->CurrentActor = 0xFFFFFFFF;
+		if (pMessage->SourceActor == 2)
+			throw std::runtime_error("handler failure");
+		return true;
+	}, [&errors](const Structures::FFXIVBundle&, const std::exception&) { ++errors; });
+
+	std::vector<uint8_t> result(processed.Available());
+	void(processed.Read(result.data(), result.size()));
+
+	auto expected = messages;
+	reinterpret_cast<Structures::FFXIVMessage*>(expected[0].data())->CurrentActor = 0xFFFFFFFF;
+	reinterpret_cast<Structures::FFXIVMessage*>(expected[2].data())->CurrentActor = 0xFFFFFFFF;
+	if (errors != 1 || result != MakeBundle(expected))
+		throw std::runtime_error(std::format("{} errors, {} bytes out of {}", errors, result.size(), bundle.size()));
+	std::cout << "Tunnel handler error: OK\n";
+}
+
+// Lists what IpcTypeFinder makes of each message in a capture saved with XivAlexander.
+void find_ipc_types(const std::filesystem::path& path) {
+	const Capture::Reader reader(path);
+	const auto print = [](const char* direction) {
+		return [direction](const std::string& description, bool) { std::cout << std::format("{}: {}\n", direction, description); };
+	};
+	const Capture::MessageHandler findIncoming = [onCandidate = print("recv")](Structures::FFXIVMessage* pMessage) {
+		IpcTypeFinder::FindIncoming(*pMessage, onCandidate);
+		return true;
+	};
+	const Capture::MessageHandler findOutgoing = [onCandidate = print("send")](Structures::FFXIVMessage* pMessage) {
+		IpcTypeFinder::FindOutgoing(*pMessage, onCandidate);
+		return true;
+	};
+
+	const auto result = Capture::Replay(reader, false, findIncoming, findOutgoing);
+	std::cout << std::format("{}: {} recv and {} send messages in {:.1f}ms\n",
+		path.filename().string(),
+		result.Recv.MessageLatencyNanoseconds.size(),
+		result.Send.MessageLatencyNanoseconds.size(),
+		std::chrono::duration<double, std::milli>(result.Elapsed).count());
+}
+
+int main() {
+	test_capture_round_trip();
+	test_capture_replay();
+	test_tunnel_handler_error();
+	// find_ipc_types(LR"(C:\Users\Public\XivAlexander\Captures\capture.xacap)");
+	return 0;
+}
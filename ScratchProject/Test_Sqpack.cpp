@@ -0,0 +1,639 @@
+#include "pch.h"
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include <Psapi.h>
+
+#include <XivAlexanderCommon/Sqex_Sqpack_Creator.h>
+#include <XivAlexanderCommon/Sqex_Sqpack_EntryRawStream.h>
+#include <XivAlexanderCommon/Sqex_Sqpack_Reader.h>
+#include <XivAlexanderCommon/XaZlib.h>
+
+static const auto GameSqpackPath = std::filesystem::path(LR"(C:\Program Files (x86)\SquareEnix\FINAL FANTASY XIV - A Realm Reborn\game\sqpack)");
+
+static std::vector<std::filesystem::path> ListIndexFiles() {
+	std::vector<std::filesystem::path> res;
+	for (const auto& expac : std::filesystem::directory_iterator(GameSqpackPath)) {
+		if (!expac.is_directory())
+			continue;
+		for (const auto& sqpack : std::filesystem::directory_iterator(expac)) {
+			if (sqpack.path().extension() == L".index")
+				res.emplace_back(sqpack.path());
+		}
+	}
+	std::ranges::sort(res);
+	return res;
+}
+
+static PROCESS_MEMORY_COUNTERS_EX GetMemoryCounters() {
+	PROCESS_MEMORY_COUNTERS_EX pmc{};
+	GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof pmc);
+	return pmc;
+}
+
+void benchmark_reader_open(bool memoryMappedIndex) {
+	const auto indexFiles = ListIndexFiles();
+
+	const auto before = GetMemoryCounters();
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::unique_ptr<Sqex::Sqpack::Reader>> readers;
+	for (const auto& indexFile : indexFiles)
+		readers.emplace_back(std::make_unique<Sqex::Sqpack::Reader>(indexFile, false, memoryMappedIndex));
+
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	const auto after = GetMemoryCounters();
+
+	// Entry list is built on demand; measure it separately from opening.
+	size_t entryCount = 0;
+	const auto enumerateStart = std::chrono::steady_clock::now();
+	for (const auto& reader : readers)
+		entryCount += reader->GetEntryInfo().size();
+	const auto enumerateElapsed = std::chrono::steady_clock::now() - enumerateStart;
+	const auto afterEnumerate = GetMemoryCounters();
+
+	std::cout << std::format("{}: {} index files, open {}ms, private +{}KiB, working set +{}KiB\n",
+		memoryMappedIndex ? "Mapped" : "Buffered",
+		indexFiles.size(),
+		std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(),
+		(static_cast<int64_t>(after.PrivateUsage) - static_cast<int64_t>(before.PrivateUsage)) / 1024,
+		(static_cast<int64_t>(after.WorkingSetSize) - static_cast<int64_t>(before.WorkingSetSize)) / 1024);
+	std::cout << std::format("{} entries, enumerate {}ms, private +{}KiB\n",
+		entryCount,
+		std::chrono::duration_cast<std::chrono::milliseconds>(enumerateElapsed).count(),
+		(static_cast<int64_t>(afterEnumerate.PrivateUsage) - static_cast<int64_t>(after.PrivateUsage)) / 1024);
+}
+
+// Replays the same recorded list of lookups against binary searches and hash table lookups.
+void benchmark_locator_lookup(size_t repeats) {
+	for (const auto& indexFile : ListIndexFiles()) {
+		const Sqex::Sqpack::Reader searchReader(indexFile, false, true, false);
+		const auto tableStart = std::chrono::steady_clock::now();
+		const Sqex::Sqpack::Reader tableReader(indexFile, false, true, true);
+		const auto tableBuildTime = std::chrono::steady_clock::now() - tableStart;
+
+		std::vector<Sqex::Sqpack::EntryPathSpec> lookups;
+		lookups.reserve(searchReader.GetEntryInfo().size());
+		for (const auto& entry : searchReader.GetEntryInfo() | std::views::values)
+			lookups.emplace_back(searchReader.PathSpecOf(entry));
+		std::ranges::shuffle(lookups, std::mt19937(0));
+
+		const auto replay = [&](const Sqex::Sqpack::Reader& reader) {
+			uint64_t checksum = 0;
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < repeats; ++i)
+				for (const auto& pathSpec : lookups)
+					checksum += reader.GetLocator(pathSpec).DatFileOffset();
+			return std::make_pair(std::chrono::steady_clock::now() - start, checksum);
+		};
+		const auto [searchTime, searchChecksum] = replay(searchReader);
+		const auto [tableTime, tableChecksum] = replay(tableReader);
+		if (searchChecksum != tableChecksum)
+			throw std::runtime_error(std::format("{}: lookup results differ", indexFile.filename().string()));
+
+		const auto lookupCount = static_cast<double>(lookups.size() * repeats);
+		std::cout << std::format("{}: {} entries, opening with table {}ms, search {:.1f}ns/lookup, table {:.1f}ns/lookup\n",
+			indexFile.filename().string(),
+			lookups.size(),
+			std::chrono::duration_cast<std::chrono::milliseconds>(tableBuildTime).count(),
+			std::chrono::duration<double, std::nano>(searchTime).count() / lookupCount,
+			std::chrono::duration<double, std::nano>(tableTime).count() / lookupCount);
+	}
+}
+
+// Reads the largest entries of an index whole, with and without parallel block inflation.
+void benchmark_parallel_decompression(const std::filesystem::path& indexFile, size_t entryCount) {
+	const Sqex::Sqpack::Reader reader(indexFile);
+
+	std::vector<std::pair<Sqex::Sqpack::SqIndex::LEDataLocator, Sqex::Sqpack::Reader::EntryInfoType>> entries(reader.GetEntryInfo().begin(), reader.GetEntryInfo().end());
+	std::ranges::sort(entries, [](const auto& l, const auto& r) { return l.second.Allocation > r.second.Allocation; });
+	entries.resize(std::min(entries.size(), entryCount));
+
+	for (const auto parallel : {false, true}) {
+		uint64_t totalBytes = 0;
+		std::vector<uint8_t> buf;
+		const auto start = std::chrono::steady_clock::now();
+		for (const auto& [locator, entryInfo] : entries) {
+			const auto stream = Sqex::Sqpack::EntryRawStream(reader.GetEntryProvider(reader.PathSpecOf(entryInfo), locator, entryInfo.Allocation), parallel);
+			buf.resize(static_cast<size_t>(stream.StreamSize()));
+			stream.ReadStream(0, std::span(buf));
+			totalBytes += buf.size();
+		}
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::cout << std::format("{}: {} entries, {}MiB, {:.0f}ms, {:.1f}MiB/s\n",
+			parallel ? "Parallel" : "Serial",
+			entries.size(),
+			totalBytes >> 20,
+			elapsed * 1000,
+			static_cast<double>(totalBytes) / 1048576 / elapsed);
+	}
+}
+
+// Reads entries in small sequential chunks, as the game does, with and without the decoded block cache.
+void benchmark_block_cache(const std::filesystem::path& indexFile, size_t entryCount, size_t chunkSize) {
+	const Sqex::Sqpack::Reader reader(indexFile);
+
+	std::vector<std::pair<Sqex::Sqpack::SqIndex::LEDataLocator, Sqex::Sqpack::Reader::EntryInfoType>> entries(reader.GetEntryInfo().begin(), reader.GetEntryInfo().end());
+	std::ranges::shuffle(entries, std::mt19937(0));
+	entries.resize(std::min(entries.size(), entryCount));
+
+	auto& cache = Sqex::Sqpack::DecodedBlockCache::Instance();
+	for (const auto capacity : {size_t{}, Sqex::Sqpack::DecodedBlockCache::DefaultCapacity}) {
+		cache.Capacity(capacity);
+		const auto before = cache.GetStatistics();
+
+		std::vector<uint8_t> buf(chunkSize);
+		const auto start = std::chrono::steady_clock::now();
+		for (const auto& [locator, entryInfo] : entries) {
+			const auto stream = Sqex::Sqpack::EntryRawStream(reader.GetEntryProvider(reader.PathSpecOf(entryInfo), locator, entryInfo.Allocation));
+			for (uint64_t offset = 0, size = stream.StreamSize(); offset < size; offset += chunkSize)
+				stream.ReadStreamPartial(offset, buf.data(), chunkSize);
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		const auto after = cache.GetStatistics();
+
+		std::cout << std::format("Capacity {}KiB: {}ms, hits {}, misses {}, evictions {}, {} entries using {}KiB\n",
+			capacity / 1024,
+			std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(),
+			after.Hits - before.Hits,
+			after.Misses - before.Misses,
+			after.Evictions - before.Evictions,
+			after.Entries,
+			after.Bytes / 1024);
+	}
+}
+
+// Issues many concurrent random asynchronous reads on virtual .dat streams, and compares the results against synchronous reads.
+// Returns the number of reads that failed or mismatched.
+static size_t StressAsyncReads(const Sqex::Sqpack::Creator::SqpackViews& views, size_t threadCount, size_t readsPerThread, size_t maxReadSize) {
+	std::atomic_size_t mismatches = 0, failures = 0;
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back([&, seed = static_cast<uint32_t>(i)]() {
+			std::mt19937_64 rng(seed);
+			std::vector<std::vector<uint8_t>> asyncBuffers(16), syncBuffers(16);
+			std::vector<std::pair<std::future<void>, std::pair<const Sqex::RandomAccessStream*, uint64_t>>> pending;
+
+			for (size_t j = 0; j < readsPerThread; j += asyncBuffers.size()) {
+				// Keep a batch of reads in flight at once.
+				for (size_t k = 0; k < asyncBuffers.size(); ++k) {
+					const auto& stream = views.Data[rng() % views.Data.size()];
+					const auto size = std::min<uint64_t>(1 + rng() % maxReadSize, stream->StreamSize());
+					const auto offset = rng() % (stream->StreamSize() - size + 1);
+					asyncBuffers[k].resize(static_cast<size_t>(size));
+					pending.emplace_back(stream->ReadStreamAsync(offset, asyncBuffers[k].data(), size), std::make_pair(stream.get(), offset));
+				}
+
+				for (size_t k = 0; k < pending.size(); ++k) {
+					auto& [future, request] = pending[k];
+					try {
+						future.get();
+					} catch (const std::exception& e) {
+						std::cout << std::format("Async read failed: {}\n", e.what());
+						++failures;
+						continue;
+					}
+
+					syncBuffers[k].resize(asyncBuffers[k].size());
+					request.first->ReadStream(request.second, syncBuffers[k].data(), syncBuffers[k].size());
+					if (syncBuffers[k] != asyncBuffers[k])
+						++mismatches;
+				}
+				pending.clear();
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	std::cout << std::format("{} threads * {} reads: {}ms, {} failures, {} mismatches\n",
+		threadCount,
+		readsPerThread,
+		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(),
+		failures.load(),
+		mismatches.load());
+	return failures + mismatches;
+}
+
+void stress_async_reads(const std::filesystem::path& indexFile, size_t threadCount, size_t readsPerThread, size_t maxReadSize) {
+	Sqex::Sqpack::Creator creator(
+		Utils::ToUtf8(indexFile.parent_path().filename().wstring()),
+		Utils::ToUtf8(indexFile.filename().replace_extension().replace_extension().wstring()));
+	if (const auto result = creator.AddEntriesFromSqPack(indexFile, true, true); !result.Error.empty())
+		throw std::runtime_error(std::format("{} entries failed to load", result.Error.size()));
+	void(StressAsyncReads(creator.AsViews(false), threadCount, readsPerThread, maxReadSize));
+}
+
+// Builds a virtual sqpack out of a directory of loose files laid out as in game paths, once per compression policy.
+void benchmark_compression_policy(const std::filesystem::path& modDir) {
+	std::vector<std::filesystem::path> files;
+	for (const auto& item : std::filesystem::recursive_directory_iterator(modDir)) {
+		if (item.is_regular_file())
+			files.emplace_back(item.path());
+	}
+
+	for (const auto& [policy, policyName] : std::vector<std::pair<Sqex::Sqpack::CompressionPolicy, const char*>>{
+		{Sqex::Sqpack::CompressionPolicy::Stored, "Stored"},
+		{Sqex::Sqpack::CompressionPolicy::Fast, "Fast"},
+		{Sqex::Sqpack::CompressionPolicy::Adaptive, "Adaptive"},
+		{Sqex::Sqpack::CompressionPolicy::Best, "Best"},
+	}) {
+		const auto start = std::chrono::steady_clock::now();
+
+		Sqex::Sqpack::Creator creator("ffxiv", "0a0000");
+		creator.EntryCompressionPolicy(policy);
+		for (const auto& file : files)
+			creator.AddEntryFromFile(relative(file, modDir), file);
+		const auto views = creator.AsViews(false);
+
+		// Entries are built on first read; read every .dat through to make sure all of them are.
+		uint64_t datSize = 0;
+		std::vector<uint8_t> buf(1048576);
+		for (const auto& data : views.Data) {
+			for (uint64_t offset = 0, size = data->StreamSize(); offset < size; offset += buf.size())
+				data->ReadStreamPartial(offset, buf.data(), buf.size());
+			datSize += data->StreamSize();
+		}
+
+		std::cout << std::format("{}: {} files, build {}ms, .dat {}KiB\n",
+			policyName,
+			files.size(),
+			std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(),
+			datSize / 1024);
+	}
+}
+
+// Round trips 16000 byte blocks of real entries, as sqpack stores them, through every pair of deflate backends, and measures their throughput.
+void test_deflate_backends(const std::filesystem::path& indexFile, size_t entryCount) {
+	const Sqex::Sqpack::Reader reader(indexFile);
+
+	std::vector<std::pair<Sqex::Sqpack::SqIndex::LEDataLocator, Sqex::Sqpack::Reader::EntryInfoType>> entries(reader.GetEntryInfo().begin(), reader.GetEntryInfo().end());
+	std::ranges::shuffle(entries, std::mt19937(0));
+	entries.resize(std::min(entries.size(), entryCount));
+
+	std::vector<std::vector<uint8_t>> blocks;
+	for (const auto& [locator, entryInfo] : entries) {
+		const auto data = Sqex::Sqpack::EntryRawStream(reader.GetEntryProvider(reader.PathSpecOf(entryInfo), locator, entryInfo.Allocation)).ReadStreamIntoVector<uint8_t>(0);
+		for (size_t offset = 0; offset < data.size(); offset += 16000)
+			blocks.emplace_back(data.begin() + offset, data.begin() + std::min(data.size(), offset + 16000));
+	}
+	blocks.emplace_back(1, 0);
+	blocks.emplace_back(16000, 0);
+	{
+		std::mt19937 rng(0);
+		auto& random = blocks.emplace_back(16000);
+		std::ranges::generate(random, [&]() { return static_cast<uint8_t>(rng()); });
+	}
+	const auto totalBytes = std::accumulate(blocks.begin(), blocks.end(), uint64_t(), [](uint64_t sum, const auto& block) { return sum + block.size(); });
+
+	std::vector<Utils::DeflateBackend> backends;
+	for (const auto backend : {Utils::DeflateBackend::Zlib, Utils::DeflateBackend::Libdeflate}) {
+		if (Utils::IsDeflateBackendAvailable(backend))
+			backends.push_back(backend);
+	}
+	const auto backendName = [](Utils::DeflateBackend backend) {
+		return backend == Utils::DeflateBackend::Zlib ? "zlib" : "libdeflate";
+	};
+
+	const auto previousBackend = Utils::GetDeflateBackend();
+	for (const auto level : {Z_BEST_SPEED, Z_DEFAULT_COMPRESSION, Z_BEST_COMPRESSION}) {
+		for (const auto compressBackend : backends) {
+			Utils::SetDeflateBackend(compressBackend);
+			Utils::ZlibReusableDeflater deflater(level, Z_DEFLATED, -15);
+			std::vector<std::vector<uint8_t>> compressed;
+			compressed.reserve(blocks.size());
+			auto start = std::chrono::steady_clock::now();
+			for (const auto& block : blocks) {
+				const auto result = deflater(block);
+				compressed.emplace_back(result.begin(), result.end());
+			}
+			const auto compressElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			const auto compressedBytes = std::accumulate(compressed.begin(), compressed.end(), uint64_t(), [](uint64_t sum, const auto& block) { return sum + block.size(); });
+			std::cout << std::format("Level {} {}: {} blocks, {:.1f}% size, deflate {:.1f}MiB/s\n",
+				level, backendName(compressBackend), blocks.size(), 100. * static_cast<double>(compressedBytes) / static_cast<double>(totalBytes),
+				static_cast<double>(totalBytes) / 1048576 / compressElapsed);
+
+			for (const auto decompressBackend : backends) {
+				Utils::SetDeflateBackend(decompressBackend);
+				Utils::ZlibReusableInflater inflater(-15);
+				std::vector<uint8_t> buf;
+				size_t mismatches = 0;
+				start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < blocks.size(); ++i) {
+					buf.resize(blocks[i].size());
+					if (!std::ranges::equal(inflater(compressed[i], std::span(buf)), blocks[i]))
+						mismatches++;
+				}
+				const auto decompressElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				// Whole buffer inflation of unknown size, and inflation into a buffer too small to hold everything.
+				for (size_t i = 0; i < blocks.size(); ++i) {
+					if (!std::ranges::equal(inflater(compressed[i]), blocks[i]))
+						mismatches++;
+					buf.resize(blocks[i].size() / 2);
+					if (!std::ranges::equal(inflater(compressed[i], std::span(buf)), std::span(blocks[i]).subspan(0, buf.size())))
+						mismatches++;
+				}
+
+				std::cout << std::format("\t{} to {}: inflate {:.1f}MiB/s, {} mismatches\n",
+					backendName(compressBackend), backendName(decompressBackend), static_cast<double>(totalBytes) / 1048576 / decompressElapsed, mismatches);
+			}
+		}
+	}
+	Utils::SetDeflateBackend(previousBackend);
+}
+
+// SqexHash as it was before SqexHashPath: normalizes a copy of the text, then runs slice-by-4 over SqexHashTable.
+static uint32_t BaselineSqexHash(std::string normalizedText) {
+	for (auto& c : normalizedText) {
+		if ('A' <= c && c <= 'Z')
+			c -= 'A' - 'a';
+		else if (c == '\\')
+			c = '/';
+	}
+	const auto len = normalizedText.size();
+	size_t i = 0;
+	uint32_t result = 0xFFFFFFFFUL;
+	for (; i < (len & ~3); i += 4) {
+		result ^= *reinterpret_cast<const uint32_t*>(&normalizedText[i]);
+		result = Sqex::Sqpack::SqexHashTable[3][result & 0xFF] ^
+			Sqex::Sqpack::SqexHashTable[2][(result >> 8) & 0xFF] ^
+			Sqex::Sqpack::SqexHashTable[1][(result >> 16) & 0xFF] ^
+			Sqex::Sqpack::SqexHashTable[0][(result >> 24) & 0xFF];
+	}
+	for (; i < len; ++i)
+		result = Sqex::Sqpack::SqexHashTable[0][(result ^ normalizedText[i]) & 0xFF] ^ (result >> 8);
+	return result;
+}
+
+static uint32_t BaselineSqexHash(const std::filesystem::path& path) {
+	return BaselineSqexHash(Utils::ToUtf8(path.lexically_normal().wstring()));
+}
+
+// Hashes typical game paths the way EntryPathSpec used to, one path at a time, and as a batch.
+void benchmark_path_hashing(size_t pathCount) {
+	std::vector<std::string> paths;
+	for (size_t i = 0; i < pathCount; ++i)
+		paths.emplace_back(std::format("chara/equipment/e{0:04}/texture/v{1:02}_c0101e{0:04}_{2}_d.tex", i % 10000, i / 10000 % 100, i % 2 ? "top" : "dwn"));
+	const std::vector<std::string_view> views(paths.begin(), paths.end());
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<Sqex::Sqpack::SqexPathHashes> reference;
+	for (const auto& path : paths) {
+		const auto normalized = std::filesystem::path(Utils::FromUtf8(path)).lexically_normal();
+		reference.push_back({BaselineSqexHash(normalized.parent_path()), BaselineSqexHash(normalized.filename()), BaselineSqexHash(normalized)});
+	}
+	const auto referenceElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// The hash is CRC-32 without the final inversion, so zlib gives an independent reference for the baseline itself.
+	for (size_t i = 0; i < std::min<size_t>(paths.size(), 16); ++i) {
+		if (reference[i].FullPathHash != ~static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(paths[i].data()), static_cast<uInt>(paths[i].size()))))
+			throw std::runtime_error(std::format("baseline hash of {} differs from CRC-32", paths[i]));
+	}
+
+	start = std::chrono::steady_clock::now();
+	std::vector<Sqex::Sqpack::SqexPathHashes> single;
+	for (const auto path : views)
+		single.push_back(Sqex::Sqpack::SqexHashPath(path));
+	const auto singleElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	std::vector<Sqex::Sqpack::SqexPathHashes> batch(paths.size());
+	Sqex::Sqpack::SqexHashPaths(views, batch);
+	const auto batchElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < paths.size(); ++i) {
+		for (const auto& hashes : {single[i], batch[i]}) {
+			if (hashes.PathHash != reference[i].PathHash || hashes.NameHash != reference[i].NameHash || hashes.FullPathHash != reference[i].FullPathHash)
+				mismatches++;
+		}
+	}
+	std::cout << std::format("{} paths: separately {:.1f}ms, one pass {:.1f}ms, batch {:.1f}ms, {} mismatches\n",
+		paths.size(), referenceElapsed * 1000, singleElapsed * 1000, batchElapsed * 1000, mismatches);
+}
+
+// Builds creators out of every installed sqpack file, and reports how long it takes and how much memory the entry tables use.
+void benchmark_creator_construction() {
+	const auto indexFiles = ListIndexFiles();
+
+	const auto before = GetMemoryCounters();
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::unique_ptr<Sqex::Sqpack::Creator>> creators;
+	for (const auto& indexFile : indexFiles) {
+		creators.emplace_back(std::make_unique<Sqex::Sqpack::Creator>(
+			Utils::ToUtf8(indexFile.parent_path().filename().wstring()),
+			Utils::ToUtf8(std::filesystem::path(indexFile.filename()).replace_extension().replace_extension().wstring())));
+		creators.back()->AddEntriesFromSqPack(indexFile, true, true);
+	}
+
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	const auto after = GetMemoryCounters();
+
+	size_t entryCount = 0, pathCount = 0, tableBytes = 0;
+	const auto viewsStart = std::chrono::steady_clock::now();
+	std::vector<Sqex::Sqpack::Creator::SqpackViews> views;
+	for (const auto& creator : creators) {
+		views.emplace_back(creator->AsViews(false));
+		entryCount += views.back().EntriesByPath.size();
+		pathCount += views.back().EntriesByPath.Paths().Count();
+		tableBytes += views.back().EntriesByPath.ByteCount();
+	}
+	const auto viewsElapsed = std::chrono::steady_clock::now() - viewsStart;
+	const auto afterViews = GetMemoryCounters();
+
+	std::cout << std::format("{} index files, {} entries ({} with paths): add {}ms, views {}ms\n",
+		indexFiles.size(), entryCount, pathCount,
+		std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(),
+		std::chrono::duration_cast<std::chrono::milliseconds>(viewsElapsed).count());
+	std::cout << std::format("entry tables {}KiB, private +{}KiB after add, +{}KiB after views, peak {}KiB\n",
+		tableBytes / 1024,
+		(static_cast<int64_t>(after.PrivateUsage) - static_cast<int64_t>(before.PrivateUsage)) / 1024,
+		(static_cast<int64_t>(afterViews.PrivateUsage) - static_cast<int64_t>(before.PrivateUsage)) / 1024,
+		afterViews.PeakPagefileUsage / 1024);
+}
+
+// Builds views of ffxiv/0a0000 with a TexTools mod pack on top, and prints checksums of the index files to compare between builds.
+void benchmark_creator_views(const std::filesystem::path& extractedTtmpDir, bool strict) {
+	auto start = std::chrono::steady_clock::now();
+	Sqex::Sqpack::Creator creator("ffxiv", "0a0000");
+	creator.AddEntriesFromSqPack(GameSqpackPath / L"ffxiv" / L"0a0000.win32.index", true, true);
+	creator.AddAllEntriesFromSimpleTTMP(extractedTtmpDir);
+	const auto addElapsed = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	const auto views = creator.AsViews(strict);
+	const auto viewsElapsed = std::chrono::steady_clock::now() - start;
+
+	const auto checksum = [](const Sqex::RandomAccessStream& stream) {
+		const auto data = stream.ReadStreamIntoVector<uint8_t>(0, static_cast<size_t>(stream.StreamSize()));
+		return crc32(0, data.data(), static_cast<uInt>(data.size()));
+	};
+	std::cout << std::format("{}: {} entries in {} data files, add {}ms, views {}ms, index {:08x}, index2 {:08x}\n",
+		strict ? "Strict" : "Non-strict",
+		views.Entries.size(),
+		views.Data.size(),
+		std::chrono::duration_cast<std::chrono::milliseconds>(addElapsed).count(),
+		std::chrono::duration_cast<std::chrono::milliseconds>(viewsElapsed).count(),
+		checksum(*views.Index1),
+		checksum(*views.Index2));
+}
+
+// Stands in for a .dat file that entries of a Creator are views into, and counts how it gets read.
+class CountingStream : public Sqex::RandomAccessStream {
+	const std::vector<uint8_t> m_data;
+
+	uint64_t Copy(uint64_t offset, void* buf, uint64_t length) const {
+		if (offset >= m_data.size())
+			return 0;
+		length = std::min<uint64_t>(length, m_data.size() - offset);
+		std::copy_n(&m_data[static_cast<size_t>(offset)], static_cast<size_t>(length), static_cast<uint8_t*>(buf));
+		return length;
+	}
+
+public:
+	mutable std::atomic_size_t PartialReads = 0;
+	mutable std::atomic_size_t VectoredReads = 0;
+	mutable std::atomic_size_t AsyncReads = 0;
+
+	explicit CountingStream(std::vector<uint8_t> data)
+		: m_data(std::move(data)) {
+	}
+
+	[[nodiscard]] uint64_t StreamSize() const override {
+		return m_data.size();
+	}
+
+	uint64_t ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const override {
+		++PartialReads;
+		return Copy(offset, buf, length);
+	}
+
+	void ReadStreamPartialVectored(std::span<ReadRequest> requests) const override {
+		++VectoredReads;
+		for (auto& request : requests)
+			request.Read = Copy(request.Offset, request.Buffer.data(), request.Buffer.size_bytes());
+	}
+
+	// Completes from another thread, as an overlapped read would.
+	void ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const override {
+		++AsyncReads;
+		std::thread([self = shared_from_this(), this, offset, buf, length, callback = std::move(callback)]() {
+			callback(Copy(offset, buf, length), nullptr);
+		}).detach();
+	}
+};
+
+// Returns what each data file of views should read as, from the base stream of each entry.
+static std::vector<std::vector<uint8_t>> ExpectedDataFiles(const Sqex::Sqpack::Creator::SqpackViews& views) {
+	std::vector<std::vector<uint8_t>> res;
+	for (const auto& data : views.Data)
+		res.emplace_back(static_cast<size_t>(data->StreamSize()));
+	for (const auto& entry : views.Entries) {
+		// The rest of the space of the entry stays zeros.
+		const auto& base = *static_cast<const Sqex::Sqpack::HotSwappableEntryProvider&>(*entry->Provider).GetBaseStream();
+		const auto content = base.ReadStreamIntoVector<uint8_t>(0, static_cast<size_t>(base.StreamSize()));
+		std::ranges::copy(content, res[entry->DataFileIndex].begin() + static_cast<ptrdiff_t>(sizeof Sqex::Sqpack::SqpackHeader + sizeof Sqex::Sqpack::SqData::Header + entry->OffsetAfterHeaders));
+	}
+	for (size_t i = 0; i < res.size(); ++i)
+		views.Data[i]->ReadStream(0, res[i].data(), sizeof Sqex::Sqpack::SqpackHeader + sizeof Sqex::Sqpack::SqData::Header);
+	return res;
+}
+
+// Adds entries that are parts of one stream, filled with bytes that are never zero.
+static std::shared_ptr<CountingStream> AddCountedEntries(Sqex::Sqpack::Creator& creator, size_t entryCount) {
+	std::vector<uint8_t> data(entryCount * 4096);
+	std::mt19937 rng(0);
+	// Bytes of a neighbouring entry showing up in padding can then be told apart.
+	std::ranges::generate(data, [&rng]() { return static_cast<uint8_t>(1 + rng() % 255); });
+	const auto storage = std::make_shared<CountingStream>(std::move(data));
+
+	for (size_t i = 0; i < entryCount; ++i) {
+		// Sizes that are not multiples of the alignment unit leave padding after each entry.
+		creator.AddEntry(std::make_shared<Sqex::Sqpack::RandomAccessStreamAsEntryProviderView>(
+			Sqex::Sqpack::EntryPathSpec(std::format("test/{:04}.bin", i)), storage, i * 4096, 1 + (i * 997) % 4095));
+	}
+	return storage;
+}
+
+// Reads Creator views whose entries share a stream, and checks that they are read with one vectored read without anything past the entries.
+void test_creator_view_reads() {
+	Sqex::Sqpack::Creator creator("ffxiv", "000000");
+	const auto storage = AddCountedEntries(creator, 64);
+	const auto views = creator.AsViews(false);
+	const auto expected = ExpectedDataFiles(views);
+
+	for (size_t i = 0; i < views.Data.size(); ++i) {
+		storage->PartialReads = storage->VectoredReads = 0;
+		const auto read = views.Data[i]->ReadStreamIntoVector<uint8_t>(0, static_cast<size_t>(views.Data[i]->StreamSize()));
+		if (read != expected[i])
+			throw std::runtime_error(std::format("data file {} reads wrong", i));
+		if (storage->VectoredReads != 1 || storage->PartialReads != 0)
+			throw std::runtime_error(std::format("data file {}: {} vectored reads, {} partial reads", i, storage->VectoredReads.load(), storage->PartialReads.load()));
+	}
+	std::cout << std::format("Creator view reads: {} entries: OK\n", views.Entries.size());
+}
+
+// Runs the async read stress test on Creator views whose entries share a stream, and checks that every read reached the stream asynchronously.
+void stress_async_creator_view_reads(size_t threadCount, size_t readsPerThread, size_t maxReadSize) {
+	Sqex::Sqpack::Creator creator("ffxiv", "000000");
+	const auto storage = AddCountedEntries(creator, 256);
+	const auto views = creator.AsViews(false);
+
+	// Synchronous reads to compare against go through the vectored path.
+	storage->PartialReads = storage->AsyncReads = 0;
+	if (const auto failed = StressAsyncReads(views, threadCount, readsPerThread, maxReadSize))
+		throw std::runtime_error(std::format("{} reads failed or mismatched", failed));
+	if (!storage->AsyncReads || storage->PartialReads)
+		throw std::runtime_error(std::format("{} async reads, {} partial reads", storage->AsyncReads.load(), storage->PartialReads.load()));
+}
+
+// Interns a path longer than a PathArena chunk between short ones, and checks that every path reads back intact.
+void test_path_arena() {
+	std::vector<std::string> paths;
+	paths.emplace_back("chara/equipment/e0001/texture/v01_c0101e0001_top_d.tex");
+	paths.emplace_back(std::format("chara/{}.tex", std::string(70000, 'a')));
+	for (size_t i = 0; i < 4096; ++i)
+		paths.emplace_back(std::format("chara/equipment/e{0:04}/texture/v01_c0101e{0:04}_top_d.tex", i));
+	paths.emplace_back(std::format("chara/{}.tex", std::string(65536, 'b')));
+	paths.emplace_back("chara/equipment/e0001/texture/v01_c0101e0001_dwn_d.tex");
+
+	Sqex::Sqpack::PathArena arena;
+	std::vector<Sqex::Sqpack::PathArena::Id> ids;
+	for (const auto& path : paths)
+		ids.emplace_back(arena.Intern(path));
+
+	for (size_t i = 0; i < paths.size(); ++i) {
+		if (arena[ids[i]] != paths[i])
+			throw std::runtime_error(std::format("path {} ({} bytes) reads back as {} bytes", i, paths[i].size(), arena[ids[i]].size()));
+		if (arena.Intern(paths[i]) != ids[i] || arena.Find(paths[i]) != ids[i])
+			throw std::runtime_error(std::format("path {} got another id", i));
+	}
+	std::cout << std::format("PathArena: {} paths, {} bytes: OK\n", arena.Count(), arena.ByteCount());
+}
+
+int main() {
+	test_path_arena();
+	test_creator_view_reads();
+	stress_async_creator_view_reads(8, 256, 65536);
+	// Run each mode in a separate process, so that the numbers are not affected by the other run.
+	benchmark_reader_open(true);
+	// benchmark_reader_open(false);
+	// benchmark_locator_lookup(16);
+	// benchmark_parallel_decompression(GameSqpackPath / L"ffxiv" / L"040000.win32.index", 256);
+	// benchmark_block_cache(GameSqpackPath / L"ffxiv" / L"040000.win32.index", 1024, 4096);
+	// stress_async_reads(GameSqpackPath / L"ffxiv" / L"0a0000.win32.index", 16, 4096, 1048576);
+	// benchmark_compression_policy(LR"(C:\Users\Public\XivAlexander\ReplacementFileEntries\ffxiv)");
+	// benchmark_path_hashing(1000000);
+	// test_deflate_backends(GameSqpackPath / L"ffxiv" / L"040000.win32.index", 1024);
+	// benchmark_creator_construction();
+	// benchmark_creator_views(LR"(C:\Users\Public\XivAlexander\TexToolsMods\Large)", false);
+	// benchmark_creator_views(LR"(C:\Users\Public\XivAlexander\TexToolsMods\Large)", true);
+	return 0;
+}
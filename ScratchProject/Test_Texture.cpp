@@ -0,0 +1,345 @@
+#include "pch.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+
+#include <XivAlexanderCommon/Sqex_Texture_Mipmap.h>
+#include <XivAlexanderCommon/Sqex_Texture_ModifiableTextureStream.h>
+#include <XivAlexanderCommon/XaDxtDecompression.h>
+
+// Decodes a randomly filled atlas with the per-block decoder and with the row decoder for each instruction set, and checks that all outputs match.
+void benchmark_dxt_decode(uint32_t width, uint32_t height, size_t repeats) {
+	const auto blockCount = static_cast<size_t>(width / 4) * (height / 4);
+
+	std::vector<uint8_t> blocks(blockCount * 16);
+	std::mt19937 rng(0);
+	std::ranges::generate(blocks, [&rng]() { return static_cast<uint8_t>(rng()); });
+
+	const auto measure = [&](const char* name, const auto& fn) {
+		std::vector<uint32_t> image(static_cast<size_t>(width) * height);
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < repeats; ++i)
+			fn(image.data());
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << std::format("{}: {:.1f}ms, {:.1f}MPixel/s\n",
+			name,
+			elapsed * 1000 / static_cast<double>(repeats),
+			static_cast<double>(image.size() * repeats) / elapsed / 1000000);
+		return image;
+	};
+
+	const auto decodeRows = [&](auto decodeRow, size_t blockSize, Utils::DxtDecoderInstructionSet instructionSet) {
+		return [&, decodeRow, blockSize, instructionSet](uint32_t* image) {
+			for (uint32_t y = 0; y < height; y += 4)
+				decodeRow(width, 4, &blocks[y / 4 * (width / 4) * blockSize], &image[static_cast<size_t>(y) * width], instructionSet);
+		};
+	};
+
+	const std::pair<Utils::DxtDecoderInstructionSet, const char*> instructionSets[]{
+		{Utils::DxtDecoderInstructionSet::Scalar, "Scalar"},
+		{Utils::DxtDecoderInstructionSet::Sse41, "SSE4.1"},
+		{Utils::DxtDecoderInstructionSet::Avx2, "AVX2"},
+	};
+
+	std::cout << std::format("{}x{}, best available: {}\n", width, height, instructionSets[static_cast<size_t>(Utils::DxtDecoderBestInstructionSet())].second);
+
+	for (const auto& [format, blockSize, blockDecoder, rowDecoder] : {
+		std::make_tuple("DXT1", size_t{8}, &Utils::BlockDecompressImageDXT1, &Utils::DecompressBlockRowDXT1),
+		std::make_tuple("DXT3", size_t{16}, static_cast<decltype(&Utils::BlockDecompressImageDXT1)>(nullptr), &Utils::DecompressBlockRowDXT3),
+		std::make_tuple("DXT5", size_t{16}, &Utils::BlockDecompressImageDXT5, &Utils::DecompressBlockRowDXT5),
+	}) {
+		std::cout << std::format("{}:\n", format);
+
+		// There is no per-block DXT3 decoder to compare against; use the scalar row decoder as the reference instead.
+		const auto reference = blockDecoder
+			? measure("Per block", [&](uint32_t* image) { blockDecoder(width, height, blocks.data(), image); })
+			: measure("Scalar rows", decodeRows(rowDecoder, blockSize, Utils::DxtDecoderInstructionSet::Scalar));
+
+		for (const auto& [instructionSet, name] : instructionSets) {
+			if (instructionSet > Utils::DxtDecoderBestInstructionSet())
+				continue;
+			if (measure(name, decodeRows(rowDecoder, blockSize, instructionSet)) != reference)
+				throw std::runtime_error(std::format("{} {} output differs", format, name));
+		}
+	}
+}
+
+// Converts a randomly filled image of each format into RGBA8888 per pixel, with the single threaded kernels, and in parallel bands
+// through MemoryBackedMipmap::NewARGB8888From, and checks that all outputs match.
+void benchmark_format_conversion(uint16_t width, uint16_t height, size_t repeats) {
+	using namespace Sqex::Texture;
+
+	const auto pixelCount = static_cast<size_t>(width) * height;
+	const auto measure = [&](const char* name, const auto& fn) {
+		std::vector<RGBA8888> image(pixelCount);
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < repeats; ++i)
+			fn(std::span(image));
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << std::format("{}: {:.1f}ms, {:.1f}MPixel/s\n",
+			name,
+			elapsed * 1000 / static_cast<double>(repeats),
+			static_cast<double>(pixelCount * repeats) / elapsed / 1000000);
+		std::vector<uint32_t> values(pixelCount);
+		std::ranges::transform(image, values.begin(), [](const RGBA8888& p) { return p.Value; });
+		return values;
+	};
+
+	std::cout << std::format("{}x{}, {} threads\n", width, height, std::thread::hardware_concurrency());
+
+	for (const auto& [name, format] : {
+		std::make_pair("L8", Format::L8_1),
+		std::make_pair("RGBA4444", Format::RGBA4444),
+		std::make_pair("RGBA5551", Format::RGBA5551),
+		std::make_pair("RGBAF", Format::RGBAF),
+		std::make_pair("DXT1", Format::DXT1),
+		std::make_pair("DXT3", Format::DXT3),
+		std::make_pair("DXT5", Format::DXT5),
+	}) {
+		std::cout << std::format("{}:\n", name);
+
+		std::vector<uint8_t> source(RawDataLength(format, width, height));
+		std::mt19937 rng(0);
+		std::ranges::generate(source, [&rng]() { return static_cast<uint8_t>(rng()); });
+
+		std::vector<uint32_t> reference;
+		switch (format) {
+			case Format::L8_1:
+				reference = measure("Per pixel", [&](std::span<RGBA8888> image) {
+					for (size_t i = 0; i < pixelCount; ++i)
+						image[i].Value = source[i] * 0x10101UL | 0xFF000000UL;
+				});
+				break;
+
+			case Format::RGBA4444:
+				reference = measure("Per pixel", [&](std::span<RGBA8888> image) {
+					const auto view = reinterpret_cast<const RGBA4444*>(&source[0]);
+					for (size_t i = 0; i < pixelCount; ++i)
+						image[i].SetFrom(view[i].R * 17, view[i].G * 17, view[i].B * 17, view[i].A * 17);
+				});
+				break;
+
+			case Format::RGBA5551:
+				reference = measure("Per pixel", [&](std::span<RGBA8888> image) {
+					const auto view = reinterpret_cast<const RGBA5551*>(&source[0]);
+					for (size_t i = 0; i < pixelCount; ++i)
+						image[i].SetFrom(view[i].R * 255 / 31, view[i].G * 255 / 31, view[i].B * 255 / 31, view[i].A * 255);
+				});
+				break;
+
+			case Format::RGBAF:
+				reference = measure("Per pixel", [&](std::span<RGBA8888> image) {
+					const auto view = reinterpret_cast<const RGBAHHHH*>(&source[0]);
+					for (size_t i = 0; i < pixelCount; ++i)
+						image[i].SetFromF(view[i]);
+				});
+				break;
+
+			default:
+			{
+				const auto decode = format == Format::DXT1 ? &Utils::DecompressBlockRowDXT1 : (format == Format::DXT3 ? &Utils::DecompressBlockRowDXT3 : &Utils::DecompressBlockRowDXT5);
+				const auto blockRowSize = RawDataLength(format, width, 4);
+				reference = measure("Rows, 1 thread", [&](std::span<RGBA8888> image) {
+					for (uint32_t y = 0; y < height; y += 4)
+						decode(width, std::min(4U, height - y), &source[y / 4 * blockRowSize], &image[static_cast<size_t>(y) * width].Value, Utils::DxtDecoderBestInstructionSet());
+				});
+			}
+		}
+
+		if (format != Format::DXT1 && format != Format::DXT3 && format != Format::DXT5) {
+			if (measure("Kernel, 1 thread", [&](std::span<RGBA8888> image) { ConvertToRGBA8888(format, source, image); }) != reference)
+				throw std::runtime_error(std::format("{} kernel output differs", name));
+		}
+
+		const auto mipmap = std::make_shared<MemoryBackedMipmap>(width, height, format, source);
+		if (measure("Parallel", [&](std::span<RGBA8888> image) { mipmap->ViewARGB8888()->ReadStream(0, image); }) != reference)
+			throw std::runtime_error(std::format("{} parallel output differs", name));
+	}
+}
+
+// Compresses a synthetic image with gradients, edges and noise in each DXT format and quality, and reports throughput and
+// the peak signal to noise ratio of each channel after decoding it back.
+void benchmark_dxt_encode(uint16_t width, uint16_t height, size_t repeats) {
+	using namespace Sqex::Texture;
+
+	const auto pixelCount = static_cast<size_t>(width) * height;
+	std::vector<RGBA8888> image(pixelCount);
+	std::mt19937 rng(0);
+	for (size_t y = 0; y < height; ++y) {
+		for (size_t x = 0; x < width; ++x) {
+			const auto fx = static_cast<double>(x) / width, fy = static_cast<double>(y) / height;
+			image[y * width + x].SetFrom(
+				Utils::Clamp(static_cast<int>(128 + 100 * std::sin(fx * 20 + fy * 3) + rng() % 16), 0, 255),
+				Utils::Clamp(static_cast<int>(128 + 100 * std::cos(fy * 17 + fx * 5) + rng() % 16), 0, 255),
+				(x / 37 + y / 29) % 2 ? 200 : 40,
+				Utils::Clamp(static_cast<int>(128 + 120 * std::sin(fx * 9 - fy * 11)), 0, 255));
+		}
+	}
+
+	std::cout << std::format("{}x{}, {} threads\n", width, height, std::thread::hardware_concurrency());
+
+	for (const auto& [name, format] : {
+		std::make_pair("DXT1", Format::DXT1),
+		std::make_pair("DXT3", Format::DXT3),
+		std::make_pair("DXT5", Format::DXT5),
+	}) {
+		for (const auto& [qualityName, quality] : {
+			std::make_pair("Fast", DxtEncodeQuality::Fast),
+			std::make_pair("High", DxtEncodeQuality::High),
+		}) {
+			std::vector<uint8_t> blocks;
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < repeats; ++i)
+				blocks = CompressDXT(format, width, height, image, quality);
+			const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			const auto decoded = std::make_shared<MemoryBackedMipmap>(width, height, format, std::move(blocks))->ViewARGB8888()->ReadStreamIntoVector<RGBA8888>(0, pixelCount);
+			double squaredErrors[4]{};
+			for (size_t i = 0; i < pixelCount; ++i) {
+				const int diffs[4]{
+					static_cast<int>(decoded[i].R) - static_cast<int>(image[i].R),
+					static_cast<int>(decoded[i].G) - static_cast<int>(image[i].G),
+					static_cast<int>(decoded[i].B) - static_cast<int>(image[i].B),
+					static_cast<int>(decoded[i].A) - static_cast<int>(image[i].A),
+				};
+				for (size_t c = 0; c < 4; ++c)
+					squaredErrors[c] += diffs[c] * diffs[c];
+			}
+			const auto psnr = [&](double squaredError) {
+				return squaredError ? 10 * std::log10(255. * 255. * static_cast<double>(pixelCount) / squaredError) : INFINITY;
+			};
+
+			std::cout << std::format("{} {}: {:.1f}ms, {:.1f}MPixel/s, PSNR R={:.2f} G={:.2f} B={:.2f} A={:.2f}\n",
+				name, qualityName,
+				elapsed * 1000 / static_cast<double>(repeats),
+				static_cast<double>(pixelCount * repeats) / elapsed / 1000000,
+				psnr(squaredErrors[0]), psnr(squaredErrors[1]), psnr(squaredErrors[2]), psnr(squaredErrors[3]));
+		}
+	}
+}
+
+// Halves a randomly filled image with each filter, checks the box filter against a per pixel reference, and generates full
+// mipmap chains in each format through ModifiableTextureStream.
+void benchmark_mipmap_generation(uint16_t width, uint16_t height, size_t repeats) {
+	using namespace Sqex::Texture;
+
+	std::vector<RGBA8888> image(static_cast<size_t>(width) * height);
+	std::mt19937 rng(0);
+	std::ranges::generate(image, [&rng]() { return RGBA8888(rng()); });
+
+	const auto measure = [&](const std::string& name, size_t pixelCount, const auto& fn) {
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < repeats; ++i)
+			fn();
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << std::format("{}: {:.1f}ms, {:.1f}MPixel/s\n",
+			name,
+			elapsed * 1000 / static_cast<double>(repeats),
+			static_cast<double>(pixelCount * repeats) / elapsed / 1000000);
+	};
+
+	std::cout << std::format("{}x{}, {} threads\n", width, height, std::thread::hardware_concurrency());
+
+	const size_t halfWidth = width / 2, halfHeight = height / 2;
+	std::vector<RGBA8888> reference(halfWidth * halfHeight);
+	measure("Box, per pixel", image.size(), [&]() {
+		for (size_t y = 0; y < halfHeight; ++y) {
+			for (size_t x = 0; x < halfWidth; ++x) {
+				const auto& p00 = image[y * 2 * width + x * 2], & p01 = image[y * 2 * width + x * 2 + 1];
+				const auto& p10 = image[(y * 2 + 1) * width + x * 2], & p11 = image[(y * 2 + 1) * width + x * 2 + 1];
+				reference[y * halfWidth + x].SetFrom(
+					(p00.R + p01.R + p10.R + p11.R + 2) / 4,
+					(p00.G + p01.G + p10.G + p11.G + 2) / 4,
+					(p00.B + p01.B + p10.B + p11.B + 2) / 4,
+					(p00.A + p01.A + p10.A + p11.A + 2) / 4);
+			}
+		}
+	});
+
+	std::vector<RGBA8888> halved;
+	measure("Box", image.size(), [&]() { halved = HalveRGBA8888(image, width, height, MipmapFilter::Box); });
+	if (!std::ranges::equal(halved, reference, [](const RGBA8888& l, const RGBA8888& r) { return l.Value == r.Value; }))
+		throw std::runtime_error("Box output differs");
+	measure("Kaiser", image.size(), [&]() { halved = HalveRGBA8888(image, width, height, MipmapFilter::Kaiser); });
+
+	const auto source = std::make_shared<MemoryBackedMipmap>(width, height, Format::RGBA_1, std::vector<uint8_t>(
+		reinterpret_cast<const uint8_t*>(image.data()), reinterpret_cast<const uint8_t*>(image.data() + image.size())));
+	for (const auto& [name, format] : {
+		std::make_pair("L8", Format::L8_1),
+		std::make_pair("RGBA4444", Format::RGBA4444),
+		std::make_pair("RGBA5551", Format::RGBA5551),
+		std::make_pair("RGBA8888", Format::RGBA_1),
+		std::make_pair("RGBAF", Format::RGBAF),
+		std::make_pair("DXT1", Format::DXT1),
+		std::make_pair("DXT5", Format::DXT5),
+	}) {
+		for (const auto& [filterName, filter] : {
+			std::make_pair("Box", MipmapFilter::Box),
+			std::make_pair("Kaiser", MipmapFilter::Kaiser),
+		}) {
+			size_t mipmapCount = 0;
+			measure(std::format("{} chain, {}", name, filterName), image.size(), [&]() {
+				ModifiableTextureStream texture(format, width, height);
+				texture.AppendMipmapChain(*source, filter, SIZE_MAX, DxtEncodeQuality::Fast);
+				mipmapCount = texture.ReadStreamIntoVector<Header>(0, 1)[0].MipmapCount;
+			});
+			if (mipmapCount != static_cast<size_t>(std::log2(std::min(width, height))) + 1)
+				throw std::runtime_error(std::format("{} chain has {} mipmaps", name, mipmapCount));
+		}
+	}
+}
+
+// Regenerates mipmaps of a solid color DXT1 and DXT5 texture, through both AppendMipmapChain and GenerateMipmaps, and checks
+// that every pixel of the second mipmap keeps each channel of the color.
+void test_mipmap_channels() {
+	using namespace Sqex::Texture;
+
+	static constexpr uint16_t Width = 64, Height = 64;
+	for (const auto& [name, format, alpha] : {
+		std::make_tuple("DXT1", Format::DXT1, 255U),
+		std::make_tuple("DXT5", Format::DXT5, 96U),
+	}) {
+		const auto color = RGBA8888(200, 120, 40, alpha);
+		const std::vector image(static_cast<size_t>(Width) * Height, color);
+		const auto source = std::make_shared<MemoryBackedMipmap>(Width, Height, Format::RGBA_1, std::vector<uint8_t>(
+			reinterpret_cast<const uint8_t*>(image.data()), reinterpret_cast<const uint8_t*>(image.data() + image.size())));
+
+		const auto check = [&](const char* method, const std::shared_ptr<ModifiableTextureStream>& texture) {
+			const auto mipmap = MipmapStream::FromTexture(texture, 1);
+			const auto pixels = mipmap->ViewARGB8888()->ReadStreamIntoVector<RGBA8888>(0, static_cast<size_t>(mipmap->Width()) * mipmap->Height());
+			for (const auto& pixel : pixels) {
+				// 5 and 6 bit color endpoints round each channel by at most this much.
+				if (std::abs(static_cast<int>(pixel.R) - static_cast<int>(color.R)) > 8
+					|| std::abs(static_cast<int>(pixel.G) - static_cast<int>(color.G)) > 4
+					|| std::abs(static_cast<int>(pixel.B) - static_cast<int>(color.B)) > 8
+					|| pixel.A != color.A)
+					throw std::runtime_error(std::format("{} {}: mipmap 1 has ({}, {}, {}, {}) instead of ({}, {}, {}, {})",
+						name, method,
+						static_cast<uint32_t>(pixel.R), static_cast<uint32_t>(pixel.G), static_cast<uint32_t>(pixel.B), static_cast<uint32_t>(pixel.A),
+						static_cast<uint32_t>(color.R), static_cast<uint32_t>(color.G), static_cast<uint32_t>(color.B), static_cast<uint32_t>(color.A)));
+			}
+		};
+
+		const auto chained = std::make_shared<ModifiableTextureStream>(format, Width, Height);
+		chained->AppendMipmapChain(*source);
+		check("AppendMipmapChain", chained);
+
+		// GenerateMipmaps reads the first mipmap back from its DXT blocks.
+		const auto generated = std::make_shared<ModifiableTextureStream>(format, Width, Height);
+		generated->AppendMipmap(MemoryBackedMipmap::NewFromARGB8888(Width, Height, image, format));
+		generated->GenerateMipmaps();
+		check("GenerateMipmaps", generated);
+	}
+	std::cout << "Mipmap channels: OK\n";
+}
+
+int main() {
+	test_mipmap_channels();
+	benchmark_dxt_decode(4096, 4096, 8);
+	benchmark_format_conversion(4096, 4096, 8);
+	benchmark_dxt_encode(4096, 4096, 4);
+	benchmark_mipmap_generation(4096, 4096, 4);
+	return 0;
+}
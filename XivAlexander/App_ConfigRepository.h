@@ -199,9 +199,11 @@ namespace App {
 			Item<bool> ShowLoggingWindow = CreateConfigItem(this, "ShowLoggingWindow", true);
 			Item<bool> ShowControlWindow = CreateConfigItem(this, "ShowControlWindow", true);
 			Item<bool> UseAllIpcMessageLogger = CreateConfigItem(this, "UseAllIpcMessageLogger", false);
+			Item<bool> CaptureNetworkTraffic = CreateConfigItem(this, "CaptureNetworkTraffic", false);  // Into Captures under the config directory; see Network::Capture.
 			
 			Item<bool> UseHashTrackerKeyLogging = CreateConfigItem(this, "UseHashTrackerKeyLogging", false);
 			Item<bool> LogAllDataFileRead = CreateConfigItem(this, "LogAllDataFileRead", false);
+			Item<bool> UseAsynchronousDataFileRead = CreateConfigItem(this, "UseAsynchronousDataFileRead", false);  // Complete overlapped ReadFile on modded data files from the thread pool.
 			Item<Sqex::Language> ResourceLanguageOverride = CreateConfigItem(this, "ResourceLanguageOverride", Sqex::Language::Unspecified);
 			Item<Sqex::Language> VoiceResourceLanguageOverride = CreateConfigItem(this, "VoiceResourceLanguageOverride", Sqex::Language::Unspecified);
 
@@ -1,8 +1,10 @@
 #include "pch.h"
 #include "App_Feature_AllIpcMessageLogger.h"
+
+#include <XivAlexanderCommon/Sqex_Network_Structures.h>
+
 #include "App_Misc_Logger.h"
 #include "App_Network_SocketHook.h"
-#include "App_Network_Structures.h"
 
 struct App::Feature::AllIpcMessageLogger::Implementation {
 	class SingleConnectionHandler {
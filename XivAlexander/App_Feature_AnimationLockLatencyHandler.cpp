@@ -1,12 +1,12 @@
 ﻿#include "pch.h"
 #include "App_Feature_AnimationLockLatencyHandler.h"
 
+#include <XivAlexanderCommon/Sqex_Network_Structures.h>
 #include <XivAlexanderCommon/XaMisc.h>
 
 #include "App_ConfigRepository.h"
 #include "App_Misc_Logger.h"
 #include "App_Network_SocketHook.h"
-#include "App_Network_Structures.h"
 #include "resource.h"
 
 struct App::Feature::AnimationLockLatencyHandler::Implementation {
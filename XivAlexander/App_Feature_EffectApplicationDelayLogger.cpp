@@ -1,10 +1,11 @@
 #include "pch.h"
 #include "App_Feature_EffectApplicationDelayLogger.h"
 
+#include <XivAlexanderCommon/Sqex_Network_Structures.h>
+
 #include "App_ConfigRepository.h"
 #include "App_Misc_Logger.h"
 #include "App_Network_SocketHook.h"
-#include "App_Network_Structures.h"
 
 struct App::Feature::EffectApplicationDelayLogger::Implementation {
 	class SingleConnectionHandler {
@@ -77,6 +77,11 @@ struct App::Feature::GameResourceOverrider::Implementation {
 	Misc::Hooks::ImportedFunction<BOOL, HANDLE, LARGE_INTEGER, PLARGE_INTEGER, DWORD> SetFilePointerEx{"kernel32::SetFilePointerEx", "kernel32.dll", "SetFilePointerEx"};
 
 	ReEnterPreventer m_repCreateFileW, m_repReadFile;
+
+	// Overlapped reads still writing into the game's buffers, per file handle.
+	std::map<HANDLE, size_t> m_inFlightReads;
+	std::mutex m_inFlightReadsMtx;
+	std::condition_variable m_inFlightReadsCv;
 	
 	Utils::ListenerManager<Implementation, void> OnVirtualSqPacksInitialized;
 
@@ -128,8 +133,11 @@ struct App::Feature::GameResourceOverrider::Implementation {
 		m_cleanup += CloseHandle.SetHook([this](
 			HANDLE handle
 		) {
-				if (m_sqpacks && m_sqpacks->Close(handle))
-					return 0;
+				if (m_sqpacks && m_sqpacks->Get(handle)) {
+					WaitForInFlightReads(handle);
+					if (m_sqpacks->Close(handle))
+						return 0;
+				}
 
 				return CloseHandle.bridge(handle);
 			});
@@ -146,6 +154,51 @@ struct App::Feature::GameResourceOverrider::Implementation {
 					try {
 						m_sqpacks->MarkIoRequest();
 						const auto fp = lpOverlapped ? ((static_cast<uint64_t>(lpOverlapped->OffsetHigh) << 32) | lpOverlapped->Offset) : vpath.FilePointer.QuadPart;
+
+						// Overlapped requests that can be waited on complete from the thread pool, so that the game's I/O thread is not blocked.
+						if (lpOverlapped && lpOverlapped->hEvent && m_config->Runtime.UseAsynchronousDataFileRead) {
+							if (lpNumberOfBytesRead)
+								*lpNumberOfBytesRead = 0;
+							ResetEvent(lpOverlapped->hEvent);
+							lpOverlapped->Internal = STATUS_PENDING;
+							lpOverlapped->InternalHigh = 0;
+							{
+								const auto lock = std::lock_guard(m_inFlightReadsMtx);
+								++m_inFlightReads[hFile];
+							}
+							try {
+								vpath.Stream->ReadStreamPartialAsync(fp, lpBuffer, nNumberOfBytesToRead, [
+									this,
+									filename = vpath.Path.filename(),
+									hFile,
+									nNumberOfBytesToRead,
+									lpOverlapped
+								](uint64_t read, std::exception_ptr error) {
+									if (error) {
+										try {
+											std::rethrow_exception(error);
+										} catch (const std::exception& e) {
+											m_logger->Format<LogLevel::Warning>(LogCategory::GameResourceOverrider, L"ReadFile: {}, Message: {}", filename, e.what());
+										} catch (...) {
+											m_logger->Format<LogLevel::Warning>(LogCategory::GameResourceOverrider, L"ReadFile: {}, Message: unknown error", filename);
+										}
+									} else if (read != nNumberOfBytesToRead)
+										m_logger->Format<LogLevel::Warning>(LogCategory::GameResourceOverrider, L"ReadFile: {}, requested {} bytes, read {} bytes", filename, nNumberOfBytesToRead, read);
+
+									lpOverlapped->InternalHigh = static_cast<ULONG_PTR>(read);
+									lpOverlapped->Internal = error ? static_cast<ULONG_PTR>(STATUS_UNEXPECTED_IO_ERROR) : STATUS_SUCCESS;
+									SetEvent(lpOverlapped->hEvent);
+
+									EndInFlightRead(hFile);
+								});
+							} catch (...) {
+								EndInFlightRead(hFile);
+								throw;
+							}
+							SetLastError(ERROR_IO_PENDING);
+							return FALSE;
+						}
+
 						const auto read = vpath.Stream->ReadStreamPartial(fp, lpBuffer, nNumberOfBytesToRead);
 
 						if (lpNumberOfBytesRead)
@@ -348,6 +401,22 @@ struct App::Feature::GameResourceOverrider::Implementation {
 
 	~Implementation() {
 		m_cleanup.Clear();
+
+		// Completion callbacks use this object and write into the game's buffers; let them finish before the hooks are gone.
+		auto lock = std::unique_lock(m_inFlightReadsMtx);
+		m_inFlightReadsCv.wait(lock, [this]() { return m_inFlightReads.empty(); });
+	}
+
+	void EndInFlightRead(HANDLE handle) {
+		const auto lock = std::lock_guard(m_inFlightReadsMtx);
+		if (!--m_inFlightReads[handle])
+			m_inFlightReads.erase(handle);
+		m_inFlightReadsCv.notify_all();
+	}
+
+	void WaitForInFlightReads(HANDLE handle) {
+		auto lock = std::unique_lock(m_inFlightReadsMtx);
+		m_inFlightReadsCv.wait(lock, [this, handle]() { return !m_inFlightReads.contains(handle); });
 	}
 };
 
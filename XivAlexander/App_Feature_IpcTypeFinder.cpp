@@ -1,9 +1,11 @@
 #include "pch.h"
 #include "App_Feature_IpcTypeFinder.h"
 
+#include <XivAlexanderCommon/Sqex_Network_IpcTypeFinder.h>
+#include <XivAlexanderCommon/Sqex_Network_Structures.h>
+
 #include "App_Misc_Logger.h"
 #include "App_Network_SocketHook.h"
-#include "App_Network_Structures.h"
 
 struct App::Feature::IpcTypeFinder::Implementation {
 	class SingleConnectionHandler {
@@ -14,151 +16,26 @@ struct App::Feature::IpcTypeFinder::Implementation {
 		SingleConnectionHandler(Implementation* pImpl, Network::SingleConnection& conn)
 			: m_pImpl(pImpl)
 			, conn(conn) {
-			using namespace Network::Structures;
-
 			conn.AddIncomingFFXIVMessageHandler(this, [&](auto pMessage) {
-				if (pMessage->Type == SegmentType::IPC && pMessage->Data.IPC.Type == IpcType::InterestedType) {
-					if (pMessage->CurrentActor == pMessage->SourceActor) {
-						if (pMessage->Length == 0x9c ||
-							pMessage->Length == 0x29c ||
-							pMessage->Length == 0x4dc ||
-							pMessage->Length == 0x71c ||
-							pMessage->Length == 0x95c) {
-							// Test ActionEffect
-
-							int expectedCount = 0;
-							if (pMessage->Length == 0x9c)
-								expectedCount = 1;
-							else if (pMessage->Length == 0x29c)
-								expectedCount = 8;
-							else if (pMessage->Length == 0x4dc)
-								expectedCount = 16;
-							else if (pMessage->Length == 0x71c)
-								expectedCount = 24;
-							else if (pMessage->Length == 0x95c)
-								expectedCount = 32;
-
-							const auto& actionEffect = pMessage->Data.IPC.Data.S2C_ActionEffect;
-
-							m_pImpl->m_logger->Format(
-								LogCategory::IpcTypeFinder,
-								"{:x}: S2C_ActionEffect{:02}(0x{:04x}) length={:x} actionId={:04x} sequence={:04x} wait={:.3f}",
-								conn.Socket(),
-								expectedCount,
-								pMessage->Data.IPC.SubType,
-								pMessage->Length,
-								actionEffect.ActionId,
-								actionEffect.SourceSequence,
-								actionEffect.AnimationLockDuration);
-							pMessage->DebugPrint(LogCategory::IpcTypeFinder, "IpcTypeFinder", true);
-
-						} else if (pMessage->Length == 0x40) {
-							// Two possibilities: ActorControlSelf and ActorCast
-
-							//
-							// Test ActorControlSelf
-							// 
-							const auto& actorControlSelf = pMessage->Data.IPC.Data.S2C_ActorControlSelf;
-							if (actorControlSelf.Category == S2C_ActorControlSelfCategory::Cooldown) {
-								const auto& cooldown = actorControlSelf.Cooldown;
-								m_pImpl->m_logger->Format(
-									LogCategory::IpcTypeFinder,
-									"{:x}: S2C_ActorControlSelf(0x{:04x}): Cooldown: actionId={:04x} duration={}",
-									conn.Socket(),
-									pMessage->Data.IPC.SubType,
-									cooldown.ActionId,
-									cooldown.Duration);
-								pMessage->DebugPrint(LogCategory::IpcTypeFinder, "IpcTypeFinder", true);
-
-							} else if (pMessage->Data.IPC.Data.S2C_ActorControlSelf.Category == S2C_ActorControlSelfCategory::ActionRejected) {
-								const auto& rollback = actorControlSelf.Rollback;
-								m_pImpl->m_logger->Format(
-									LogCategory::IpcTypeFinder,
-									"{:x}: S2C_ActorControlSelf(0x{:04x}): Rollback: actionId={:04x} sourceSequence={:04x}",
-									conn.Socket(),
-									pMessage->Data.IPC.SubType,
-									rollback.ActionId,
-									rollback.SourceSequence);
-								pMessage->DebugPrint(LogCategory::IpcTypeFinder, "IpcTypeFinder", true);
-							}
-
-							//
-							// Test ActorCast
-							//
-							m_pImpl->m_logger->Format(
-								LogCategory::IpcTypeFinder,
-								"{:x}: S2C_ActorCast(0x{:04x}): actionId={:04x} time={:.3f} target={:08x}",
-								conn.Socket(),
-								pMessage->Data.IPC.SubType,
-								pMessage->Data.IPC.Data.S2C_ActorCast.ActionId,
-								pMessage->Data.IPC.Data.S2C_ActorCast.CastTime,
-								pMessage->Data.IPC.Data.S2C_ActorCast.TargetId);
-							pMessage->DebugPrint(LogCategory::IpcTypeFinder, "IpcTypeFinder", true);
-
-						} else if (pMessage->Length == 0x38) {
-							// Test ActorControl
-							const auto& actorControl = pMessage->Data.IPC.Data.S2C_ActorControl;
-							if (actorControl.Category == S2C_ActorControlCategory::CancelCast) {
-								const auto& cancelCast = actorControl.CancelCast;
-								m_pImpl->m_logger->Format(
-									LogCategory::IpcTypeFinder,
-									"{:x}: S2C_ActorControl(0x{:04x}): CancelCast: actionId={:04x}",
-									conn.Socket(),
-									pMessage->Data.IPC.SubType,
-									cancelCast.ActionId);
-								pMessage->DebugPrint(LogCategory::IpcTypeFinder, "IpcTypeFinder", true);
-							}
-						}
-					}
-					if (pMessage->Length == 0x78) {
-						// Test AddStatusEffect
-						const auto& actorControl = pMessage->Data.IPC.Data.S2C_AddStatusEffect;
-						const auto& addStatusEffect = pMessage->Data.IPC.Data.S2C_AddStatusEffect;
-						std::string effects;
-						for (int i = 0; i < addStatusEffect.EffectCount; ++i) {
-							const auto& entry = addStatusEffect.Effects[i];
-							effects += std::format(
-								"\n\teffectId={:04x} duration={:g} sourceActorId={:08x}",
-								entry.EffectId,
-								entry.Duration,
-								entry.SourceActorId
-							);
-						}
-						m_pImpl->m_logger->Format(
-							LogCategory::IpcTypeFinder,
-							"{:x}: S2C_AddStatusEffect(0x{:04x}): relatedActionSequence={:08x} actorId={:08x} HP={}/{} MP={} shield={}{}",
-							conn.Socket(),
-							pMessage->Data.IPC.SubType,
-							addStatusEffect.RelatedActionSequence,
-							addStatusEffect.ActorId,
-							addStatusEffect.CurrentHp,
-							addStatusEffect.MaxHp,
-							addStatusEffect.CurentMp,
-							addStatusEffect.DamageShield,
-							effects
-						);
-					}
-				}
+				Sqex::Network::IpcTypeFinder::FindIncoming(*pMessage, [&](const std::string& description, bool dump) {
+					Log(*pMessage, description, dump);
+				});
 				return true;
 			});
 			conn.AddOutgoingFFXIVMessageHandler(this, [&](auto pMessage) {
-				if (pMessage->Type == SegmentType::IPC && pMessage->Data.IPC.Type == IpcType::InterestedType) {
-					if (pMessage->Length == 0x40) {
-						// Test ActionRequest
-						const auto& actionRequest = pMessage->Data.IPC.Data.C2S_ActionRequest;
-						m_pImpl->m_logger->Format(
-							LogCategory::IpcTypeFinder,
-							"{:x}: C2S_ActionRequest/GroundTargeted(0x{:04x}): actionId={:04x} sequence={:04x}",
-							conn.Socket(),
-							pMessage->Data.IPC.SubType,
-							actionRequest.ActionId, actionRequest.Sequence);
-						pMessage->DebugPrint(LogCategory::IpcTypeFinder, "IpcTypeFinder", true);
-					}
-				}
+				Sqex::Network::IpcTypeFinder::FindOutgoing(*pMessage, [&](const std::string& description, bool dump) {
+					Log(*pMessage, description, dump);
+				});
 				return true;
 			});
 		}
 
+		void Log(const Network::Structures::FFXIVMessage& message, const std::string& description, bool dump) const {
+			m_pImpl->m_logger->Format(LogCategory::IpcTypeFinder, "{:x}: {}", conn.Socket(), description);
+			if (dump)
+				m_pImpl->m_logger->Log(LogCategory::IpcTypeFinder, message.Describe("IpcTypeFinder", true), LogLevel::Debug);
+		}
+
 		~SingleConnectionHandler() {
 			conn.RemoveMessageHandlers(this);
 		}
@@ -0,0 +1,149 @@
+#include "pch.h"
+#include "App_LoaderApp_Actions_Benchmark.h"
+
+#include <chrono>
+
+#include <XivAlexanderCommon/Sqex_Network_Capture.h>
+#include <XivAlexanderCommon/Sqex_Network_IpcTypeFinder.h>
+#include <XivAlexanderCommon/Sqex_Network_SingleStream.h>
+#include <XivAlexanderCommon/Sqex_Network_Structures.h>
+
+#include "DllMain.h"
+
+using namespace XivAlexDll;
+
+App::LoaderApp::Actions::Benchmark::Benchmark(const Arguments& args)
+	: m_args(args) {
+}
+
+int App::LoaderApp::Actions::Benchmark::Run() {
+	if (!m_args.argp.present("targets"))
+		throw std::invalid_argument("no captured stream given");
+	const auto targets = m_args.argp.get<std::vector<std::string>>("targets");
+
+	std::string report;
+	switch (m_args.m_action) {
+		case LoaderAction::Internal_Benchmark_TunnelXivStream:
+			for (const auto& target : targets)
+				report += TunnelXivStream(Utils::FromUtf8(target)) + "\n";
+			Report(report);
+			return 0;
+
+		case LoaderAction::Internal_Benchmark_ReplayCapture:
+			for (const auto& target : targets)
+				report += ReplayCapture(Utils::FromUtf8(target)) + "\n";
+			Report(report);
+			return 0;
+	}
+
+	throw std::logic_error("invalid m_argument for Benchmark");
+}
+
+void App::LoaderApp::Actions::Benchmark::Report(const std::string& report) const {
+	if (!m_args.m_quiet) {
+		Dll::MessageBoxF(nullptr, MB_OK, report);
+		return;
+	}
+
+	if (const auto hStdOut = GetStdHandle(STD_OUTPUT_HANDLE); hStdOut && hStdOut != INVALID_HANDLE_VALUE) {
+		DWORD written;
+		WriteFile(hStdOut, report.data(), static_cast<DWORD>(report.size()), &written, nullptr);
+	}
+}
+
+std::string App::LoaderApp::Actions::Benchmark::TunnelXivStream(const std::filesystem::path& path) const {
+	// path holds bytes as they came out of recv or went into send, such as a TCP stream exported from a packet capture.
+	const auto file = Utils::Win32::Handle::FromCreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0);
+	const auto data = file.Read<uint8_t>(0, static_cast<size_t>(file.GetFileSize()));
+
+	Sqex::Network::SingleStream raw, processed;
+	std::vector<uint8_t> received(65536);
+	size_t messageCount = 0;
+	const std::function<bool(Sqex::Network::Structures::FFXIVMessage*)> countMessage = [&messageCount](Sqex::Network::Structures::FFXIVMessage*) {
+		++messageCount;
+		return true;
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	size_t passes = 0;
+	do {
+		// Feed in pieces of up to 64KiB as AttemptReceive does, and drain as the game would.
+		for (size_t offset = 0; offset < data.size();) {
+			auto write = raw.Write();
+			const auto buf = write.Allocate<uint8_t>(std::min<size_t>(65536, data.size() - offset));
+			std::copy_n(&data[offset], buf.size(), buf.data());
+			offset += write.Write(buf.size());
+
+			raw.TunnelXivStream(processed, countMessage);
+			while (processed.Available())
+				processed.Read(received.data(), received.size());
+		}
+
+		// Drop whatever incomplete bundle is left at the end of the capture.
+		raw.Consume(raw.Available());
+		++passes;
+	} while (std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+	const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return std::format("{}: {:.1f}MiB, {} messages, {} passes, {:.1f}MiB/s, {:.1f}ns/message, buffers {}KiB/{}KiB",
+		path.filename().string(),
+		static_cast<double>(data.size()) / 1048576,
+		messageCount / passes,
+		passes,
+		static_cast<double>(data.size()) * passes / 1048576 / elapsed,
+		messageCount ? elapsed * 1000000000 / messageCount : 0.,
+		raw.Capacity() / 1024,
+		processed.Capacity() / 1024);
+}
+
+std::string App::LoaderApp::Actions::Benchmark::ReplayCapture(const std::filesystem::path& path) const {
+	using namespace Sqex::Network;
+
+	const Capture::Reader reader(path);
+	const Capture::MessageHandler passThrough = [](Structures::FFXIVMessage*) { return true; };
+
+	// Runs what IpcTypeFinder does for each message, short of logging.
+	size_t candidateCount = 0;
+	const IpcTypeFinder::CandidateCallback countCandidate = [&candidateCount](const std::string&, bool) { ++candidateCount; };
+	const Capture::MessageHandler findIncoming = [&countCandidate](Structures::FFXIVMessage* pMessage) {
+		IpcTypeFinder::FindIncoming(*pMessage, countCandidate);
+		return true;
+	};
+	const Capture::MessageHandler findOutgoing = [&countCandidate](Structures::FFXIVMessage* pMessage) {
+		IpcTypeFinder::FindOutgoing(*pMessage, countCandidate);
+		return true;
+	};
+
+	const auto describe = [](const char* name, const Capture::ReplayStatistics& stats) {
+		return std::format("\n{}: {} records, {}KiB, {} messages, latency p50={:.1f}us p90={:.1f}us p99={:.1f}us p99.9={:.1f}us max={:.1f}us",
+			name,
+			stats.RecordCount,
+			stats.ByteCount / 1024,
+			stats.MessageLatencyNanoseconds.size(),
+			static_cast<double>(stats.Percentile(0.5)) / 1000,
+			static_cast<double>(stats.Percentile(0.9)) / 1000,
+			static_cast<double>(stats.Percentile(0.99)) / 1000,
+			static_cast<double>(stats.Percentile(0.999)) / 1000,
+			static_cast<double>(stats.Percentile(1)) / 1000);
+	};
+	const auto replay = [&](const char* name, const Capture::MessageHandler& incomingHandler, const Capture::MessageHandler& outgoingHandler) {
+		const auto result = Capture::Replay(reader, m_args.m_replayOriginalTiming, incomingHandler, outgoingHandler);
+		return std::format("\n[{}] replayed in {:.1f}ms{}{}",
+			name,
+			std::chrono::duration<double, std::milli>(result.Elapsed).count(),
+			describe("recv", result.Recv),
+			describe("send", result.Send));
+	};
+
+	const auto passThroughReport = replay("pass-through", passThrough, passThrough);
+	const auto ipcTypeFinderReport = replay("IpcTypeFinder", findIncoming, findOutgoing);
+
+	const auto& records = reader.Records();
+	return std::format("{}: {:.1f}s captured{}{}{}, {} candidates",
+		path.filename().string(),
+		records.empty() ? 0. : static_cast<double>(records.back().TimestampMicroseconds - records.front().TimestampMicroseconds) / 1000000,
+		m_args.m_replayOriginalTiming ? " (original timing)" : "",
+		passThroughReport,
+		ipcTypeFinderReport,
+		candidateCount);
+}
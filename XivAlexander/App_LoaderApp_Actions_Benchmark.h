@@ -0,0 +1,20 @@
+#pragma once
+#include "App_LoaderApp_Arguments.h"
+
+namespace App::LoaderApp::Actions {
+	class Benchmark {
+		const Arguments& m_args;
+
+	public:
+		Benchmark(const Arguments& args);
+
+		int Run();
+
+	private:
+		// Goes to standard output if --quiet is given, so that benchmarks can run unattended; shown in a message box otherwise.
+		void Report(const std::string& report) const;
+
+		[[nodiscard]] std::string TunnelXivStream(const std::filesystem::path& path) const;
+		[[nodiscard]] std::string ReplayCapture(const std::filesystem::path& path) const;
+	};
+}
@@ -93,6 +93,10 @@ App::LoaderApp::Arguments::Arguments()
 		.required()
 		.default_value(false)
 		.implicit_value(true);
+	argp.add_argument("--replay-original-timing")
+		.help(Utils::ToUtf8(FindStringResourceEx(Dll::Module(), IDS_HELP_INTERNAL_USE_ONLY) + 1))
+		.default_value(false)
+		.implicit_value(true);
 	argp.add_argument("--wait-process")
 		.help(Utils::ToUtf8(FindStringResourceEx(Dll::Module(), IDS_HELP_INTERNAL_USE_ONLY) + 1))
 		.required()
@@ -130,6 +134,7 @@ void App::LoaderApp::Arguments::Parse() {
 	m_launcherType = argp.get<LauncherType>("--launcher");
 	m_quiet = argp.get<bool>("--quiet");
 	m_disableAutoRunAs = argp.get<bool>("--disable-runas");
+	m_replayOriginalTiming = argp.get<bool>("--replay-original-timing");
 	if (const auto waitHandle = argp.get<Utils::Win32::Process>("--wait-process"))
 		waitHandle.Wait();
 
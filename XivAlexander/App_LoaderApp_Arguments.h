@@ -29,6 +29,7 @@ namespace App::LoaderApp {
 		bool m_quiet = false;
 		bool m_help = false;
 		bool m_disableAutoRunAs = true;
+		bool m_replayOriginalTiming = false;
 		std::set<DWORD> m_targetPids{};
 		std::vector<Utils::Win32::Process> m_targetProcessHandles{};
 		std::set<std::wstring> m_targetSuffix{};
@@ -6,6 +6,7 @@
 #include <XivAlexanderCommon/Utils_Win32_InjectedModule.h>
 #include <XivAlexanderCommon/Utils_Win32_Resource.h>
 
+#include "App_LoaderApp_Actions_Benchmark.h"
 #include "App_LoaderApp_Actions_Inject.h"
 #include "App_LoaderApp_Actions_InstallUninstall.h"
 #include "App_LoaderApp_Actions_Interactive.h"
@@ -90,6 +91,10 @@ public:
 				case LoaderAction::Internal_Update_Step2_ReplaceFiles:
 				case LoaderAction::Internal_Update_Step3_CleanupFiles:
 					return Actions::Update(m_args).Run();
+
+				case LoaderAction::Internal_Benchmark_TunnelXivStream:
+				case LoaderAction::Internal_Benchmark_ReplayCapture:
+					return Actions::Benchmark(m_args).Run();
 			}
 
 			throw std::logic_error("invalid m_action value");
@@ -8,6 +8,7 @@
 #include <XivAlexanderCommon/Sqex_Sound_Reader.h>
 #include <XivAlexanderCommon/Sqex_Sound_Writer.h>
 #include <XivAlexanderCommon/Sqex_Sqpack_Creator.h>
+#include <XivAlexanderCommon/Sqex_Sqpack_EntryCache.h>
 #include <XivAlexanderCommon/Sqex_Sqpack_EntryProvider.h>
 #include <XivAlexanderCommon/Sqex_Sqpack_EntryRawStream.h>
 #include <XivAlexanderCommon/Sqex_Sqpack_Reader.h>
@@ -60,6 +61,7 @@ struct App::Misc::VirtualSqPacks::Implementation {
 		const auto actCtx = Dll::ActivationContext().With();
 		Window::ProgressPopupWindow progressWindow(Dll::FindGameMainWindow(false));
 		progressWindow.Show();
+		Sqex::Sqpack::EntryCache::Instance().Configure(Config->Init.ResolveConfigStorageDirectoryPath() / "Cached" / "Entries");
 		InitializeSqPacks(progressWindow);
 		ReflectUsedEntries(true);
 
@@ -142,15 +144,11 @@ struct App::Misc::VirtualSqPacks::Implementation {
 				}
 
 				const auto pathSpec = Sqex::Sqpack::EntryPathSpec(entry.FullPath);
-				auto entryIt = it->second.HashOnlyEntries.find(pathSpec);
-				if (entryIt == it->second.HashOnlyEntries.end()) {
-					entryIt = it->second.FullPathEntries.find(pathSpec);
-					if (entryIt == it->second.FullPathEntries.end()) {
-						continue;
-					}
-				}
+				const auto sqpackEntry = it->second.EntriesByPath.Find(pathSpec);
+				if (!sqpackEntry)
+					continue;
 
-				const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>(entryIt->second->Provider.get());
+				const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>((*sqpackEntry)->Provider.get());
 				if (!provider)
 					continue;
 
@@ -170,15 +168,11 @@ struct App::Misc::VirtualSqPacks::Implementation {
 							}
 
 							const auto pathSpec = Sqex::Sqpack::EntryPathSpec(entry.FullPath);
-							auto entryIt = it->second.HashOnlyEntries.find(pathSpec);
-							if (entryIt == it->second.HashOnlyEntries.end()) {
-								entryIt = it->second.FullPathEntries.find(pathSpec);
-								if (entryIt == it->second.FullPathEntries.end()) {
-									continue;
-								}
-							}
+							const auto sqpackEntry = it->second.EntriesByPath.Find(pathSpec);
+							if (!sqpackEntry)
+								continue;
 
-							const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>(entryIt->second->Provider.get());
+							const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>((*sqpackEntry)->Provider.get());
 							if (!provider)
 								continue;
 
@@ -601,7 +595,8 @@ struct App::Misc::VirtualSqPacks::Implementation {
 					const auto versionContent = versionFile.Read<char>(0, static_cast<size_t>(versionFile.GetFileSize()));
 					currentCacheKeys += std::format("SQPACK:{}:{}\n", canonical(additionalSqpackRootDirectory).wstring(), std::string(versionContent.begin(), versionContent.end()));
 
-					readers.emplace_back(std::make_unique<Sqex::Sqpack::Reader>(file));
+					// Every EXH and every EXD page of every language is looked up from these, so hash tables pay for themselves.
+					readers.emplace_back(std::make_unique<Sqex::Sqpack::Reader>(file, false, true, true));
 				}
 
 				for (const auto& configFile : excelTransformConfigFiles) {
@@ -1106,7 +1101,7 @@ struct App::Misc::VirtualSqPacks::Implementation {
 
 												const auto targetPath = cachedDir / entryPathSpec.FullPath;
 
-												const auto provider = Sqex::Sqpack::MemoryBinaryEntryProvider(entryPathSpec, std::make_shared<Sqex::MemoryRandomAccessStream>(std::move(*reinterpret_cast<std::vector<uint8_t>*>(&data))));
+												const auto provider = Sqex::Sqpack::MemoryBinaryEntryProvider(entryPathSpec, std::make_shared<Sqex::MemoryRandomAccessStream>(std::move(*reinterpret_cast<std::vector<uint8_t>*>(&data))), Sqex::Sqpack::CompressionPolicy::Adaptive);
 												const auto len = provider.StreamSize();
 												const auto dv = provider.ReadStreamIntoVector<char>(0, static_cast<SSIZE_T>(len));
 
@@ -1415,9 +1410,9 @@ struct App::Misc::VirtualSqPacks::Implementation {
 									CharLowerW(&extension[0]);
 
 									if (extension == L".tex")
-										provider = std::make_shared<Sqex::Sqpack::MemoryTextureEntryProvider>(entryPathSpec, stream);
+										provider = std::make_shared<Sqex::Sqpack::MemoryTextureEntryProvider>(entryPathSpec, stream, Sqex::Sqpack::CompressionPolicy::Adaptive);
 									else
-										provider = std::make_shared<Sqex::Sqpack::MemoryBinaryEntryProvider>(entryPathSpec, stream);
+										provider = std::make_shared<Sqex::Sqpack::MemoryBinaryEntryProvider>(entryPathSpec, stream, Sqex::Sqpack::CompressionPolicy::Adaptive);
 									const auto len = provider->StreamSize();
 									const auto dv = provider->ReadStreamIntoVector<char>(0, static_cast<SSIZE_T>(len));
 									progress += stream->StreamSize();
@@ -1729,26 +1724,22 @@ App::Misc::VirtualSqPacks::OverlayedHandleData* App::Misc::VirtualSqPacks::Get(H
 
 bool App::Misc::VirtualSqPacks::EntryExists(const Sqex::Sqpack::EntryPathSpec& pathSpec) const {
 	return std::ranges::any_of(m_pImpl->SqpackViews | std::views::values, [&pathSpec](const auto& t) {
-		return t.HashOnlyEntries.find(pathSpec) != t.HashOnlyEntries.end()
-			|| (pathSpec.HasOriginal() && t.FullPathEntries.find(pathSpec) != t.FullPathEntries.end());
+		return t.EntriesByPath.Find(pathSpec) != nullptr;
 	});
 }
 
 std::shared_ptr<Sqex::RandomAccessStream> App::Misc::VirtualSqPacks::GetOriginalEntry(const Sqex::Sqpack::EntryPathSpec& pathSpec) const {
 	for (const auto& pack : m_pImpl->SqpackViews | std::views::values) {
-		auto it = pack.HashOnlyEntries.find(pathSpec);
-		if (it == pack.HashOnlyEntries.end()) {
-			it = pack.FullPathEntries.find(pathSpec);
-			if (it == pack.FullPathEntries.end()) {
-				continue;
-			}
-		}
+		const auto sqpackEntry = pack.EntriesByPath.Find(pathSpec);
+		if (!sqpackEntry)
+			continue;
 
-		const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>(it->second->Provider.get());
+		// Original entries are usually read whole, such as sound files being imported, so their blocks are inflated in parallel.
+		const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>((*sqpackEntry)->Provider.get());
 		if (!provider)
-			return std::make_shared<Sqex::Sqpack::EntryRawStream>(it->second->Provider.get());
+			return std::make_shared<Sqex::Sqpack::EntryRawStream>((*sqpackEntry)->Provider.get(), true);
 
-		return std::make_shared<Sqex::Sqpack::EntryRawStream>(provider->GetBaseStream());
+		return std::make_shared<Sqex::Sqpack::EntryRawStream>(provider->GetBaseStream(), true);
 	}
 	throw std::out_of_range("entry not found");
 }
@@ -1855,15 +1846,11 @@ void App::Misc::VirtualSqPacks::AddNewTtmp(const std::filesystem::path& ttmpl, b
 			continue;
 
 		const auto pathSpec = Sqex::Sqpack::EntryPathSpec(entry.FullPath);
-		auto entryIt = it->second.HashOnlyEntries.find(pathSpec);
-		if (entryIt == it->second.HashOnlyEntries.end()) {
-			entryIt = it->second.FullPathEntries.find(pathSpec);
-			if (entryIt == it->second.FullPathEntries.end()) {
-				continue;
-			}
-		}
+		const auto sqpackEntry = it->second.EntriesByPath.Find(pathSpec);
+		if (!sqpackEntry)
+			continue;
 
-		const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>(entryIt->second->Provider.get());
+		const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>((*sqpackEntry)->Provider.get());
 		if (!provider)
 			continue;
 
@@ -1879,15 +1866,11 @@ void App::Misc::VirtualSqPacks::AddNewTtmp(const std::filesystem::path& ttmpl, b
 						continue;
 
 					const auto pathSpec = Sqex::Sqpack::EntryPathSpec(entry.FullPath);
-					auto entryIt = it->second.HashOnlyEntries.find(pathSpec);
-					if (entryIt == it->second.HashOnlyEntries.end()) {
-						entryIt = it->second.FullPathEntries.find(pathSpec);
-						if (entryIt == it->second.FullPathEntries.end()) {
-							continue;
-						}
-					}
+					const auto sqpackEntry = it->second.EntriesByPath.Find(pathSpec);
+					if (!sqpackEntry)
+						continue;
 
-					const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>(entryIt->second->Provider.get());
+					const auto provider = dynamic_cast<Sqex::Sqpack::HotSwappableEntryProvider*>((*sqpackEntry)->Provider.get());
 					if (!provider)
 						continue;
 
@@ -1,171 +1,16 @@
 #include "pch.h"
 #include "App_Network_SocketHook.h"
 
-#include <XivAlexanderCommon/XaZlib.h>
+#include <XivAlexanderCommon/Sqex_Network_Capture.h>
+#include <XivAlexanderCommon/Sqex_Network_SingleStream.h>
+#include <XivAlexanderCommon/Sqex_Network_Structures.h>
 
 #include "App_ConfigRepository.h"
 #include "App_Misc_Logger.h"
 #include "App_Network_IcmpPingTracker.h"
-#include "App_Network_Structures.h"
 #include "App_XivAlexApp.h"
 #include "resource.h"
 
-class SingleStream {
-public:
-	bool m_ending = false;
-	bool m_closed = false;
-
-	Utils::ZlibReusableInflater m_inflater;
-
-	std::vector<uint8_t> m_pending{};
-	std::vector<size_t> m_reservedOffset{};
-	size_t m_pendingStartPos = 0;
-
-	class SingleStreamWriter {
-		SingleStream& m_stream;
-		const size_t m_offset;
-		size_t m_commitLength = 0;
-
-	public:
-		SingleStreamWriter(SingleStream& stream)
-			: m_stream(stream)
-			, m_offset(stream.m_pending.size()) {
-		}
-
-		template<typename T>
-		T* Allocate(size_t length) {
-			m_stream.m_pending.resize(m_offset + m_commitLength + length);
-			return reinterpret_cast<T*>(&m_stream.m_pending[m_offset + m_commitLength]);
-		}
-
-		size_t Write(size_t length) {
-			m_commitLength += length;
-			return length;
-		}
-
-		~SingleStreamWriter() {  // NOLINT(bugprone-exception-escape)
-			m_stream.m_pending.resize(m_offset + m_commitLength);
-		}
-	};
-
-	SingleStreamWriter Write() {
-		return {*this};
-	}
-
-	void Write(const void* buf, size_t length) {
-		const auto uint8buf = static_cast<const uint8_t*>(buf);
-		m_pending.insert(m_pending.end(), uint8buf, uint8buf + length);
-	}
-
-	template<typename T, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
-	void Write(const T& data) {
-		Write(&data, sizeof data);
-	}
-
-	template<typename T = uint8_t, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
-	void Write(const std::span<T>& data) {
-		Write(data.data(), data.size_bytes());
-	}
-
-	template<typename T = uint8_t, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
-	[[nodiscard]] std::span<const T> Peek(size_t count = SIZE_MAX) const {
-		if (m_pending.empty())
-			return {};
-		return {
-			reinterpret_cast<const T*>(&m_pending[m_pendingStartPos]),
-			count == SIZE_MAX ? (m_pending.size() - m_pendingStartPos) / sizeof T : count
-		};
-	}
-
-	template<typename T = uint8_t, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
-	void Consume(size_t count) {
-		m_pendingStartPos += count * sizeof T;
-		if (m_pendingStartPos == m_pending.size()) {
-			m_pending.clear();
-			m_pendingStartPos = 0;
-		} else if (m_pendingStartPos > m_pending.size()) {
-			__debugbreak();
-		}
-	}
-
-	template<typename T, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
-	size_t Read(T* buf, size_t count) {
-		count = std::min(count, (m_pending.size() - m_pendingStartPos) / sizeof T);
-		memcpy(buf, &m_pending[m_pendingStartPos], count * sizeof T);
-		Consume<T>(count);
-		return count;
-	}
-
-	template<typename T = uint8_t, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
-	[[nodiscard]] size_t Available() const {
-		return (m_pending.size() - m_pendingStartPos) / sizeof T;
-	}
-
-	void TunnelXivStream(SingleStream& target, const App::Network::SingleConnection::MessageMangler& messageMangler) {
-		using namespace App::Network::Structures;
-		while (true) {
-			auto buf = Peek();
-			if (buf.empty())
-				break;
-
-			if (const auto trash = FFXIVBundle::ExtractFrontTrash(buf); !trash.empty()) {
-				target.Write(trash);
-				Consume(trash.size_bytes());
-				buf = buf.subspan(trash.size_bytes());
-			}
-
-			// Incomplete header
-			if (buf.size_bytes() < GamePacketHeaderSize)
-				break;
-
-			const auto* pGamePacket = reinterpret_cast<const FFXIVBundle*>(buf.data());
-
-			// Invalid TotalLength
-			if (pGamePacket->TotalLength == 0) {
-				target.Write(buf.subspan(0, 1));
-				Consume(1);
-				continue;
-			}
-
-			// Incomplete data
-			if (buf.size_bytes() < pGamePacket->TotalLength)
-				break;
-
-			try {
-				auto messages = pGamePacket->GetMessages(m_inflater);
-				auto header = *pGamePacket;
-				header.TotalLength = static_cast<uint32_t>(GamePacketHeaderSize);
-				header.MessageCount = 0;
-				header.GzipCompressed = 0;
-
-				for (auto& message : messages) {
-					const auto pMessage = reinterpret_cast<FFXIVMessage*>(&message[0]);
-
-					if (!messageMangler(pMessage))
-						pMessage->Length = 0;
-
-					if (!pMessage->Length)
-						continue;
-
-					header.TotalLength += pMessage->Length;
-					header.MessageCount += 1;
-				}
-
-				target.Write(&header, GamePacketHeaderSize);
-				for (const auto& message : messages) {
-					if (reinterpret_cast<const FFXIVMessage*>(&message[0])->Length)
-						target.Write(std::span(message));
-				}
-			} catch (const std::exception& e) {
-				pGamePacket->DebugPrint(App::LogCategory::SocketHook, e.what());
-				target.Write(pGamePacket, pGamePacket->TotalLength);
-			}
-
-			Consume(pGamePacket->TotalLength);
-		}
-	}
-};
-
 struct App::Network::SingleConnection::Implementation {
 	std::shared_ptr<Misc::Logger> const m_logger;
 	std::shared_ptr<Config> const m_config;
@@ -180,10 +25,13 @@ struct App::Network::SingleConnection::Implementation {
 	std::deque<uint64_t> m_observedServerResponseList{};
 	std::deque<int64_t> m_observedConnectionLatencyList{};
 
-	SingleStream m_recvRaw;
-	SingleStream m_recvProcessed;
-	SingleStream m_sendRaw;
-	SingleStream m_sendProcessed;
+	Sqex::Network::SingleStream m_recvRaw;
+	Sqex::Network::SingleStream m_recvProcessed;
+	Sqex::Network::SingleStream m_sendRaw;
+	Sqex::Network::SingleStream m_sendProcessed;
+
+	std::unique_ptr<Sqex::Network::Capture::Writer> m_capture;
+	bool m_captureFailed = false;
 
 	sockaddr_storage m_localAddress = {AF_UNSPEC};
 	sockaddr_storage m_remoteAddress = {AF_UNSPEC};
@@ -237,24 +85,69 @@ struct App::Network::SingleConnection::Implementation {
 		m_unloading = true;
 	}
 
-	void AttemptReceive() {
-		if (auto write = m_recvRaw.Write();
-			!write.Write(std::max(0, hook_->recv.bridge(this_->m_socket, write.Allocate<char>(65536), 65536, 0))))
+	void Record(Sqex::Network::Capture::Direction direction, std::span<const uint8_t> data) {
+		if (!m_config->Runtime.CaptureNetworkTraffic || m_captureFailed) {
+			m_capture = nullptr;
 			return;
+		}
 
-		ProcessRecvData();
+		try {
+			if (!m_capture) {
+				SYSTEMTIME st;
+				GetLocalTime(&st);
+				const auto path = m_config->Init.ResolveConfigStorageDirectoryPath() / "Captures" / std::format(L"{:04}{:02}{:02}_{:02}{:02}{:02}_{:x}.xacap",
+					st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond, this_->m_socket);
+				create_directories(path.parent_path());
+				m_capture = std::make_unique<Sqex::Network::Capture::Writer>(path);
+				m_logger->Format(LogCategory::SocketHook, L"{:x}: Capturing to {}", this_->m_socket, path.wstring());
+			}
+			m_capture->Write(direction, data);
+		} catch (const std::exception& e) {
+			m_logger->Format<LogLevel::Warning>(LogCategory::SocketHook, "{:x}: Stopped capturing: {}", this_->m_socket, e.what());
+			m_capture = nullptr;
+			m_captureFailed = true;
+		}
+	}
+
+	void AttemptReceive() {
+		// Free space may wrap around the end of the ring buffer; keep going with the part after it as long as recv fills what it is given.
+		auto receivedAny = false;
+		while (true) {
+			auto write = m_recvRaw.Write();
+			const auto buf = write.Allocate<char>(65536);
+			const auto received = std::max(0, hook_->recv.bridge(this_->m_socket, buf.data(), static_cast<int>(buf.size()), 0));
+			if (!write.Write(received))
+				break;
+
+			receivedAny = true;
+			Record(Sqex::Network::Capture::Direction::Recv, {reinterpret_cast<const uint8_t*>(buf.data()), static_cast<size_t>(received)});
+			if (static_cast<size_t>(received) < buf.size())
+				break;
+
+			// Do not block on a blocking socket when nothing is left to read.
+			if (u_long pending = 0; ioctlsocket(this_->m_socket, FIONREAD, &pending) || !pending)
+				break;
+		}
+
+		if (receivedAny)
+			ProcessRecvData();
 	}
 
 	void AttemptSend() {
-		const auto data = m_sendProcessed.Peek<char>();
-		if (data.empty())
-			return;
+		// Pending data may wrap around the end of the ring buffer; keep going with the part after it as long as send takes everything.
+		while (true) {
+			const auto data = m_sendProcessed.PeekContiguous<char>();
+			if (data.empty())
+				return;
 
-		const auto sent = hook_->send.bridge(this_->m_socket, data.data(), static_cast<int>(data.size_bytes()), 0);
-		if (sent == SOCKET_ERROR)
-			return;
+			const auto sent = hook_->send.bridge(this_->m_socket, data.data(), static_cast<int>(data.size_bytes()), 0);
+			if (sent == SOCKET_ERROR)
+				return;
 
-		m_sendProcessed.Consume(sent);
+			m_sendProcessed.Consume(sent);
+			if (static_cast<size_t>(sent) < data.size_bytes())
+				return;
+		}
 	}
 
 	void ProcessRecvData() {
@@ -286,7 +179,7 @@ struct App::Network::SingleConnection::Implementation {
 			}
 
 			return use;
-		});
+		}, [this](const auto& bundle, const auto& e) { LogTunnelError(bundle, e); });
 	}
 
 	void ProcessSendData() {
@@ -307,7 +200,11 @@ struct App::Network::SingleConnection::Implementation {
 			}
 
 			return use;
-		});
+		}, [this](const auto& bundle, const auto& e) { LogTunnelError(bundle, e); });
+	}
+
+	void LogTunnelError(const Structures::FFXIVBundle& bundle, const std::exception& e) const {
+		m_logger->Log(LogCategory::SocketHook, bundle.Describe(e.what()), LogLevel::Debug);
 	}
 
 	bool CloseRecvIfPossible() {
@@ -597,6 +494,7 @@ App::Network::SocketHook::SocketHook(XivAlexApp* pApp)
 							if (conn == nullptr)
 								return send.bridge(s, buf, len, flags);
 
+							conn->m_pImpl->Record(Sqex::Network::Capture::Direction::Send, {reinterpret_cast<const uint8_t*>(buf), static_cast<size_t>(len)});
 							conn->m_pImpl->m_sendRaw.Write(buf, len);
 							conn->m_pImpl->ProcessSendData();
 							conn->m_pImpl->AttemptSend();
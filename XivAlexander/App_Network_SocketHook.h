@@ -13,11 +13,13 @@ namespace App {
 	class XivAlexApp;
 }
 
+namespace Sqex::Network::Structures {
+	struct FFXIVBundle;
+	struct FFXIVMessage;
+}
+
 namespace App::Network {
-	namespace Structures {
-		struct FFXIVBundle;
-		struct FFXIVMessage;
-	}
+	namespace Structures = Sqex::Network::Structures;
 
 	class SocketHook;
 
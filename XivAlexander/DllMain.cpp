@@ -43,6 +43,8 @@ const char* XivAlexDll::LoaderActionToString(LoaderAction val) {
 		case LoaderAction::Internal_Inject_HookEntryPoint: return "_internal_inject_hookentrypoint";
 		case LoaderAction::Internal_Inject_LoadXivAlexanderImmediately: return "_internal_inject_loadxivalexanderimmediately";
 		case LoaderAction::Internal_Inject_UnloadFromHandle: return "_internal_inject_unloadfromhandle";
+		case LoaderAction::Internal_Benchmark_TunnelXivStream: return "_internal_benchmark_tunnelxivstream";
+		case LoaderAction::Internal_Benchmark_ReplayCapture: return "_internal_benchmark_replaycapture";
 	}
 	return "<invalid>";
 }
@@ -30,6 +30,8 @@ namespace XivAlexDll {
 		Internal_Inject_HookEntryPoint,
 		Internal_Inject_LoadXivAlexanderImmediately,
 		Internal_Inject_UnloadFromHandle,
+		Internal_Benchmark_TunnelXivStream,
+		Internal_Benchmark_ReplayCapture,
 		Count_,  // for internal use only
 	};
 
@@ -15,6 +15,7 @@
 // C++ standard library
 #include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <filesystem>
 #include <format>
 #include <fstream>
@@ -36,7 +37,10 @@
 // Windows API, part 1
 #define NOMINMAX
 #define _WINSOCKAPI_   // Prevent <winsock.h> from being included
+#define WIN32_NO_STATUS  // Take NTSTATUS values from <ntstatus.h> instead
 #include <Windows.h>
+#undef WIN32_NO_STATUS
+#include <ntstatus.h>
 #include <winternl.h>
 
 // Windows API, part 2
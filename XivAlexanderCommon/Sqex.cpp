@@ -139,15 +139,184 @@ uint64_t Sqex::RandomAccessStream::ReadStreamPartial(uint64_t offset, void* buf,
 	return ReadStreamPartial(offset, buf, length);
 }
 
+void Sqex::RandomAccessStream::ReadStreamPartialVectored(std::span<ReadRequest> requests) const {
+	for (auto& request : requests)
+		request.Read = ReadStreamPartial(request.Offset, request.Buffer.data(), request.Buffer.size_bytes());
+}
+
+void Sqex::RandomAccessStream::ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const {
+	struct Context {
+		std::shared_ptr<const RandomAccessStream> KeepAlive;
+		const RandomAccessStream* Stream;
+		uint64_t Offset;
+		void* Buffer;
+		uint64_t Length;
+		ReadCompletionCallback Callback;
+	};
+
+	auto ctx = std::make_unique<Context>(weak_from_this().lock(), this, offset, buf, length, std::move(callback));
+	if (!TrySubmitThreadpoolCallback([](PTP_CALLBACK_INSTANCE, void* p) {
+		const auto ctx = std::unique_ptr<Context>(static_cast<Context*>(p));
+		uint64_t read = 0;
+		std::exception_ptr error;
+		try {
+			read = ctx->Stream->ReadStreamPartial(ctx->Offset, ctx->Buffer, ctx->Length);
+		} catch (...) {
+			error = std::current_exception();
+		}
+		ctx->Callback(read, error);
+	}, ctx.get(), nullptr))
+		throw Win32::Error("TrySubmitThreadpoolCallback");
+	void(ctx.release());
+}
+
 void Sqex::RandomAccessStream::ReadStream(uint64_t offset, void* buf, uint64_t length) const {
 	if (ReadStreamPartial(offset, buf, length) != length)
 		throw std::runtime_error("Reached end of stream before reading all of the requested data.");
 }
 
+void Sqex::RandomAccessStream::ReadStreamVectored(std::span<ReadRequest> requests) const {
+	ReadStreamPartialVectored(requests);
+	for (const auto& request : requests)
+		if (request.Read != request.Buffer.size_bytes())
+			throw std::runtime_error("Reached end of stream before reading all of the requested data.");
+}
+
+std::future<void> Sqex::RandomAccessStream::ReadStreamAsync(uint64_t offset, void* buf, uint64_t length) const {
+	auto promise = std::make_shared<std::promise<void>>();
+	auto future = promise->get_future();
+	ReadStreamPartialAsync(offset, buf, length, [promise, length](uint64_t read, std::exception_ptr error) {
+		if (!error && read != length)
+			error = std::make_exception_ptr(std::runtime_error("Reached end of stream before reading all of the requested data."));
+		if (error)
+			promise->set_exception(error);
+		else
+			promise->set_value();
+	});
+	return future;
+}
+
+void Sqex::RandomAccessStreamPartialView::ReadStreamPartialVectored(std::span<ReadRequest> requests) const {
+	std::vector<ReadRequest> translated;
+	translated.reserve(requests.size());
+	for (const auto& request : requests) {
+		const auto offset = std::min(request.Offset, m_size);
+		translated.emplace_back(ReadRequest{
+			.Offset = m_offset + offset,
+			.Buffer = request.Buffer.subspan(0, static_cast<size_t>(std::min<uint64_t>(request.Buffer.size_bytes(), m_size - offset))),
+		});
+	}
+	m_stream->ReadStreamPartialVectored(translated);
+	for (size_t i = 0; i < requests.size(); ++i)
+		requests[i].Read = translated[i].Read;
+}
+
+Sqex::StreamPageCache::StreamPageCache(size_t capacity)
+	: m_capacity(capacity) {
+}
+
+Sqex::StreamPageCache& Sqex::StreamPageCache::Instance() {
+	static StreamPageCache instance;
+	return instance;
+}
+
+size_t Sqex::StreamPageCache::Capacity() const {
+	const auto lock = std::lock_guard(m_mtx);
+	return m_capacity;
+}
+
+void Sqex::StreamPageCache::Capacity(size_t capacity) {
+	const auto lock = std::lock_guard(m_mtx);
+	m_capacity = capacity;
+	EvictUntil(m_capacity);
+}
+
+Sqex::StreamPageCache::Statistics Sqex::StreamPageCache::GetStatistics() const {
+	const auto lock = std::lock_guard(m_mtx);
+	return {
+		.Hits = m_hits,
+		.Misses = m_misses,
+		.Evictions = m_evictions,
+		.Pages = m_index.size(),
+		.Bytes = m_bytes,
+		.Capacity = m_capacity,
+	};
+}
+
+std::shared_ptr<const std::vector<uint8_t>> Sqex::StreamPageCache::Find(const void* owner, uint64_t index) {
+	const auto lock = std::lock_guard(m_mtx);
+	const auto it = m_index.find(Key{owner, index});
+	if (it == m_index.end()) {
+		m_misses++;
+		return nullptr;
+	}
+
+	auto& slot = m_slots[it->second];
+	slot.Referenced = true;
+	m_hits++;
+	return slot.Data;
+}
+
+void Sqex::StreamPageCache::Put(const void* owner, uint64_t index, std::shared_ptr<const std::vector<uint8_t>> data) {
+	const auto lock = std::lock_guard(m_mtx);
+	if (data->size() > m_capacity)
+		return;
+
+	const auto key = Key{owner, index};
+	if (const auto it = m_index.find(key); it != m_index.end())
+		Free(it->second);
+
+	EvictUntil(m_capacity - data->size());
+
+	size_t slotIndex;
+	if (m_freeSlots.empty()) {
+		slotIndex = m_slots.size();
+		m_slots.emplace_back();
+	} else {
+		slotIndex = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	m_bytes += data->size();
+	m_slots[slotIndex] = {key, std::move(data), false};
+	m_index.emplace(key, slotIndex);
+}
+
+void Sqex::StreamPageCache::Forget(const void* owner) {
+	const auto lock = std::lock_guard(m_mtx);
+	for (size_t i = 0; i < m_slots.size(); ++i)
+		if (m_slots[i].Data && m_slots[i].Id.Owner == owner)
+			Free(i);
+}
+
+void Sqex::StreamPageCache::EvictUntil(size_t bytes) {
+	while (m_bytes > bytes) {
+		if (m_hand >= m_slots.size())
+			m_hand = 0;
+
+		auto& slot = m_slots[m_hand];
+		if (slot.Data) {
+			if (slot.Referenced)
+				slot.Referenced = false;
+			else {
+				Free(m_hand);
+				m_evictions++;
+			}
+		}
+		m_hand++;
+	}
+}
+
+void Sqex::StreamPageCache::Free(size_t slotIndex) {
+	auto& slot = m_slots[slotIndex];
+	m_bytes -= slot.Data->size();
+	m_index.erase(slot.Id);
+	slot.Data.reset();
+	m_freeSlots.push_back(slotIndex);
+}
+
 Sqex::BufferedRandomAccessStream::~BufferedRandomAccessStream() {
-	for (const auto addr : m_buffers)
-		if (addr)
-			VirtualFree(addr, 0, MEM_RELEASE);
+	StreamPageCache::Instance().Forget(this);
 }
 
 uint64_t Sqex::BufferedRandomAccessStream::ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const {
@@ -157,26 +326,31 @@ uint64_t Sqex::BufferedRandomAccessStream::ReadStreamPartial(uint64_t offset, vo
 		return 0;
 	if (offset + length > streamSize)
 		length = streamSize - offset;
-	
+
+	auto& cache = StreamPageCache::Instance();
 	auto out = std::span(static_cast<uint8_t*>(buf), static_cast<size_t>(length));
 	auto relativeOffset = static_cast<size_t>(offset - offset / m_bufferSize * m_bufferSize);
 	for (auto i = offset / m_bufferSize * m_bufferSize; i < offset + length; i += m_bufferSize) {
-		auto& buffer = m_buffers[static_cast<size_t>(i / m_bufferSize)];
-		if (!buffer) {
-			buffer = VirtualAlloc(nullptr, m_bufferSize, MEM_COMMIT, PAGE_READWRITE);
-			m_stream->ReadStreamPartial(i, buffer, m_bufferSize);
-		} else {
-			if (!VirtualAlloc(buffer, m_bufferSize, MEM_RESET_UNDO, PAGE_READWRITE))
-				m_stream->ReadStreamPartial(i, buffer, m_bufferSize);
+		const auto pageIndex = i / m_bufferSize;
+		auto page = cache.Find(this, pageIndex);
+		if (!page) {
+			// Underlying streams are not necessarily safe to read from multiple threads.
+			const auto lock = std::lock_guard(m_readMtx);
+			auto data = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(std::min<uint64_t>(m_bufferSize, streamSize - i)));
+			data->resize(static_cast<size_t>(m_stream->ReadStreamPartial(i, data->data(), data->size())));
+			cache.Put(this, pageIndex, data);
+			page = std::move(data);
 		}
 
-		const auto src = std::span(static_cast<uint8_t*>(buffer), std::min(m_bufferSize, static_cast<size_t>(offset + length - i))).subspan(relativeOffset);
+		if (relativeOffset >= page->size())
+			break;
+		const auto src = std::span(*page).subspan(relativeOffset);
 		const auto available = std::min(src.size_bytes(), out.size_bytes());
 		std::copy_n(&src[0], available, &out[0]);
 		out = out.subspan(available);
 		relativeOffset = 0;
-
-		VirtualAlloc(buffer, m_bufferSize, MEM_RESET, PAGE_READWRITE);
+		if (page->size() < m_bufferSize)
+			break;
 	}
 	return length - out.size_bytes();
 }
@@ -201,16 +375,14 @@ Sqex::FileRandomAccessStream::FileRandomAccessStream(std::filesystem::path path,
 	}
 }
 
-Sqex::FileRandomAccessStream::~FileRandomAccessStream() = default;
-
-uint64_t Sqex::FileRandomAccessStream::StreamSize() const {
-	return m_size;
+Sqex::FileRandomAccessStream::~FileRandomAccessStream() {
+	if (m_asyncIo) {
+		WaitForThreadpoolIoCallbacks(m_asyncIo, FALSE);
+		CloseThreadpoolIo(m_asyncIo);
+	}
 }
 
-uint64_t Sqex::FileRandomAccessStream::ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const {
-	if (offset >= m_size)
-		return 0;
-
+void Sqex::FileRandomAccessStream::EnsureOpened() const {
 	if (m_initializationMutex) {
 		if (const auto mtx = m_initializationMutex) {
 			const auto lock = std::lock_guard(*mtx);
@@ -220,7 +392,107 @@ uint64_t Sqex::FileRandomAccessStream::ReadStreamPartial(uint64_t offset, void*
 			}
 		}
 	}
+}
+
+PTP_IO Sqex::FileRandomAccessStream::EnsureAsyncOpened() const {
+	const auto lock = std::lock_guard(m_asyncMtx);
+	if (m_asyncInitialized)
+		return m_asyncIo;
+	m_asyncInitialized = true;
+
+	EnsureOpened();
+	m_asyncFile = Win32::Handle(ReOpenFile(m_file, GENERIC_READ, FILE_SHARE_READ, FILE_FLAG_OVERLAPPED), INVALID_HANDLE_VALUE);
+	if (!m_asyncFile)
+		return nullptr;
+
+	m_asyncIo = CreateThreadpoolIo(m_asyncFile, [](PTP_CALLBACK_INSTANCE instance, void*, void* pOverlapped, ULONG ioResult, ULONG_PTR numberOfBytesTransferred, PTP_IO) {
+		const auto pRead = std::unique_ptr<AsyncReadOverlapped>(static_cast<AsyncReadOverlapped*>(static_cast<OVERLAPPED*>(pOverlapped)));
+		if (ioResult == NO_ERROR || ioResult == ERROR_HANDLE_EOF)
+			pRead->Callback(numberOfBytesTransferred, nullptr);
+		else
+			pRead->Callback(0, std::make_exception_ptr(Win32::Error(ioResult, "ReadFile")));
+
+		// Releasing KeepAlive may destroy the stream, which waits for callbacks including this one.
+		DisassociateCurrentThreadFromCallback(instance);
+	}, nullptr, nullptr);
+	if (!m_asyncIo)
+		m_asyncFile = nullptr;
+	return m_asyncIo;
+}
+
+uint64_t Sqex::FileRandomAccessStream::StreamSize() const {
+	return m_size;
+}
+
+uint64_t Sqex::FileRandomAccessStream::ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const {
+	if (offset >= m_size)
+		return 0;
+
+	EnsureOpened();
 
 	const auto available = static_cast<size_t>(std::min(length, m_size - offset));
 	return m_file.Read(m_offset + offset, buf, available, Win32::Handle::PartialIoMode::AllowPartial);
 }
+
+void Sqex::FileRandomAccessStream::ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const {
+	if (offset >= m_size)
+		return callback(0, nullptr);
+
+	const auto io = EnsureAsyncOpened();
+	if (!io)
+		return RandomAccessStream::ReadStreamPartialAsync(offset, buf, length, std::move(callback));
+
+	const auto available = static_cast<DWORD>(std::min<uint64_t>({length, m_size - offset, 0x7FFFFFFFULL}));
+	auto pRead = std::make_unique<AsyncReadOverlapped>();
+	pRead->Offset = static_cast<DWORD>(m_offset + offset);
+	pRead->OffsetHigh = static_cast<DWORD>((m_offset + offset) >> 32);
+	pRead->KeepAlive = weak_from_this().lock();
+	pRead->Callback = std::move(callback);
+
+	StartThreadpoolIo(io);
+	if (!ReadFile(m_asyncFile, buf, available, nullptr, pRead.get())) {
+		if (const auto err = GetLastError(); err != ERROR_IO_PENDING) {
+			CancelThreadpoolIo(io);
+			if (err == ERROR_HANDLE_EOF)
+				pRead->Callback(0, nullptr);
+			else
+				pRead->Callback(0, std::make_exception_ptr(Win32::Error(err, "ReadFile")));
+			return;
+		}
+	}
+
+	// Completion is always queued to the thread pool, even if ReadFile has completed synchronously.
+	void(pRead.release());
+}
+
+void Sqex::FileRandomAccessStream::ReadStreamPartialVectored(std::span<ReadRequest> requests) const {
+	static constexpr uint64_t MaxCoalescedReadSize = 8 * 1048576;
+
+	std::vector<ReadRequest*> sorted;
+	sorted.reserve(requests.size());
+	for (auto& request : requests)
+		sorted.emplace_back(&request);
+	std::ranges::sort(sorted, {}, [](const ReadRequest* r) { return r->Offset; });
+
+	std::vector<uint8_t> buffer;
+	for (size_t i = 0, j; i < sorted.size(); i = j) {
+		const auto begin = sorted[i]->Offset;
+		auto end = begin + sorted[i]->Buffer.size_bytes();
+		for (j = i + 1; j < sorted.size() && sorted[j]->Offset == end && end - begin < MaxCoalescedReadSize; ++j)
+			end += sorted[j]->Buffer.size_bytes();
+
+		if (j == i + 1) {
+			sorted[i]->Read = ReadStreamPartial(begin, sorted[i]->Buffer.data(), sorted[i]->Buffer.size_bytes());
+			continue;
+		}
+
+		buffer.resize(static_cast<size_t>(end - begin));
+		const auto read = ReadStreamPartial(begin, buffer.data(), buffer.size());
+		for (auto k = i; k < j; ++k) {
+			const auto relativeOffset = sorted[k]->Offset - begin;
+			const auto available = relativeOffset < read ? std::min<uint64_t>(read - relativeOffset, sorted[k]->Buffer.size_bytes()) : 0;
+			std::copy_n(&buffer[static_cast<size_t>(relativeOffset)], static_cast<size_t>(available), sorted[k]->Buffer.begin());
+			sorted[k]->Read = available;
+		}
+	}
+}
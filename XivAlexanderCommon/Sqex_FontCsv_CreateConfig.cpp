@@ -472,6 +472,7 @@ void Sqex::FontCsv::CreateConfig::to_json(nlohmann::json& j, const FontCreateCon
 	j = nlohmann::json::object({
 		{"glyphGap", o.glyphGap},
 		{"compactLayout", o.compactLayout},
+		{"skylinePacking", o.skylinePacking},
 		{"textureWidth", o.textureWidth},
 		{"textureHeight", o.textureHeight},
 		{"textureFormat", o.textureFormat},
@@ -499,6 +500,7 @@ void Sqex::FontCsv::CreateConfig::from_json(const nlohmann::json& j, FontCreateC
 	try {
 		o.glyphGap = j.value<uint16_t>(lastAttempt = "glyphGap", 1);
 		o.compactLayout = j.value(lastAttempt = "compactLayout", false);
+		o.skylinePacking = j.value(lastAttempt = "skylinePacking", false);
 		o.textureWidth = j.value<uint16_t>(lastAttempt = "textureWidth", 1024);
 		o.textureHeight = j.value<uint16_t>(lastAttempt = "textureHeight", 1024);
 		o.textureFormat = Texture::Format::RGBA4444;
@@ -94,7 +94,7 @@ struct Sqex::FontCsv::FontCsvCreator::Implementation {
 
 		void SetMax(size_t planCount, size_t kerningCount, size_t borderThickness) {
 			ProgressWeight_Draw = borderThickness
-				? 1000 * borderThickness * borderThickness  // account for alpha blending
+				? 100 + 20 * borderThickness  // account for dilation and alpha blending
 				: 50;
 			Max =
 				planCount * (ProgressWeight_Bbox + ProgressWeight_Layout + ProgressWeight_Draw) +
@@ -200,10 +200,24 @@ struct Sqex::FontCsv::FontCsvCreator::RenderTarget::Implementation {
 	const uint16_t TextureWidth;
 	const uint16_t TextureHeight;
 	const uint16_t GlyphGap;
+	const PackingMode Packing;
 	uint16_t CurrentX;
 	uint16_t CurrentY;
 	uint16_t CurrentLineHeight;
 
+	struct SkylineSegment {
+		uint16_t X;
+		uint16_t Y;
+		uint16_t Width;
+	};
+
+	// Top edges of the occupied area of each mipmap, from left to right, spanning the whole width.
+	std::vector<std::vector<SkylineSegment>> Skylines;
+
+	size_t GlyphCount = 0;
+	size_t PlaneCount = 0;
+	uint64_t UsedArea = 0;
+
 	std::vector<std::shared_ptr<Texture::MemoryBackedMipmap>> Mipmaps;
 	std::map<std::tuple<char32_t, const SeCompatibleDrawableFont<uint8_t>*, uint8_t, uint8_t, uint8_t, uint8_t>, AllocatedSpace> DrawnGlyphs;
 
@@ -217,60 +231,132 @@ struct Sqex::FontCsv::FontCsvCreator::RenderTarget::Implementation {
 		uint8_t borderOpacity;
 
 		void Work() {
-			if (borderThickness) {
-				for (auto i = 0; i <= 2 * borderThickness; ++i)
-					for (auto j = 0; j <= 2 * borderThickness; ++j)
-						font->Draw(mipmap, x + i, y + j, c, borderOpacity, 0, 0xFF, 0);
-				font->Draw(mipmap, x + borderThickness, y + borderThickness, c, 0xFF, 0, 0xFF, 0);
-			} else
-				font->Draw(mipmap, x, y, c, 0xFF, 0x00);
+			DrawGlyph(mipmap, x, y, c, font, borderThickness, borderOpacity);
 		}
 	};
 
 	std::deque<WorkItem> WorkItems;
 	std::atomic_size_t ProcessedWorkItemIndex;
 
-	std::pair<AllocatedSpace, bool> AllocateSpace(char32_t c, const SeCompatibleDrawableFont<uint8_t>* font, uint8_t boundingWidth, uint8_t boundingHeight, uint8_t borderThickness, uint8_t borderOpacity) {
-		const auto actualGlyphGap = static_cast<uint16_t>(GlyphGap + borderThickness);
+	void AddMipmap() {
+		PlaneCount++;
+		Mipmaps.emplace_back(std::make_shared<Texture::MemoryBackedMipmap>(
+			TextureWidth, TextureHeight,
+			Texture::Format::L8_1,
+			std::vector<uint8_t>(static_cast<size_t>(TextureWidth) * TextureHeight)));
+	}
 
-		const auto [it, isNewEntry] = DrawnGlyphs.emplace(std::make_tuple(c, font, borderThickness, borderOpacity, boundingWidth, boundingHeight), AllocatedSpace{});
-		if (isNewEntry) {
-			auto newTargetRequired = false;
-			if (Mipmaps.empty())
-				newTargetRequired = true;
-			else {
-				if (static_cast<size_t>(0) + CurrentX + boundingWidth + actualGlyphGap >= TextureWidth) {
-					CurrentX = actualGlyphGap;
-					CurrentY += CurrentLineHeight + actualGlyphGap + 1;  // Account for rounding errors
-					CurrentLineHeight = 0;
-				}
-				if (CurrentY + boundingHeight + actualGlyphGap + 1 >= TextureHeight)
-					newTargetRequired = true;
+	AllocatedSpace AllocateShelfSpace(uint8_t boundingWidth, uint8_t boundingHeight, uint16_t actualGlyphGap) {
+		auto newTargetRequired = false;
+		if (Mipmaps.empty())
+			newTargetRequired = true;
+		else {
+			if (static_cast<size_t>(0) + CurrentX + boundingWidth + actualGlyphGap >= TextureWidth) {
+				CurrentX = actualGlyphGap;
+				CurrentY += CurrentLineHeight + actualGlyphGap + 1;  // Account for rounding errors
+				CurrentLineHeight = 0;
 			}
+			if (CurrentY + boundingHeight + actualGlyphGap + 1 >= TextureHeight)
+				newTargetRequired = true;
+		}
 
-			if (newTargetRequired) {
-				Mipmaps.emplace_back(std::make_shared<Texture::MemoryBackedMipmap>(
-					TextureWidth, TextureHeight,
-					Texture::Format::L8_1,
-					std::vector<uint8_t>(static_cast<size_t>(TextureWidth) * TextureHeight)));
-				CurrentX = CurrentY = GlyphGap;
-				CurrentLineHeight = 0;
+		if (newTargetRequired) {
+			AddMipmap();
+			CurrentX = CurrentY = GlyphGap;
+			CurrentLineHeight = 0;
+		}
+
+		if (CurrentX < actualGlyphGap)
+			CurrentX = actualGlyphGap;
+		if (CurrentY < actualGlyphGap)
+			CurrentY = actualGlyphGap;
+
+		const auto space = AllocatedSpace{
+			.Index = static_cast<uint16_t>(Mipmaps.size() - 1),
+			.X = CurrentX,
+			.Y = CurrentY,
+			.BoundingHeight = boundingHeight,
+		};
+
+		CurrentX += boundingWidth + GlyphGap;
+		CurrentLineHeight = std::max<uint16_t>(CurrentLineHeight, boundingHeight);
+		return space;
+	}
+
+	AllocatedSpace AllocateSkylineSpace(uint8_t boundingWidth, uint8_t boundingHeight, uint16_t actualGlyphGap) {
+		// Each glyph takes its bounding box and the gap to its left and top; the gap to its right and bottom belongs to whatever
+		// gets placed there later, or is checked against the texture edges here.
+		const auto width = static_cast<size_t>(actualGlyphGap) + boundingWidth;
+		const auto height = static_cast<size_t>(actualGlyphGap) + boundingHeight + 1;  // Account for rounding errors
+		const auto maxRight = static_cast<size_t>(TextureWidth) - actualGlyphGap - 1;
+		const auto maxBottom = static_cast<size_t>(TextureHeight) - actualGlyphGap - 1;
+		if (width > maxRight || height > maxBottom)
+			throw std::invalid_argument("Glyph is bigger than the texture");
+
+		// Place at the lowest position along any skyline, leftmost on ties, preferring earlier mipmaps.
+		size_t bestIndex = 0, bestY = 0, page = 0;
+		for (; page < Skylines.size(); ++page) {
+			const auto& skyline = Skylines[page];
+			auto found = false;
+			for (size_t i = 0; i < skyline.size() && skyline[i].X + width <= maxRight; ++i) {
+				size_t y = 0;
+				for (size_t j = i, covered = 0; covered < width; covered += skyline[j].Width, ++j)
+					y = std::max<size_t>(y, skyline[j].Y);
+				if (y + height > maxBottom || (found && y >= bestY))
+					continue;
+				found = true;
+				bestIndex = i;
+				bestY = y;
 			}
+			if (found)
+				break;
+		}
+		if (page == Skylines.size()) {
+			AddMipmap();
+			Skylines.emplace_back(std::vector{SkylineSegment{0, 0, TextureWidth}});
+			bestIndex = bestY = 0;
+		}
 
-			if (CurrentX < actualGlyphGap)
-				CurrentX = actualGlyphGap;
-			if (CurrentY < actualGlyphGap)
-				CurrentY = actualGlyphGap;
-
-			it->second = AllocatedSpace{
-				.Index = static_cast<uint16_t>(Mipmaps.size() - 1),
-				.X = CurrentX,
-				.Y = CurrentY,
-				.BoundingHeight = boundingHeight,
-			};
-
-			CurrentX += boundingWidth + GlyphGap;
-			CurrentLineHeight = std::max<uint16_t>(CurrentLineHeight, boundingHeight);
+		// Replace the covered segments with one at the new height, keeping what sticks out past the last one.
+		auto& skyline = Skylines[page];
+		const auto x = skyline[bestIndex].X;
+		const auto right = x + width;
+		auto end = bestIndex;
+		while (end < skyline.size() && skyline[end].X + skyline[end].Width <= right)
+			++end;
+		if (end < skyline.size() && skyline[end].X < right) {
+			skyline[end].Width = static_cast<uint16_t>(skyline[end].X + skyline[end].Width - right);
+			skyline[end].X = static_cast<uint16_t>(right);
+		}
+		skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(bestIndex), skyline.begin() + static_cast<ptrdiff_t>(end));
+		skyline.insert(skyline.begin() + static_cast<ptrdiff_t>(bestIndex), SkylineSegment{x, static_cast<uint16_t>(bestY + height), static_cast<uint16_t>(width)});
+		if (bestIndex + 1 < skyline.size() && skyline[bestIndex + 1].Y == skyline[bestIndex].Y) {
+			skyline[bestIndex].Width += skyline[bestIndex + 1].Width;
+			skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(bestIndex) + 1);
+		}
+		if (bestIndex > 0 && skyline[bestIndex - 1].Y == skyline[bestIndex].Y) {
+			skyline[bestIndex - 1].Width += skyline[bestIndex].Width;
+			skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(bestIndex));
+		}
+
+		return AllocatedSpace{
+			.Index = static_cast<uint16_t>(page),
+			.X = static_cast<uint16_t>(x + actualGlyphGap),
+			.Y = static_cast<uint16_t>(bestY + actualGlyphGap),
+			.BoundingHeight = boundingHeight,
+		};
+	}
+
+	std::pair<AllocatedSpace, bool> AllocateSpace(char32_t c, const SeCompatibleDrawableFont<uint8_t>* font, uint8_t boundingWidth, uint8_t boundingHeight, uint8_t borderThickness, uint8_t borderOpacity) {
+		const auto actualGlyphGap = static_cast<uint16_t>(GlyphGap + borderThickness);
+
+		const auto [it, isNewEntry] = DrawnGlyphs.emplace(std::make_tuple(c, font, borderThickness, borderOpacity, boundingWidth, boundingHeight), AllocatedSpace{});
+		if (isNewEntry) {
+			it->second = Packing == PackingMode::Skyline
+				? AllocateSkylineSpace(boundingWidth, boundingHeight, actualGlyphGap)
+				: AllocateShelfSpace(boundingWidth, boundingHeight, actualGlyphGap);
+			GlyphCount++;
+			UsedArea += static_cast<uint64_t>(boundingWidth) * boundingHeight;
 		}
 
 		return std::make_pair(it->second, isNewEntry);
@@ -284,29 +370,24 @@ struct Sqex::FontCsv::FontCsvCreator::RenderTarget::Implementation {
 				mipmaps[0]->Width(), mipmaps[0]->Height(), Texture::Format::L8_1,
 				std::vector<uint8_t>(static_cast<size_t>(mipmaps[0]->Width()) * mipmaps[0]->Height())));
 
-		for (size_t i = 0; i < mipmaps.size() / 4; ++i) {
-			Mipmaps.push_back(std::make_shared<Texture::MemoryBackedMipmap>(
+		Mipmaps.resize(mipmaps.size() / 4);
+		Win32::ParallelFor(Mipmaps.size(), [&](size_t i) {
+			Mipmaps[i] = std::make_shared<Texture::MemoryBackedMipmap>(
 				mipmaps[0]->Width(), mipmaps[0]->Height(), TextureFormat,
-				std::vector<uint8_t>(sizeof TextureTypeSupportingRGBA * mipmaps[0]->Width() * mipmaps[0]->Height())));
-
-			const auto target = Mipmaps.back()->View<TextureTypeSupportingRGBA>();
-			const auto b = mipmaps[i * 4 + 0]->View<uint8_t>();
-			const auto g = mipmaps[i * 4 + 1]->View<uint8_t>();
-			const auto r = mipmaps[i * 4 + 2]->View<uint8_t>();
-			const auto a = mipmaps[i * 4 + 3]->View<uint8_t>();
-			for (size_t j = 0; j < target.size(); ++j)
-				target[j].SetFrom(
-					r[j] * TextureTypeSupportingRGBA::MaxR / 255,
-					g[j] * TextureTypeSupportingRGBA::MaxG / 255,
-					b[j] * TextureTypeSupportingRGBA::MaxB / 255,
-					a[j] * TextureTypeSupportingRGBA::MaxA / 255
-				);
-		}
+				std::vector<uint8_t>(sizeof TextureTypeSupportingRGBA * mipmaps[0]->Width() * mipmaps[0]->Height()));
+
+			Texture::InterleaveL8Channels(TextureFormat,
+				mipmaps[i * 4 + 2]->View<uint8_t>(),
+				mipmaps[i * 4 + 1]->View<uint8_t>(),
+				mipmaps[i * 4 + 0]->View<uint8_t>(),
+				mipmaps[i * 4 + 3]->View<uint8_t>(),
+				Mipmaps[i]->View<uint8_t>());
+		});
 	}
 };
 
-Sqex::FontCsv::FontCsvCreator::RenderTarget::RenderTarget(uint16_t textureWidth, uint16_t textureHeight, uint16_t glyphGap)
-	: m_pImpl(std::make_unique<Implementation>(textureWidth, textureHeight, glyphGap, glyphGap, glyphGap, 0)) {
+Sqex::FontCsv::FontCsvCreator::RenderTarget::RenderTarget(uint16_t textureWidth, uint16_t textureHeight, uint16_t glyphGap, PackingMode packing)
+	: m_pImpl(std::make_unique<Implementation>(textureWidth, textureHeight, glyphGap, packing, glyphGap, glyphGap, 0)) {
 }
 
 Sqex::FontCsv::FontCsvCreator::RenderTarget::~RenderTarget() = default;
@@ -368,6 +449,75 @@ Sqex::FontCsv::FontCsvCreator::RenderTarget::AllocatedSpace Sqex::FontCsv::FontC
 	return space;
 }
 
+void Sqex::FontCsv::FontCsvCreator::RenderTarget::DrawGlyph(Texture::MemoryBackedMipmap* to, SSIZE_T x, SSIZE_T y, char32_t c, const SeCompatibleDrawableFont<uint8_t>* font, uint8_t borderThickness, uint8_t borderOpacity) {
+	if (!borderThickness) {
+		font->Draw(to, x, y, c, 0xFF, 0x00);
+		return;
+	}
+
+	const SSIZE_T thickness = borderThickness;
+
+	// Render the glyph once, with room for the border on each side.
+	// Measurement may disagree with what actually gets drawn, in which case draw again using the drawn bounding box.
+	auto bbox = font->Measure(0, 0, c);
+	std::shared_ptr<Texture::MemoryBackedMipmap> glyph;
+	for (auto retried = false; ; retried = true) {
+		const auto width = static_cast<uint16_t>(bbox.Width() + 2 * thickness);
+		const auto height = static_cast<uint16_t>(bbox.Height() + 2 * thickness);
+		glyph = std::make_shared<Texture::MemoryBackedMipmap>(width, height, Texture::Format::L8_1, std::vector<uint8_t>(static_cast<size_t>(width) * height));
+		auto drawn = font->Draw(glyph.get(), thickness - bbox.left, thickness - bbox.top, c, 0xFF, 0x00);
+		if (drawn.EffectivelyEmpty())
+			return;
+		if (drawn.left >= thickness && drawn.top >= thickness && drawn.right <= width - thickness && drawn.bottom <= height - thickness)
+			break;
+		if (retried)
+			throw std::runtime_error("Glyph bounding box changed between draws");
+		bbox = drawn.Translate(bbox.left - thickness, bbox.top - thickness);
+	}
+
+	// Drawing the glyph at every offset in a (2t+1) square accumulates the border as 1 - product of (1 - coverage) over the square,
+	// which can be computed separably: first along rows, then along columns.
+	const SSIZE_T width = glyph->Width(), height = glyph->Height();
+	const auto coverage = glyph->View<uint8_t>();
+	std::vector<float> transparency(coverage.size()), rowTransparency(coverage.size());
+	for (size_t i = 0; i < coverage.size(); ++i)
+		transparency[i] = 1.f - coverage[i] / 255.f;
+	for (SSIZE_T sy = 0; sy < height; ++sy) {
+		const auto row = &transparency[sy * width];
+		for (SSIZE_T sx = 0; sx < width; ++sx) {
+			auto product = 1.f;
+			for (auto k = std::max<SSIZE_T>(0, sx - thickness), kTo = std::min(width - 1, sx + thickness); k <= kTo; ++k)
+				product *= row[k];
+			rowTransparency[sy * width + sx] = product;
+		}
+	}
+	for (SSIZE_T sy = 0; sy < height; ++sy) {
+		for (SSIZE_T sx = 0; sx < width; ++sx) {
+			auto product = 1.f;
+			for (auto k = std::max<SSIZE_T>(0, sy - thickness), kTo = std::min(height - 1, sy + thickness); k <= kTo; ++k)
+				product *= rowTransparency[k * width + sx];
+			transparency[sy * width + sx] = product;
+		}
+	}
+
+	// Composite the border and then the glyph over the target, where the glyph origin lands at (x + t, y + t).
+	const SSIZE_T targetWidth = to->Width(), targetHeight = to->Height();
+	const auto target = to->View<uint8_t>();
+	const auto offsetX = x + bbox.left, offsetY = y + bbox.top;
+	for (auto sy = std::max<SSIZE_T>(0, -offsetY), syTo = std::min(height, targetHeight - offsetY); sy < syTo; ++sy) {
+		for (auto sx = std::max<SSIZE_T>(0, -offsetX), sxTo = std::min(width, targetWidth - offsetX); sx < sxTo; ++sx) {
+			const auto borderTransparency = transparency[sy * width + sx];
+			const uint32_t glyphOpacity = coverage[sy * width + sx];
+			if (borderTransparency == 1.f && !glyphOpacity)
+				continue;
+
+			auto& pixel = target[(offsetY + sy) * targetWidth + offsetX + sx];
+			const auto bordered = static_cast<uint32_t>(std::lround(pixel * borderTransparency + borderOpacity * (1.f - borderTransparency)));
+			pixel = static_cast<uint8_t>((bordered * (255 - glyphOpacity) + 255 * glyphOpacity) / 255);
+		}
+	}
+}
+
 bool Sqex::FontCsv::FontCsvCreator::RenderTarget::WorkOnNextItem() {
 	const auto index = m_pImpl->ProcessedWorkItemIndex++;
 	if (index >= m_pImpl->WorkItems.size())
@@ -448,6 +598,19 @@ uint16_t Sqex::FontCsv::FontCsvCreator::RenderTarget::TextureHeight() const {
 	return m_pImpl->TextureHeight;
 }
 
+Sqex::FontCsv::FontCsvCreator::RenderTarget::PackingMode Sqex::FontCsv::FontCsvCreator::RenderTarget::Packing() const {
+	return m_pImpl->Packing;
+}
+
+Sqex::FontCsv::FontCsvCreator::RenderTarget::PackingStatistics Sqex::FontCsv::FontCsvCreator::RenderTarget::GetPackingStatistics() const {
+	return {
+		.GlyphCount = m_pImpl->GlyphCount,
+		.PlaneCount = m_pImpl->PlaneCount,
+		.UsedArea = m_pImpl->UsedArea,
+		.TotalArea = static_cast<uint64_t>(m_pImpl->PlaneCount) * m_pImpl->TextureWidth * m_pImpl->TextureHeight,
+	};
+}
+
 void Sqex::FontCsv::FontCsvCreator::Step2_Layout(RenderTarget& renderTarget) {
 	try {
 		const auto borderThickness = static_cast<uint8_t>(this->BorderOpacity ? this->BorderThickness : 0);
@@ -457,6 +620,18 @@ void Sqex::FontCsv::FontCsvCreator::Step2_Layout(RenderTarget& renderTarget) {
 		m_pImpl->Result->TextureHeight(renderTarget.TextureHeight());
 		m_pImpl->Result->Points(SizePoints);
 		m_pImpl->Result->ReserveStorage(m_pImpl->Plans.size(), m_pImpl->Kernings.size());
+
+		struct Placement {
+			const CharacterPlan* Plan;
+			SSIZE_T LeftExtension;
+			SSIZE_T DrawOffsetY;
+			uint8_t BoundingWidth;
+			uint8_t BoundingHeight;
+			int8_t NextOffsetX;
+			int8_t CurrentOffsetY;
+		};
+		std::vector<Placement> placements;
+		placements.reserve(m_pImpl->Plans.size());
 		for (auto& plan : m_pImpl->Plans) {
 			if (m_pImpl->Cancelled)
 				return;
@@ -489,12 +664,28 @@ void Sqex::FontCsv::FontCsvCreator::Step2_Layout(RenderTarget& renderTarget) {
 			currentOffsetY += static_cast<int8_t>(plan.OffsetYModifier());
 
 			boundingHeight += static_cast<SSIZE_T>(2) * borderThickness;
-			const auto space = renderTarget.QueueDraw(plan.Character(), plan.Font,
-				leftExtension, drawOffsetY,
-				boundingWidth, boundingHeight, borderThickness, borderOpacity);
+			placements.emplace_back(Placement{&plan, leftExtension, drawOffsetY, boundingWidth, boundingHeight, nextOffsetX, currentOffsetY});
+		}
 
-			boundingHeight = std::min(space.BoundingHeight, boundingHeight);
-			m_pImpl->Result->AddFontEntry(plan.Character(), space.Index, space.X, space.Y, boundingWidth, boundingHeight, nextOffsetX, currentOffsetY);
+		// Skyline packing leaves the least space behind when taller glyphs go first.
+		if (renderTarget.Packing() == RenderTarget::PackingMode::Skyline) {
+			std::ranges::stable_sort(placements, [](const Placement& l, const Placement& r) {
+				if (l.BoundingHeight != r.BoundingHeight)
+					return l.BoundingHeight > r.BoundingHeight;
+				return l.BoundingWidth > r.BoundingWidth;
+			});
+		}
+
+		for (const auto& placement : placements) {
+			if (m_pImpl->Cancelled)
+				return;
+
+			const auto space = renderTarget.QueueDraw(placement.Plan->Character(), placement.Plan->Font,
+				placement.LeftExtension, placement.DrawOffsetY,
+				placement.BoundingWidth, placement.BoundingHeight, borderThickness, borderOpacity);
+
+			const auto boundingHeight = std::min(space.BoundingHeight, placement.BoundingHeight);
+			m_pImpl->Result->AddFontEntry(placement.Plan->Character(), space.Index, space.X, space.Y, placement.BoundingWidth, boundingHeight, placement.NextOffsetX, placement.CurrentOffsetY);
 		}
 	} catch (const std::exception& e) {
 		OnError(e);
@@ -565,6 +756,7 @@ struct Sqex::FontCsv::FontSetsCreator::Implementation {
 	std::map<std::filesystem::path, std::unique_ptr<Sqpack::Reader>> SqpackReaders;
 	std::map<std::tuple<std::filesystem::path, std::filesystem::path>, std::vector<std::shared_ptr<const Texture::MipmapStream>>> GameTextures;
 	std::map<std::string, std::shared_ptr<const SeCompatibleDrawableFont<uint8_t>>> SourceFonts;
+	const std::shared_ptr<FreeTypeFont::GlyphBitmapCache> FreeTypeGlyphCache = std::make_shared<FreeTypeFont::GlyphBitmapCache>();
 	std::map<std::string, std::filesystem::path> ResolvedGameIndexFiles;
 
 	ResultFontSets Result;
@@ -640,7 +832,8 @@ struct Sqex::FontCsv::FontSetsCreator::Implementation {
 					try {
 						const auto texturePath = std::format(source.texturePath.string(), i + 1);
 						auto provider = reader->second->GetEntryProvider(texturePath);
-						auto rawTextureStream = std::make_shared<Sqpack::EntryRawStream>(std::move(provider));
+						// Font textures are read whole right below, so their blocks are inflated in parallel.
+						auto rawTextureStream = std::make_shared<Sqpack::EntryRawStream>(std::move(provider), true);
 						auto mipmap = Texture::MipmapStream::FromTexture(std::move(rawTextureStream), 0);
 
 						// preload sqex entry layout so that we can process stuff multithreaded later
@@ -703,10 +896,12 @@ struct Sqex::FontCsv::FontSetsCreator::Implementation {
 				if (source.fontFile.empty() && source.familyName.empty())
 					throw std::invalid_argument("Neither of fontFile nor familyName was specified.");
 
+				std::shared_ptr<FreeTypeDrawingFont<uint8_t>> ftfont;
+
 				std::string accumulatedError;
 				if (!source.fontFile.empty()) {
 					try {
-						newFont = std::make_shared<FreeTypeDrawingFont<uint8_t>>(
+						ftfont = std::make_shared<FreeTypeDrawingFont<uint8_t>>(
 							source.fontFile, source.faceIndex, static_cast<float>(source.height), source.loadFlags
 						);
 					} catch (const std::exception& e) {
@@ -716,9 +911,9 @@ struct Sqex::FontCsv::FontSetsCreator::Implementation {
 					}
 				}
 
-				if (!newFont && !source.familyName.empty()) {
+				if (!ftfont && !source.familyName.empty()) {
 					try {
-						newFont = std::make_shared<FreeTypeDrawingFont<uint8_t>>(
+						ftfont = std::make_shared<FreeTypeDrawingFont<uint8_t>>(
 							FromUtf8(source.familyName).c_str(), static_cast<float>(source.height), static_cast<DWRITE_FONT_WEIGHT>(source.weight), source.stretch, source.style, source.loadFlags
 						);
 					} catch (const std::exception& e) {
@@ -728,9 +923,11 @@ struct Sqex::FontCsv::FontSetsCreator::Implementation {
 					}
 				}
 
-				if (!newFont)
+				if (!ftfont)
 					throw std::invalid_argument(accumulatedError);
 
+				ftfont->SetGlyphBitmapCache(FreeTypeGlyphCache);
+				newFont = std::move(ftfont);
 				newFont->AdvanceWidthDelta(source.advanceWidthDelta);
 			} else
 				throw std::invalid_argument("Could not identify which font to load.");
@@ -751,7 +948,8 @@ struct Sqex::FontCsv::FontSetsCreator::Implementation {
 		for (const auto& target : Config.targets) {
 			const auto& textureGroupFilenamePattern = target.first;
 			const auto& fonts = target.second;
-			renderTargets.emplace(textureGroupFilenamePattern, std::make_unique<FontCsvCreator::RenderTarget>(Config.textureWidth, Config.textureHeight, Config.glyphGap));
+			renderTargets.emplace(textureGroupFilenamePattern, std::make_unique<FontCsvCreator::RenderTarget>(Config.textureWidth, Config.textureHeight, Config.glyphGap,
+				Config.skylinePacking ? FontCsvCreator::RenderTarget::PackingMode::Skyline : FontCsvCreator::RenderTarget::PackingMode::Shelf));
 			TextureGroupWorkPools.emplace(textureGroupFilenamePattern, std::make_unique<Win32::TpEnvironment>());
 			Result.Result.emplace(textureGroupFilenamePattern, ResultFontSet{});
 			auto& remainingFonts = ResultWork.emplace(textureGroupFilenamePattern, std::map<std::string, std::unique_ptr<FontCsvCreator>>()).first->second;
@@ -917,6 +1115,7 @@ struct Sqex::FontCsv::FontSetsCreator::Implementation {
 								target.Finalize(Config.textureFormat);
 
 								resultSet.Textures = target.AsTextureStreamVector();
+								resultSet.Statistics = target.GetPackingStatistics();
 							} catch (const std::exception& e) {
 								if (LastErrorMessage.empty()) {
 									LastErrorMessage = e.what() && *e.what() ? e.what() : "Unknown error";
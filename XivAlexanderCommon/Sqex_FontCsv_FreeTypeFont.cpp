@@ -7,6 +7,7 @@ struct Sqex::FontCsv::FreeTypeFont::Implementation {
 	class LibraryAccessor;
 
 	FreeTypeFont* const this_;
+	const std::filesystem::path Path;
 	const Win32::Handle File;
 	const Win32::FileMapping FileMapping;
 	const Win32::FileMapping::View FileMappingView;
@@ -39,11 +40,15 @@ public:
 	std::vector<FT_Face> FaceSlots;
 	std::mutex FaceSlotMtx;
 
+	std::shared_ptr<GlyphBitmapCache> GlyphCache;
+	uint32_t GlyphCacheFontId = 0;
+
 	const std::vector<char32_t> CharacterList;
 	const std::map<std::pair<char32_t, char32_t>, SSIZE_T> KerningMap;
 
 	Implementation(FreeTypeFont* this_, const std::filesystem::path& path, int faceIndex, float size)
 		: this_(this_)
+		, Path(path)
 		, File(Win32::Handle::FromCreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0))
 		, FileMapping(Win32::FileMapping::Create(File))
 		, FileMappingView(Win32::FileMapping::View::Create(FileMapping))
@@ -158,7 +163,154 @@ const std::map<std::pair<char32_t, char32_t>, SSIZE_T>& Sqex::FontCsv::FreeTypeF
 }
 
 Sqex::FontCsv::GlyphMeasurement Sqex::FontCsv::FreeTypeFont::Measure(SSIZE_T x, SSIZE_T y, char32_t c) const {
-	return GetFace(c).ToMeasurement(x, y);
+	if (!m_pImpl->GlyphCache)
+		return GetFace(c).ToMeasurement(x, y);
+
+	// Rendering costs little more than loading the glyph, and the rendered glyph will be drawn later anyway.
+	auto bbox = RenderGlyph(c)->Bbox;
+	if (bbox.empty)
+		return bbox;
+	bbox.advanceX += m_advanceWidthDelta;
+	return bbox.Translate(x, y);
+}
+
+void Sqex::FontCsv::FreeTypeFont::SetGlyphBitmapCache(std::shared_ptr<GlyphBitmapCache> cache) {
+	m_pImpl->GlyphCacheFontId = cache ? cache->GetFontId(m_pImpl->Path, m_pImpl->FaceIndex, m_pImpl->Size, m_loadFlags) : 0;
+	m_pImpl->GlyphCache = std::move(cache);
+}
+
+std::shared_ptr<const Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::Glyph> Sqex::FontCsv::FreeTypeFont::RenderGlyph(char32_t c) const {
+	if (m_pImpl->GlyphCache) {
+		if (auto glyph = m_pImpl->GlyphCache->Find(m_pImpl->GlyphCacheFontId, c))
+			return glyph;
+	}
+
+	auto glyph = std::make_shared<GlyphBitmapCache::Glyph>();
+	{
+		const auto face = GetFace(c, FT_LOAD_RENDER);
+		glyph->Bbox = face.ToMeasurement(0, 0);
+		if (!glyph->Bbox.empty) {
+			glyph->Bbox.advanceX -= m_advanceWidthDelta;
+
+			FT_Bitmap target;
+			auto temporaryTarget = false;
+			const auto targetCleanup = CallOnDestruction([&face, &target, &temporaryTarget]() {
+				if (temporaryTarget)
+					Succ(FT_Bitmap_Done(face.GetLibraryUnprotected(), &target));
+			});
+			if (face->glyph->bitmap.width != face->glyph->bitmap.pitch) {
+				FT_Bitmap_Init(&target);
+				Succ(FT_Bitmap_Convert(face.GetLibraryUnprotected(), &face->glyph->bitmap, &target, 1));
+				temporaryTarget = true;
+			} else
+				target = face->glyph->bitmap;
+
+			glyph->Levels = target.num_grays;
+			if (const auto area = static_cast<size_t>(glyph->Bbox.Area()))
+				glyph->Bitmap.assign(target.buffer, target.buffer + area);
+		}
+	}
+
+	if (m_pImpl->GlyphCache)
+		return m_pImpl->GlyphCache->Insert(m_pImpl->GlyphCacheFontId, c, std::move(glyph));
+	return glyph;
+}
+
+struct Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::Implementation {
+	struct Node {
+		uint64_t Key;
+		std::shared_ptr<const Glyph> Value;
+		Node* Next;
+	};
+
+	static constexpr size_t BucketCountBits = 16;
+
+	const size_t MaxBytes;
+	std::atomic_size_t Bytes = 0;
+	std::atomic_size_t Count = 0;
+
+	// Nodes are only ever prepended to a bucket and never modified afterwards, so readers can walk the chains without locking.
+	std::vector<std::atomic<Node*>> Buckets;
+
+	std::mutex FontIdMtx;
+	std::map<std::tuple<std::filesystem::path, int, float, FT_Int32>, uint32_t> FontIds;
+
+	Implementation(size_t maxBytes)
+		: MaxBytes(maxBytes)
+		, Buckets(static_cast<size_t>(1) << BucketCountBits) {
+	}
+
+	~Implementation() {
+		for (auto& bucket : Buckets) {
+			for (auto node = bucket.load(std::memory_order_relaxed); node;) {
+				const auto next = node->Next;
+				delete node;
+				node = next;
+			}
+		}
+	}
+
+	static uint64_t MakeKey(uint32_t fontId, char32_t c) {
+		return static_cast<uint64_t>(fontId) << 32 | c;
+	}
+
+	std::atomic<Node*>& BucketOf(uint64_t key) {
+		return Buckets[static_cast<size_t>(key * 0x9E3779B97F4A7C15ULL >> (64 - BucketCountBits))];
+	}
+
+	static std::shared_ptr<const Glyph> FindInChain(const Node* node, uint64_t key) {
+		for (; node; node = node->Next) {
+			if (node->Key == key)
+				return node->Value;
+		}
+		return nullptr;
+	}
+};
+
+Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::GlyphBitmapCache(size_t maxBytes)
+	: m_pImpl(std::make_unique<Implementation>(maxBytes)) {
+}
+
+Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::~GlyphBitmapCache() = default;
+
+uint32_t Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::GetFontId(const std::filesystem::path& path, int faceIndex, float size, FT_Int32 loadFlags) {
+	const auto lock = std::lock_guard(m_pImpl->FontIdMtx);
+	return m_pImpl->FontIds.emplace(std::make_tuple(path.lexically_normal(), faceIndex, size, loadFlags), static_cast<uint32_t>(m_pImpl->FontIds.size())).first->second;
+}
+
+std::shared_ptr<const Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::Glyph> Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::Find(uint32_t fontId, char32_t c) const {
+	const auto key = Implementation::MakeKey(fontId, c);
+	return Implementation::FindInChain(m_pImpl->BucketOf(key).load(std::memory_order_acquire), key);
+}
+
+std::shared_ptr<const Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::Glyph> Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::Insert(uint32_t fontId, char32_t c, std::shared_ptr<const Glyph> glyph) {
+	const auto bytes = sizeof(Implementation::Node) + sizeof(Glyph) + glyph->Bitmap.size();
+	if (m_pImpl->Bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes > m_pImpl->MaxBytes) {
+		m_pImpl->Bytes.fetch_sub(bytes, std::memory_order_relaxed);
+		return glyph;
+	}
+
+	const auto key = Implementation::MakeKey(fontId, c);
+	auto& bucket = m_pImpl->BucketOf(key);
+	auto node = std::make_unique<Implementation::Node>(key, glyph, bucket.load(std::memory_order_acquire));
+	do {
+		if (auto existing = Implementation::FindInChain(node->Next, key)) {
+			m_pImpl->Bytes.fetch_sub(bytes, std::memory_order_relaxed);
+			return existing;
+		}
+	} while (!bucket.compare_exchange_weak(node->Next, node.get(), std::memory_order_release, std::memory_order_acquire));
+
+	node.release();
+	m_pImpl->Count.fetch_add(1, std::memory_order_relaxed);
+	return glyph;
+}
+
+size_t Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::GlyphCount() const {
+	return m_pImpl->Count.load(std::memory_order_relaxed);
+}
+
+size_t Sqex::FontCsv::FreeTypeFont::GlyphBitmapCache::ByteCount() const {
+	return m_pImpl->Bytes.load(std::memory_order_relaxed);
 }
 
 Sqex::FontCsv::FreeTypeFont::FtFaceCtxMgr::FtFaceCtxMgr(const FreeTypeFont* owner, Implementation* impl, FT_Face face)
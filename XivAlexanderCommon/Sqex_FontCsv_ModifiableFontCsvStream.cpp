@@ -1,8 +1,84 @@
 #include "pch.h"
 #include "Sqex_FontCsv_ModifiableFontCsvStream.h"
 
+#include <array>
+
 #include "Sqex_Sqpack.h"
 
+struct Sqex::FontCsv::ModifiableFontCsvStream::LookupTable {
+	static constexpr size_t PageSize = 0x100;
+	static constexpr uint64_t EmptyKerningKey = UINT64_MAX;  // 0xFF never appears in UTF-8.
+
+	// Two level table for BMP characters. Page 0 is kept empty, so that missing pages need no separate check.
+	// Values are indices into m_fontTableEntries plus one, or 0 if the character does not exist.
+	std::array<uint16_t, 0x10000 / PageSize> PageIndices{};
+	std::vector<uint32_t> Pages;
+
+	// Open addressing hash table keyed by UTF-8 values of left and right characters.
+	std::vector<uint64_t> KerningKeys;
+	std::vector<int> KerningOffsets;
+	int KerningShift = 64;
+
+	LookupTable(const std::vector<FontTableEntry>& fontTableEntries, const std::vector<KerningEntry>& kerningEntries)
+		: Pages(PageSize) {
+		for (size_t i = 0; i < fontTableEntries.size(); ++i) {
+			const auto c = fontTableEntries[i].Char();
+			if (c >= 0x10000 || UnicodeCodePointToUtf8Uint32(c) != fontTableEntries[i].Utf8Value)
+				continue;
+
+			auto& page = PageIndices[c / PageSize];
+			if (!page) {
+				page = static_cast<uint16_t>(Pages.size() / PageSize);
+				Pages.resize(Pages.size() + PageSize);
+			}
+
+			// Keep the first of duplicate entries, as binary search on sorted entries would find.
+			if (auto& slot = Pages[page * PageSize + c % PageSize]; !slot)
+				slot = static_cast<uint32_t>(i + 1);
+		}
+
+		size_t capacity = 16;
+		for (KerningShift = 60; capacity < kerningEntries.size() * 2; capacity *= 2)
+			--KerningShift;
+		KerningKeys.resize(capacity, EmptyKerningKey);
+		KerningOffsets.resize(capacity);
+		for (const auto& entry : kerningEntries) {
+			const auto key = KerningKey(entry.LeftUtf8Value, entry.RightUtf8Value);
+			for (auto i = KerningSlot(key); ; i = (i + 1) & (capacity - 1)) {
+				if (KerningKeys[i] == key)
+					break;
+				if (KerningKeys[i] == EmptyKerningKey) {
+					KerningKeys[i] = key;
+					KerningOffsets[i] = entry.RightOffset;
+					break;
+				}
+			}
+		}
+	}
+
+	static uint64_t KerningKey(uint32_t l, uint32_t r) {
+		return static_cast<uint64_t>(l) << 32 | r;
+	}
+
+	[[nodiscard]] size_t KerningSlot(uint64_t key) const {
+		return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> KerningShift);
+	}
+
+	[[nodiscard]] uint32_t FindCharacter(char32_t c) const {
+		return Pages[PageIndices[c / PageSize] * PageSize + c % PageSize];
+	}
+
+	[[nodiscard]] int FindKerning(uint32_t l, uint32_t r) const {
+		const auto key = KerningKey(l, r);
+		for (auto i = KerningSlot(key); ; i = (i + 1) & (KerningKeys.size() - 1)) {
+			if (KerningKeys[i] == key)
+				return KerningOffsets[i];
+			if (KerningKeys[i] == EmptyKerningKey)
+				return 0;
+		}
+	}
+};
+
 Sqex::FontCsv::ModifiableFontCsvStream::ModifiableFontCsvStream() {
 	memcpy(m_fcsv.Signature, FontCsvHeader::Signature_Value, sizeof m_fcsv.Signature);
 	memcpy(m_fthd.Signature, FontTableHeader::Signature_Value, sizeof m_fthd.Signature);
@@ -48,6 +124,8 @@ Sqex::FontCsv::ModifiableFontCsvStream::ModifiableFontCsvStream(const RandomAcce
 	});
 }
 
+Sqex::FontCsv::ModifiableFontCsvStream::~ModifiableFontCsvStream() = default;
+
 uint64_t Sqex::FontCsv::ModifiableFontCsvStream::StreamSize() const {
 	return sizeof m_fcsv
 		+ sizeof m_fthd
@@ -131,7 +209,23 @@ uint64_t Sqex::FontCsv::ModifiableFontCsvStream::ReadStreamPartial(uint64_t offs
 	return length - out.size_bytes();
 }
 
+const Sqex::FontCsv::ModifiableFontCsvStream::LookupTable& Sqex::FontCsv::ModifiableFontCsvStream::GetLookupTable() const {
+	if (!m_lookupValid) {
+		const auto lock = std::lock_guard(m_lookupMtx);
+		if (!m_lookupValid) {
+			m_lookup = std::make_unique<LookupTable>(m_fontTableEntries, m_kerningEntries);
+			m_lookupValid = true;
+		}
+	}
+	return *m_lookup;
+}
+
 const Sqex::FontCsv::FontTableEntry* Sqex::FontCsv::ModifiableFontCsvStream::GetFontEntry(char32_t c) const {
+	if (c < 0x10000) {
+		const auto index = GetLookupTable().FindCharacter(c);
+		return index ? &m_fontTableEntries[index - 1] : nullptr;
+	}
+
 	const auto val = UnicodeCodePointToUtf8Uint32(c);
 	const auto it = std::lower_bound(m_fontTableEntries.begin(), m_fontTableEntries.end(), val,
 		[](const FontTableEntry& l, uint32_t r) {
@@ -143,16 +237,7 @@ const Sqex::FontCsv::FontTableEntry* Sqex::FontCsv::ModifiableFontCsvStream::Get
 }
 
 int Sqex::FontCsv::ModifiableFontCsvStream::GetKerningDistance(char32_t l, char32_t r) const {
-	const auto pair = std::make_pair(UnicodeCodePointToUtf8Uint32(l), UnicodeCodePointToUtf8Uint32(r));
-	const auto it = std::lower_bound(m_kerningEntries.begin(), m_kerningEntries.end(), pair,
-		[](const KerningEntry& l, const std::pair<uint32_t, uint32_t>& r) {
-			if (l.LeftUtf8Value == r.first)
-				return l.RightUtf8Value < r.second;
-			return l.LeftUtf8Value < r.first;
-		});
-	if (it == m_kerningEntries.end() || it->LeftUtf8Value != pair.first || it->RightUtf8Value != pair.second)
-		return 0;
-	return it->RightOffset;
+	return GetLookupTable().FindKerning(UnicodeCodePointToUtf8Uint32(l), UnicodeCodePointToUtf8Uint32(r));
 }
 
 void Sqex::FontCsv::ModifiableFontCsvStream::ReserveStorage(size_t fontEntryCount, size_t kerningEntryCount) {
@@ -166,6 +251,7 @@ void Sqex::FontCsv::ModifiableFontCsvStream::AddFontEntry(char32_t c, uint16_t t
 		[](const FontTableEntry& l, uint32_t r) {
 			return l.Utf8Value < r;
 		});
+	m_lookupValid = false;
 	if (it == m_fontTableEntries.end() || it->Utf8Value != val) {
 		auto entry = FontTableEntry();
 		entry.Utf8Value = val;
@@ -187,6 +273,7 @@ void Sqex::FontCsv::ModifiableFontCsvStream::AddKerning(char32_t l, char32_t r,
 	entry.Left(l);
 	entry.Right(r);
 	entry.RightOffset = rightOffset;
+	m_lookupValid = false;
 
 	const auto it = std::ranges::lower_bound(m_kerningEntries, entry,
 		[](const KerningEntry& l, const KerningEntry& r) {
@@ -0,0 +1,126 @@
+#include "pch.h"
+#include "Sqex_Network_Capture.h"
+
+#include <cmath>
+#include <thread>
+
+#include "Sqex_Network_SingleStream.h"
+
+Sqex::Network::Capture::Writer::Writer(const std::filesystem::path& path)
+	: m_file(Utils::Win32::Handle::FromCreateFile(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, 0))
+	, m_start(std::chrono::steady_clock::now()) {
+	FileHeader header{};
+	std::copy_n(FileHeader::SignatureValue, sizeof header.Signature, header.Signature);
+	header.StartEpochMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	const auto ptr = reinterpret_cast<const uint8_t*>(&header);
+	m_buffer.insert(m_buffer.end(), ptr, ptr + sizeof header);
+	Flush();
+}
+
+Sqex::Network::Capture::Writer::~Writer() {
+	try {
+		Flush();
+	} catch (...) {
+		// pass
+	}
+}
+
+void Sqex::Network::Capture::Writer::Write(Direction direction, std::span<const uint8_t> data) {
+	const RecordHeader header{
+		.TimestampMicroseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count()),
+		.Length = static_cast<uint32_t>(data.size()),
+		.Direction = direction,
+	};
+
+	const auto ptr = reinterpret_cast<const uint8_t*>(&header);
+	m_buffer.insert(m_buffer.end(), ptr, ptr + sizeof header);
+	m_buffer.insert(m_buffer.end(), data.begin(), data.end());
+	if (m_buffer.size() >= FlushThreshold)
+		Flush();
+}
+
+void Sqex::Network::Capture::Writer::Flush() {
+	if (m_buffer.empty())
+		return;
+
+	m_file.Write(m_fileOffset, m_buffer.data(), m_buffer.size());
+	m_fileOffset += m_buffer.size();
+	m_buffer.clear();
+}
+
+Sqex::Network::Capture::Reader::Reader(const std::filesystem::path& path) {
+	const auto file = Utils::Win32::Handle::FromCreateFile(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0);
+	m_data = file.Read<uint8_t>(0, static_cast<size_t>(file.GetFileSize()));
+	if (m_data.size() < sizeof(FileHeader) || memcmp(m_data.data(), FileHeader::SignatureValue, sizeof FileHeader::SignatureValue) != 0)
+		throw std::runtime_error("Not a capture file");
+
+	for (size_t i = sizeof(FileHeader); m_data.size() - i >= sizeof(RecordHeader);) {
+		RecordHeader header;
+		memcpy(&header, &m_data[i], sizeof header);
+		i += sizeof header;
+
+		// A capture cut short while being written ends with an incomplete record.
+		if (m_data.size() - i < header.Length)
+			break;
+
+		m_records.emplace_back(Record{header.TimestampMicroseconds, header.Direction, std::span(m_data).subspan(i, header.Length)});
+		i += header.Length;
+	}
+}
+
+int64_t Sqex::Network::Capture::Reader::StartEpochMilliseconds() const {
+	return reinterpret_cast<const FileHeader*>(m_data.data())->StartEpochMilliseconds;
+}
+
+uint64_t Sqex::Network::Capture::ReplayStatistics::Percentile(double p) const {
+	if (MessageLatencyNanoseconds.empty())
+		return 0;
+
+	// Nearest-rank method.
+	const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(MessageLatencyNanoseconds.size())));
+	return MessageLatencyNanoseconds[std::clamp<size_t>(rank, 1, MessageLatencyNanoseconds.size()) - 1];
+}
+
+Sqex::Network::Capture::ReplayResult Sqex::Network::Capture::Replay(const Reader& reader, bool originalTiming, const MessageHandler& incomingHandler, const MessageHandler& outgoingHandler) {
+	ReplayResult result;
+	SingleStream recvRaw, recvProcessed, sendRaw, sendProcessed;
+	std::vector<uint8_t> drained(65536);
+
+	auto fedAt = std::chrono::steady_clock::now();
+	auto stats = &result.Recv;
+	auto handler = &incomingHandler;
+	const MessageHandler measuredHandler = [&](Structures::FFXIVMessage* pMessage) {
+		const auto use = (*handler)(pMessage);
+		stats->MessageLatencyNanoseconds.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - fedAt).count()));
+		return use;
+	};
+
+	const auto& records = reader.Records();
+	const auto start = std::chrono::steady_clock::now();
+	for (const auto& record : records) {
+		if (originalTiming)
+			std::this_thread::sleep_until(start + std::chrono::microseconds(record.TimestampMicroseconds - records.front().TimestampMicroseconds));
+
+		const auto recv = record.Direction == Direction::Recv;
+		auto& raw = recv ? recvRaw : sendRaw;
+		auto& processed = recv ? recvProcessed : sendProcessed;
+		stats = recv ? &result.Recv : &result.Send;
+		handler = recv ? &incomingHandler : &outgoingHandler;
+		stats->RecordCount += 1;
+		stats->ByteCount += record.Data.size();
+
+		fedAt = std::chrono::steady_clock::now();
+		raw.Write(record.Data);
+		raw.TunnelXivStream(processed, measuredHandler);
+
+		// Drain as the game would with recv, or as AttemptSend would with send.
+		while (processed.Available())
+			processed.Read(drained.data(), drained.size());
+	}
+	result.Elapsed = std::chrono::steady_clock::now() - start;
+
+	std::ranges::sort(result.Recv.MessageLatencyNanoseconds);
+	std::ranges::sort(result.Send.MessageLatencyNanoseconds);
+	return result;
+}
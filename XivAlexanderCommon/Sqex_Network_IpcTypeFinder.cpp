@@ -0,0 +1,129 @@
+#include "pch.h"
+#include "Sqex_Network_IpcTypeFinder.h"
+
+#include "Sqex_Network_Structures.h"
+
+void Sqex::Network::IpcTypeFinder::FindIncoming(const Structures::FFXIVMessage& message, const CandidateCallback& onCandidate) {
+	using namespace Structures;
+
+	if (message.Type != SegmentType::IPC || message.Data.IPC.Type != IpcType::InterestedType)
+		return;
+
+	if (message.CurrentActor == message.SourceActor) {
+		if (message.Length == 0x9c ||
+			message.Length == 0x29c ||
+			message.Length == 0x4dc ||
+			message.Length == 0x71c ||
+			message.Length == 0x95c) {
+			// Test ActionEffect
+
+			int expectedCount = 0;
+			if (message.Length == 0x9c)
+				expectedCount = 1;
+			else if (message.Length == 0x29c)
+				expectedCount = 8;
+			else if (message.Length == 0x4dc)
+				expectedCount = 16;
+			else if (message.Length == 0x71c)
+				expectedCount = 24;
+			else if (message.Length == 0x95c)
+				expectedCount = 32;
+
+			const auto& actionEffect = message.Data.IPC.Data.S2C_ActionEffect;
+			onCandidate(std::format(
+				"S2C_ActionEffect{:02}(0x{:04x}) length={:x} actionId={:04x} sequence={:04x} wait={:.3f}",
+				expectedCount,
+				message.Data.IPC.SubType,
+				message.Length,
+				actionEffect.ActionId,
+				actionEffect.SourceSequence,
+				actionEffect.AnimationLockDuration), true);
+
+		} else if (message.Length == 0x40) {
+			// Two possibilities: ActorControlSelf and ActorCast
+
+			//
+			// Test ActorControlSelf
+			// 
+			const auto& actorControlSelf = message.Data.IPC.Data.S2C_ActorControlSelf;
+			if (actorControlSelf.Category == S2C_ActorControlSelfCategory::Cooldown) {
+				const auto& cooldown = actorControlSelf.Cooldown;
+				onCandidate(std::format(
+					"S2C_ActorControlSelf(0x{:04x}): Cooldown: actionId={:04x} duration={}",
+					message.Data.IPC.SubType,
+					cooldown.ActionId,
+					cooldown.Duration), true);
+
+			} else if (actorControlSelf.Category == S2C_ActorControlSelfCategory::ActionRejected) {
+				const auto& rollback = actorControlSelf.Rollback;
+				onCandidate(std::format(
+					"S2C_ActorControlSelf(0x{:04x}): Rollback: actionId={:04x} sourceSequence={:04x}",
+					message.Data.IPC.SubType,
+					rollback.ActionId,
+					rollback.SourceSequence), true);
+			}
+
+			//
+			// Test ActorCast
+			//
+			onCandidate(std::format(
+				"S2C_ActorCast(0x{:04x}): actionId={:04x} time={:.3f} target={:08x}",
+				message.Data.IPC.SubType,
+				message.Data.IPC.Data.S2C_ActorCast.ActionId,
+				message.Data.IPC.Data.S2C_ActorCast.CastTime,
+				message.Data.IPC.Data.S2C_ActorCast.TargetId), true);
+
+		} else if (message.Length == 0x38) {
+			// Test ActorControl
+			const auto& actorControl = message.Data.IPC.Data.S2C_ActorControl;
+			if (actorControl.Category == S2C_ActorControlCategory::CancelCast) {
+				const auto& cancelCast = actorControl.CancelCast;
+				onCandidate(std::format(
+					"S2C_ActorControl(0x{:04x}): CancelCast: actionId={:04x}",
+					message.Data.IPC.SubType,
+					cancelCast.ActionId), true);
+			}
+		}
+	}
+	if (message.Length == 0x78) {
+		// Test AddStatusEffect
+		const auto& addStatusEffect = message.Data.IPC.Data.S2C_AddStatusEffect;
+		std::string effects;
+		for (size_t i = 0, i_ = std::min<size_t>(addStatusEffect.EffectCount, std::size(addStatusEffect.Effects)); i < i_; ++i) {
+			const auto& entry = addStatusEffect.Effects[i];
+			effects += std::format(
+				"\n\teffectId={:04x} duration={:g} sourceActorId={:08x}",
+				entry.EffectId,
+				entry.Duration,
+				entry.SourceActorId
+			);
+		}
+		onCandidate(std::format(
+			"S2C_AddStatusEffect(0x{:04x}): relatedActionSequence={:08x} actorId={:08x} HP={}/{} MP={} shield={}{}",
+			message.Data.IPC.SubType,
+			addStatusEffect.RelatedActionSequence,
+			addStatusEffect.ActorId,
+			addStatusEffect.CurrentHp,
+			addStatusEffect.MaxHp,
+			addStatusEffect.CurentMp,
+			addStatusEffect.DamageShield,
+			effects
+		), false);
+	}
+}
+
+void Sqex::Network::IpcTypeFinder::FindOutgoing(const Structures::FFXIVMessage& message, const CandidateCallback& onCandidate) {
+	using namespace Structures;
+
+	if (message.Type != SegmentType::IPC || message.Data.IPC.Type != IpcType::InterestedType)
+		return;
+
+	if (message.Length == 0x40) {
+		// Test ActionRequest
+		const auto& actionRequest = message.Data.IPC.Data.C2S_ActionRequest;
+		onCandidate(std::format(
+			"C2S_ActionRequest/GroundTargeted(0x{:04x}): actionId={:04x} sequence={:04x}",
+			message.Data.IPC.SubType,
+			actionRequest.ActionId, actionRequest.Sequence), true);
+	}
+}
@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "Sqex_Network_SingleStream.h"
+
+#include <optional>
+
+#include "Sqex_Network_Structures.h"
+
+Sqex::Network::SingleStream::SingleStream(size_t capacity) {
+	size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+	m_buffer.resize(size);
+}
+
+void Sqex::Network::SingleStream::Grow(size_t minCapacity) {
+	size_t size = m_buffer.size();
+	while (size < minCapacity)
+		size <<= 1;
+	if (size == m_buffer.size())
+		return;
+
+	std::vector<uint8_t> buffer(size);
+	const auto available = Available();
+	Read(buffer.data(), available);
+	m_buffer = std::move(buffer);
+	m_readPos = 0;
+	m_writePos = available;
+}
+
+void Sqex::Network::SingleStream::Write(const void* buf, size_t length) {
+	if (Free() < length)
+		Grow(Available() + length);
+
+	const auto pos = m_writePos & Mask();
+	const auto first = std::min(length, m_buffer.size() - pos);
+	memcpy(&m_buffer[pos], buf, first);
+	memcpy(&m_buffer[0], static_cast<const uint8_t*>(buf) + first, length - first);
+	m_writePos += length;
+}
+
+std::span<uint8_t> Sqex::Network::SingleStream::PeekAll() {
+	const auto available = Available();
+	if (!available)
+		return {};
+
+	auto pos = m_readPos & Mask();
+	if (pos + available > m_buffer.size()) {
+		// Happens only when a bundle sits across the end of the buffer; rotating in place keeps this free of allocations.
+		std::ranges::rotate(m_buffer, m_buffer.begin() + static_cast<ptrdiff_t>(pos));
+		m_readPos = pos = 0;
+		m_writePos = available;
+	}
+	return {&m_buffer[pos], available};
+}
+
+void Sqex::Network::SingleStream::TunnelXivStream(SingleStream& target,
+	const std::function<bool(Structures::FFXIVMessage*)>& messageMangler,
+	const std::function<void(const Structures::FFXIVBundle&, const std::exception&)>& onError) {
+	using namespace Structures;
+	while (true) {
+		auto buf = PeekAll();
+		if (buf.empty())
+			break;
+
+		if (const auto trash = FFXIVBundle::ExtractFrontTrash(buf); !trash.empty()) {
+			target.Write(trash);
+			Consume(trash.size_bytes());
+			buf = buf.subspan(trash.size_bytes());
+		}
+
+		// Incomplete header
+		if (buf.size_bytes() < GamePacketHeaderSize)
+			break;
+
+		auto* pGamePacket = reinterpret_cast<FFXIVBundle*>(buf.data());
+
+		// Invalid TotalLength
+		if (pGamePacket->TotalLength == 0) {
+			target.Write(buf.subspan(0, 1));
+			Consume(1);
+			continue;
+		}
+
+		// Incomplete data
+		if (buf.size_bytes() < pGamePacket->TotalLength)
+			break;
+
+		std::optional<FFXIVMessageRange> messages;
+		try {
+			messages.emplace(pGamePacket->GetMessages(m_inflater));
+		} catch (const std::exception& e) {
+			if (onError)
+				onError(*pGamePacket, e);
+			target.Write(pGamePacket, pGamePacket->TotalLength);
+			Consume(pGamePacket->TotalLength);
+			continue;
+		}
+
+		FFXIVBundle header;
+		memcpy(&header, pGamePacket, GamePacketHeaderSize);
+		header.TotalLength = static_cast<uint32_t>(GamePacketHeaderSize);
+		header.MessageCount = 0;
+		header.GzipCompressed = 0;
+
+		m_keptMessages.clear();
+		for (auto it = messages->begin(); it != messages->end(); ++it) {
+			// Messages are modified in place, so keep what it was before, in case messageMangler throws halfway through.
+			const auto span = it.Span();
+			m_messageBackup.assign(span.begin(), span.end());
+
+			bool keep;
+			try {
+				keep = messageMangler(&*it);
+			} catch (const std::exception& e) {
+				if (onError)
+					onError(*pGamePacket, e);
+				std::ranges::copy(m_messageBackup, span.begin());
+				keep = true;
+			}
+			if (!keep || !it->Length)
+				continue;
+
+			m_keptMessages.emplace_back(span);
+			header.TotalLength += static_cast<uint32_t>(span.size());
+			header.MessageCount += 1;
+		}
+
+		target.Write(&header, GamePacketHeaderSize);
+		for (const auto& message : m_keptMessages)
+			target.Write(message);
+
+		Consume(pGamePacket->TotalLength);
+	}
+}
@@ -1,25 +1,23 @@
 #include "pch.h"
-#include "App_Network_Structures.h"
+#include "Sqex_Network_Structures.h"
 
-#include <XivAlexanderCommon/XaMisc.h>
-#include <XivAlexanderCommon/XaZlib.h>
+#include "XaMisc.h"
+#include "XaZlib.h"
 
-#include "App_Misc_Logger.h"
-
-const uint8_t App::Network::Structures::FFXIVBundle::MagicConstant1[]{
+const uint8_t Sqex::Network::Structures::FFXIVBundle::MagicConstant1[]{
 	0x52, 0x52, 0xa0, 0x41,
 	0xff, 0x5d, 0x46, 0xe2,
 	0x7f, 0x2a, 0x64, 0x4d,
 	0x7b, 0x99, 0xc4, 0x75,
 };
-const uint8_t App::Network::Structures::FFXIVBundle::MagicConstant2[]{
+const uint8_t Sqex::Network::Structures::FFXIVBundle::MagicConstant2[]{
 	0, 0, 0, 0,
 	0, 0, 0, 0,
 	0, 0, 0, 0,
 	0, 0, 0, 0,
 };
 
-std::span<const uint8_t> App::Network::Structures::FFXIVBundle::ExtractFrontTrash(const std::span<const uint8_t>& buf) {
+std::span<const uint8_t> Sqex::Network::Structures::FFXIVBundle::ExtractFrontTrash(const std::span<const uint8_t>& buf) {
 	const auto searchLength = std::min(sizeof Magic, buf.size());
 	return {
 		buf.begin(),
@@ -30,10 +28,9 @@ std::span<const uint8_t> App::Network::Structures::FFXIVBundle::ExtractFrontTras
 	};
 }
 
-void App::Network::Structures::FFXIVBundle::DebugPrint(LogCategory logCategory, const char* head) const {
+std::string Sqex::Network::Structures::FFXIVBundle::Describe(const char* head) const {
 	const auto st = Utils::EpochToLocalSystemTime(Timestamp);
-	Misc::Logger::Acquire()->Format<LogLevel::Debug>(
-		logCategory,
+	return std::format(
 		"[{} / {:04}-{:02}-{:02} {:02}:{:02}:{:02}.{:03}] Length={} ConnType={} Count={} Gzip={}",
 		head,
 		st.wYear, st.wMonth, st.wDay,
@@ -43,31 +40,19 @@ void App::Network::Structures::FFXIVBundle::DebugPrint(LogCategory logCategory,
 	);
 }
 
-std::vector<std::vector<uint8_t>> App::Network::Structures::FFXIVBundle::SplitMessages(uint16_t expectedMessageCount, const std::span<const uint8_t>& buf) {
-	std::vector<std::vector<uint8_t>> result;
-	result.reserve(expectedMessageCount);
-	for (size_t i = 0; i < buf.size();) {
-		const auto& message = *reinterpret_cast<const FFXIVMessage*>(&buf[i]);
-		if (i + message.Length > buf.size() || !message.Length)
-			throw std::runtime_error("Could not parse game message (sum(message.length for each message) > total message length)");
-
-		const auto sub = buf.subspan(i, static_cast<size_t>(message.Length));
-		result.emplace_back(sub.begin(), sub.end());
-		i += message.Length;
-	}
-	return result;
-}
+Sqex::Network::Structures::FFXIVMessageRange Sqex::Network::Structures::FFXIVBundle::GetMessages(Utils::ZlibReusableInflater& inflater) {
+	if (TotalLength < GamePacketHeaderSize)
+		throw std::runtime_error("Could not parse game message (total length < header length)");
 
-std::vector<std::vector<uint8_t>> App::Network::Structures::FFXIVBundle::GetMessages(Utils::ZlibReusableInflater& inflater) const {
-	const std::span view(reinterpret_cast<const uint8_t*>(this) + GamePacketHeaderSize, TotalLength - GamePacketHeaderSize);
+	const std::span view(reinterpret_cast<uint8_t*>(this) + GamePacketHeaderSize, TotalLength - GamePacketHeaderSize);
 
 	if (GzipCompressed)
-		return SplitMessages(MessageCount, inflater(view));
+		return FFXIVMessageRange(inflater(view));
 	else
-		return SplitMessages(MessageCount, view);
+		return FFXIVMessageRange(view);
 }
 
-void App::Network::Structures::FFXIVMessage::DebugPrint(LogCategory logCategory, const char* head, bool dump) const {
+std::string Sqex::Network::Structures::FFXIVMessage::Describe(const char* head, bool dump) const {
 	std::string dumpstr;
 	if (Type == SegmentType::ClientKeepAlive || Type == SegmentType::ServerKeepAlive) {
 		const auto st = Utils::EpochToLocalSystemTime(Data.KeepAlive.Epoch * 1000LL);
@@ -97,9 +82,19 @@ void App::Network::Structures::FFXIVMessage::DebugPrint(LogCategory logCategory,
 			}
 		}
 	}
-	Misc::Logger::Acquire()->Format<LogLevel::Debug>(
-		logCategory,
+	return std::format(
 		"[{}] Length={} Source={:08x} Current={:08x} Type={}{}",
 		head, Length, SourceActor, CurrentActor, static_cast<int>(Type), dumpstr
 	);
 }
+
+Sqex::Network::Structures::FFXIVMessageRange::FFXIVMessageRange(std::span<uint8_t> data)
+	: m_data(data) {
+	for (size_t i = 0; i < data.size();) {
+		const auto& message = *reinterpret_cast<const FFXIVMessage*>(&data[i]);
+		if (data.size() - i < sizeof message.Length || message.Length > data.size() - i || !message.Length)
+			throw std::runtime_error("Could not parse game message (sum(message.length for each message) > total message length)");
+
+		i += message.Length;
+	}
+}
@@ -1,6 +1,11 @@
 #include "pch.h"
 #include "Sqex_Sqpack.h"
 
+#include <array>
+#include <immintrin.h>
+
+#include "Utils_Win32_ThreadPool.h"
+
 const char Sqex::Sqpack::SqpackHeader::Signature_Value[12] = {
 	'S', 'q', 'P', 'a', 'c', 'k', 0, 0, 0, 0, 0, 0,
 };
@@ -251,33 +256,109 @@ void Sqex::Sqpack::SqData::Header::Verify(uint32_t expectedSpanIndex) const {
 		throw CorruptDataException("Padding_0x3D4 != 0");
 }
 
-uint32_t Sqex::Sqpack::SqexHash(const char* data, size_t len) {
-	std::string normalizedText;
-	if (len == SIZE_MAX) {
-		normalizedText = data;
-		len = normalizedText.size();
-	} else
-		normalizedText = {data, len};
-	for (auto& c : normalizedText) {
+namespace {
+	// SqexHashTable extended to 16 slices; slice k holds the table for a byte followed by k zero bytes.
+	constexpr auto SqexHashTable16 = []() {
+		std::array<std::array<uint32_t, 256>, 16> table{};
+		for (uint32_t i = 0; i < 256; ++i) {
+			auto crc = i;
+			for (auto j = 0; j < 8; ++j)
+				crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+			table[0][i] = crc;
+		}
+		for (size_t k = 1; k < table.size(); ++k)
+			for (size_t i = 0; i < 256; ++i)
+				table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+		return table;
+	}();
+
+	char NormalizeSqexHashChar(char c) {
 		if ('A' <= c && c <= 'Z')
-			c -= 'A' - 'a';
-		else if (c == '\\')
-			c = '/';
+			return static_cast<char>(c - ('A' - 'a'));
+		if (c == '\\')
+			return '/';
+		return c;
+	}
+
+	// Continues crc over data, lowercasing A-Z and turning backslashes into forward slashes on the way.
+	uint32_t SqexHashContinue(uint32_t crc, const char* data, size_t len) {
+		const auto& t = SqexHashTable16;
+		const auto upperFrom = _mm_set1_epi8('A' - 1);
+		const auto upperTo = _mm_set1_epi8('Z' + 1);
+		const auto caseBit = _mm_set1_epi8('a' - 'A');
+		const auto backslash = _mm_set1_epi8('\\');
+		const auto slashFlip = _mm_set1_epi8('\\' ^ '/');
+
+		size_t i = 0;
+		for (; i + 16 <= len; i += 16) {
+			auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[i]));
+			// Signed comparison leaves bytes at or above 0x80 alone.
+			const auto upper = _mm_and_si128(_mm_cmpgt_epi8(v, upperFrom), _mm_cmplt_epi8(v, upperTo));
+			v = _mm_or_si128(v, _mm_and_si128(upper, caseBit));
+			v = _mm_xor_si128(v, _mm_and_si128(_mm_cmpeq_epi8(v, backslash), slashFlip));
+
+			const auto w0 = static_cast<uint32_t>(_mm_cvtsi128_si32(v)) ^ crc;
+			const auto w1 = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(v, 4)));
+			const auto w2 = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(v, 8)));
+			const auto w3 = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(v, 12)));
+			crc = t[15][w0 & 0xFF] ^ t[14][(w0 >> 8) & 0xFF] ^ t[13][(w0 >> 16) & 0xFF] ^ t[12][w0 >> 24]
+				^ t[11][w1 & 0xFF] ^ t[10][(w1 >> 8) & 0xFF] ^ t[9][(w1 >> 16) & 0xFF] ^ t[8][w1 >> 24]
+				^ t[7][w2 & 0xFF] ^ t[6][(w2 >> 8) & 0xFF] ^ t[5][(w2 >> 16) & 0xFF] ^ t[4][w2 >> 24]
+				^ t[3][w3 & 0xFF] ^ t[2][(w3 >> 8) & 0xFF] ^ t[1][(w3 >> 16) & 0xFF] ^ t[0][w3 >> 24];
+		}
+
+		for (; i < len; ++i)
+			crc = t[0][(crc ^ static_cast<uint8_t>(NormalizeSqexHashChar(data[i]))) & 0xFF] ^ (crc >> 8);
+
+		return crc;
 	}
-	size_t i = 0;
-	uint32_t result = 0xFFFFFFFFUL;
-	for (; i < (len & ~3); i += 4) {
-		result ^= *reinterpret_cast<const uint32_t*>(&normalizedText[i]);
-		result = SqexHashTable[3][result & 0xFF] ^
-			SqexHashTable[2][(result >> 8) & 0xFF] ^
-			SqexHashTable[1][(result >> 16) & 0xFF] ^
-			SqexHashTable[0][(result >> 24) & 0xFF];
+
+	// Whether lexically_normal would keep every component of path as it is, and no component is a root,
+	// so that hashing the path as given is the same as hashing the normalized path.
+	bool IsSimpleRelativePath(std::string_view path) {
+		if (path.empty() || path.front() == '/' || path.front() == '\\')
+			return false;
+
+		size_t componentStart = 0;
+		for (size_t i = 0; i <= path.size(); ++i) {
+			if (i < path.size()) {
+				const auto c = path[i];
+				if (c & 0x80 || c == ':')
+					return false;
+				if (c != '/' && c != '\\')
+					continue;
+			}
+
+			const auto component = path.substr(componentStart, i - componentStart);
+			if (component == "." || component == "..")
+				return false;
+			if (component.empty() && i != path.size())
+				return false;
+			componentStart = i + 1;
+		}
+		return true;
 	}
 
-	for (; i < len; ++i)
-		result = SqexHashTable[0][(result ^ normalizedText[i]) & 0xFF] ^ (result >> 8);
+	Sqex::Sqpack::SqexPathHashes HashSimpleRelativePath(std::string_view path) {
+		const auto separator = path.find_last_of("/\\");
+		if (separator == std::string_view::npos) {
+			const auto hash = SqexHashContinue(0xFFFFFFFF, path.data(), path.size());
+			return {Sqex::Sqpack::EntryPathSpec::EmptyHashValue, hash, hash};
+		}
+
+		const auto pathHash = SqexHashContinue(0xFFFFFFFF, path.data(), separator);
+		return {
+			.PathHash = pathHash,
+			.NameHash = SqexHashContinue(0xFFFFFFFF, path.data() + separator + 1, path.size() - separator - 1),
+			.FullPathHash = SqexHashContinue(pathHash, path.data() + separator, path.size() - separator),
+		};
+	}
+}
 
-	return result;
+uint32_t Sqex::Sqpack::SqexHash(const char* data, size_t len) {
+	if (len == SIZE_MAX)
+		len = strlen(data);
+	return SqexHashContinue(0xFFFFFFFF, data, len);
 }
 
 uint32_t Sqex::Sqpack::SqexHash(const std::string& text) {
@@ -291,3 +372,35 @@ uint32_t Sqex::Sqpack::SqexHash(const std::string_view& text) {
 uint32_t Sqex::Sqpack::SqexHash(const std::filesystem::path& path) {
 	return SqexHash(ToUtf8(path.lexically_normal().wstring()));
 }
+
+Sqex::Sqpack::SqexPathHashes Sqex::Sqpack::SqexHashPath(std::string_view path) {
+	if (IsSimpleRelativePath(path))
+		return HashSimpleRelativePath(path);
+
+	const auto normalized = std::filesystem::path(FromUtf8(path)).lexically_normal();
+	return {SqexHash(normalized.parent_path()), SqexHash(normalized.filename()), SqexHash(normalized)};
+}
+
+Sqex::Sqpack::SqexPathHashes Sqex::Sqpack::SqexHashPath(const std::filesystem::path& path) {
+	if (const auto utf8 = ToUtf8(path.wstring()); IsSimpleRelativePath(utf8))
+		return HashSimpleRelativePath(utf8);
+
+	return {SqexHash(path.parent_path()), SqexHash(path.filename()), SqexHash(path)};
+}
+
+void Sqex::Sqpack::SqexHashPaths(std::span<const std::string_view> paths, std::span<SqexPathHashes> result) {
+	if (paths.size() != result.size())
+		throw std::invalid_argument("paths.size() != result.size()");
+
+	constexpr size_t ChunkSize = 1024;
+	if (paths.size() <= ChunkSize) {
+		for (size_t i = 0; i < paths.size(); ++i)
+			result[i] = SqexHashPath(paths[i]);
+		return;
+	}
+
+	Win32::ParallelFor((paths.size() + ChunkSize - 1) / ChunkSize, [&](size_t chunk) {
+		for (size_t i = chunk * ChunkSize, to = std::min(paths.size(), i + ChunkSize); i < to; ++i)
+			result[i] = SqexHashPath(paths[i]);
+	});
+}
@@ -6,6 +6,7 @@
 #include "Sqex_Sqpack_EntryRawStream.h"
 #include "Sqex_Sqpack_Reader.h"
 #include "Sqex_ThirdParty_TexTools.h"
+#include "Utils_Win32_ThreadPool.h"
 
 struct Sqex::Sqpack::Creator::Implementation {
 	void AddEntry(AddEntryResult& result, std::shared_ptr<EntryProvider> provider, bool overwriteExisting = true);
@@ -13,8 +14,7 @@ struct Sqex::Sqpack::Creator::Implementation {
 
 	Creator* const this_;
 
-	std::map<EntryPathSpec, std::unique_ptr<Entry>, EntryPathSpec::AllHashComparator> m_hashOnlyEntries;
-	std::map<EntryPathSpec, std::unique_ptr<Entry>, EntryPathSpec::FullPathComparator> m_fullEntries;
+	EntryTable<std::unique_ptr<Entry>> m_entries;
 
 	std::vector<SqIndex::Segment3Entry> m_sqpackIndexSegment3;
 	std::vector<SqIndex::Segment3Entry> m_sqpackIndex2Segment3;
@@ -91,15 +91,12 @@ void Sqex::Sqpack::Creator::Implementation::AddEntry(AddEntryResult& result, std
 	try {
 		Entry* pEntry = nullptr;
 
-		if (const auto it = m_hashOnlyEntries.find(provider->PathSpec()); it != m_hashOnlyEntries.end()) {
-			pEntry = it->second.get();
+		if (const auto index = m_entries.FindIndex(provider->PathSpec()); index != EntryKeyTable::NotFound) {
+			pEntry = m_entries[index].get();
 			if (!pEntry->Provider->PathSpec().HasOriginal() && provider->PathSpec().HasOriginal()) {
 				pEntry->Provider->UpdatePathSpec(provider->PathSpec());
-				m_fullEntries.emplace(pProvider->PathSpec(), std::move(it->second));
-				m_hashOnlyEntries.erase(it);
+				m_entries.SetPath(index, provider->PathSpec());
 			}
-		} else if (const auto it = m_fullEntries.find(provider->PathSpec()); it != m_fullEntries.end()) {
-			pEntry = it->second.get();
 		}
 
 		if (pEntry) {
@@ -113,11 +110,7 @@ void Sqex::Sqpack::Creator::Implementation::AddEntry(AddEntryResult& result, std
 			return;
 		}
 
-		auto entry = std::make_unique<Entry>(0, 0, 0, SqIndex::LEDataLocator{ 0, 0 }, 0, 0, std::move(provider));
-		if (pProvider->PathSpec().HasOriginal())
-			m_fullEntries.emplace(pProvider->PathSpec(), std::move(entry));
-		else
-			m_hashOnlyEntries.emplace(pProvider->PathSpec(), std::move(entry));
+		m_entries.Emplace(pProvider->PathSpec(), std::make_unique<Entry>(0, 0, 0, SqIndex::LEDataLocator{ 0, 0 }, 0, 0, std::move(provider)));
 		result.Added.emplace_back(pProvider);
 	} catch (const std::exception& e) {
 		result.Error.emplace_back(pProvider->PathSpec(), e.what());
@@ -139,11 +132,13 @@ Sqex::Sqpack::Creator::AddEntryResult Sqex::Sqpack::Creator::AddEntriesFromSqPac
 	}
 
 	AddEntryResult result;
-	for (const auto& [locator, entryInfo] : reader.EntryInfo) {
+	m_pImpl->m_entries.Reserve(m_pImpl->m_entries.size() + reader.GetEntryInfo().size());
+	for (const auto& [locator, entryInfo] : reader.GetEntryInfo()) {
+		auto pathSpec = reader.PathSpecOf(entryInfo);
 		try {
-			m_pImpl->AddEntry(result, reader.GetEntryProvider(entryInfo.PathSpec, locator, entryInfo.Allocation), overwriteExisting);
+			m_pImpl->AddEntry(result, reader.GetEntryProvider(pathSpec, locator, entryInfo.Allocation), overwriteExisting);
 		} catch (const std::exception& e) {
-			result.Error.emplace_back(entryInfo.PathSpec, e.what());
+			result.Error.emplace_back(std::move(pathSpec), e.what());
 		}
 	}
 	return result;
@@ -156,11 +151,18 @@ Sqex::Sqpack::Creator::AddEntryResult Sqex::Sqpack::Creator::AddEntryFromFile(En
 	if (file_size(path) == 0) {
 		provider = std::make_shared<EmptyEntryProvider>(std::move(pathSpec));
 	} else if (extensionLower == L".tex") {
-		provider = std::make_shared<OnTheFlyTextureEntryProvider>(std::move(pathSpec), path);
+		if (m_compressionPolicy == CompressionPolicy::Stored)
+			provider = std::make_shared<OnTheFlyTextureEntryProvider>(std::move(pathSpec), path);
+		else
+			provider = std::make_shared<MemoryTextureEntryProvider>(std::move(pathSpec), path, false, m_compressionPolicy);
 	} else if (extensionLower == L".mdl") {
+		// There is no compressing model entry provider; models are always stored.
 		provider = std::make_shared<OnTheFlyModelEntryProvider>(std::move(pathSpec), path);
 	} else {
-		provider = std::make_shared<OnTheFlyBinaryEntryProvider>(std::move(pathSpec), path);
+		if (m_compressionPolicy == CompressionPolicy::Stored)
+			provider = std::make_shared<OnTheFlyBinaryEntryProvider>(std::move(pathSpec), path);
+		else
+			provider = std::make_shared<MemoryBinaryEntryProvider>(std::move(pathSpec), path, false, m_compressionPolicy);
 	}
 	return m_pImpl->AddEntry(provider, overwriteExisting);
 }
@@ -174,14 +176,22 @@ Sqex::Sqpack::Creator::AddEntryResult Sqex::Sqpack::Creator::AddAllEntriesFromSi
 
 	const auto dataStream = std::make_shared<FileRandomAccessStream>(Win32::Handle::FromCreateFile(ttmpdPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING));
 
-	AddEntryResult result;
-	for (size_t i = 0; i < ttmpl.SimpleModsList.size(); ++i) {
-		const auto& entry = ttmpl.SimpleModsList[i];
+	std::vector<const ThirdParty::TexTools::ModEntry*> entries;
+	std::vector<std::string_view> paths;
+	for (const auto& entry : ttmpl.SimpleModsList) {
 		if (entry.DatFile != DatName)
 			continue;
+		entries.push_back(&entry);
+		paths.emplace_back(entry.FullPath);
+	}
+	std::vector<SqexPathHashes> hashes(entries.size());
+	SqexHashPaths(paths, hashes);
 
+	AddEntryResult result;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const auto& entry = *entries[i];
 		try {
-			m_pImpl->AddEntry(result, std::make_shared<RandomAccessStreamAsEntryProviderView>(entry.FullPath, dataStream, entry.ModOffset, entry.ModSize), overwriteExisting);
+			m_pImpl->AddEntry(result, std::make_shared<RandomAccessStreamAsEntryProviderView>(EntryPathSpec(hashes[i], entry.FullPath), dataStream, entry.ModOffset, entry.ModSize), overwriteExisting);
 		} catch (const std::exception& e) {
 			result.Error.emplace_back(EntryPathSpec{ entry.FullPath }, std::string(e.what()));
 			m_pImpl->Log("Error: {} (Name: {} > {})", entry.FullPath, ttmpl.Name, entry.Name);
@@ -191,24 +201,31 @@ Sqex::Sqpack::Creator::AddEntryResult Sqex::Sqpack::Creator::AddAllEntriesFromSi
 }
 
 void Sqex::Sqpack::Creator::ReserveSpacesFromTTMP(const ThirdParty::TexTools::TTMPL & ttmpl) {
-	for (const auto& entry : ttmpl.SimpleModsList) {
-		if (entry.DatFile != DatName || entry.ModSize > UINT32_MAX)
-			continue;
-
-		ReserveSwappableSpace(entry.FullPath, static_cast<uint32_t>(entry.ModSize));
-	}
+	std::vector<const ThirdParty::TexTools::ModEntry*> entries;
+	const auto addEntry = [&](const ThirdParty::TexTools::ModEntry& entry) {
+		if (entry.DatFile == DatName && entry.ModSize <= UINT32_MAX)
+			entries.push_back(&entry);
+	};
+	for (const auto& entry : ttmpl.SimpleModsList)
+		addEntry(entry);
 	for (const auto& modPackPage : ttmpl.ModPackPages) {
 		for (const auto& modGroup : modPackPage.ModGroups) {
 			for (const auto& option : modGroup.OptionList) {
-				for (const auto& entry : option.ModsJsons) {
-					if (entry.DatFile != DatName || entry.ModSize > UINT32_MAX)
-						continue;
-
-					ReserveSwappableSpace(entry.FullPath, static_cast<uint32_t>(entry.ModSize));
-				}
+				for (const auto& entry : option.ModsJsons)
+					addEntry(entry);
 			}
 		}
 	}
+
+	std::vector<std::string_view> paths;
+	paths.reserve(entries.size());
+	for (const auto entry : entries)
+		paths.emplace_back(entry->FullPath);
+	std::vector<SqexPathHashes> hashes(entries.size());
+	SqexHashPaths(paths, hashes);
+
+	for (size_t i = 0; i < entries.size(); ++i)
+		ReserveSwappableSpace(EntryPathSpec(hashes[i], entries[i]->FullPath), static_cast<uint32_t>(entries[i]->ModSize));
 }
 
 Sqex::Sqpack::Creator::AddEntryResult Sqex::Sqpack::Creator::AddEntry(std::shared_ptr<EntryProvider> provider, bool overwriteExisting) {
@@ -216,21 +233,17 @@ Sqex::Sqpack::Creator::AddEntryResult Sqex::Sqpack::Creator::AddEntry(std::share
 }
 
 void Sqex::Sqpack::Creator::ReserveSwappableSpace(EntryPathSpec pathSpec, uint32_t size) {
-	if (const auto it = m_pImpl->m_hashOnlyEntries.find(pathSpec); it != m_pImpl->m_hashOnlyEntries.end()) {
-		it->second->EntryReservedSize = std::max(it->second->EntryReservedSize, size);
-		if (!it->second->Provider->PathSpec().HasOriginal() && pathSpec.HasOriginal()) {
-			it->second->Provider->UpdatePathSpec(pathSpec);
-			m_pImpl->m_fullEntries.emplace(pathSpec, std::move(it->second));
-			m_pImpl->m_hashOnlyEntries.erase(it);
+	if (const auto index = m_pImpl->m_entries.FindIndex(pathSpec); index != EntryKeyTable::NotFound) {
+		const auto& entry = m_pImpl->m_entries[index];
+		entry->EntryReservedSize = std::max(entry->EntryReservedSize, size);
+		if (!entry->Provider->PathSpec().HasOriginal() && pathSpec.HasOriginal()) {
+			entry->Provider->UpdatePathSpec(pathSpec);
+			m_pImpl->m_entries.SetPath(index, pathSpec);
 		}
-	} else if (const auto it = m_pImpl->m_fullEntries.find(pathSpec); it != m_pImpl->m_fullEntries.end()) {
-		it->second->EntryReservedSize = std::max(it->second->EntryReservedSize, size);
 	} else {
 		auto entry = std::make_unique<Entry>(0, 0, 0, SqIndex::LEDataLocator{ 0, 0 }, size, 0, std::make_shared<EmptyEntryProvider>(std::move(pathSpec)));
-		if (entry->Provider->PathSpec().HasOriginal())
-			m_pImpl->m_fullEntries.emplace(entry->Provider->PathSpec(), std::move(entry));
-		else
-			m_pImpl->m_hashOnlyEntries.emplace(entry->Provider->PathSpec(), std::move(entry));
+		const auto& entryPathSpec = entry->Provider->PathSpec();
+		m_pImpl->m_entries.Emplace(entryPathSpec, std::move(entry));
 	}
 }
 
@@ -341,25 +354,66 @@ class Sqex::Sqpack::Creator::DataView : public RandomAccessStream {
 		return buffer;
 	}
 
-	mutable uint64_t m_nLastRequestedOffset = 0;
-	mutable uint64_t m_nLastRequestedSize = 0;
-	mutable std::vector<std::tuple<EntryProvider*, uint64_t, uint64_t>> m_pLastEntryProviders;
+	// Kept only for DescribeState; reads may run concurrently, so it is replaced as a whole under m_lastRequestMtx.
+	struct LastRequest {
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+		std::vector<std::tuple<EntryProvider*, uint64_t, uint64_t>> EntryProviders;
+	};
+	mutable std::mutex m_lastRequestMtx;
+	mutable LastRequest m_lastRequest;
+
+	void RememberRequest(uint64_t offset, uint64_t length, std::span<const std::tuple<const Entry*, uint64_t, std::span<uint8_t>>> entryReads) const {
+		LastRequest lastRequest{
+			.Offset = offset,
+			.Size = length,
+		};
+		lastRequest.EntryProviders.reserve(entryReads.size());
+		for (const auto& [pEntry, relativeOffset, target] : entryReads)
+			lastRequest.EntryProviders.emplace_back(pEntry->Provider.get(), relativeOffset, target.size_bytes());
+
+		const auto lock = std::lock_guard(m_lastRequestMtx);
+		m_lastRequest = std::move(lastRequest);
+	}
+
+	// Entries that are views into the same stream, such as ones imported from existing .dat files, are read with a single vectored read.
+	static void ReadEntries(std::span<const std::tuple<const Entry*, uint64_t, std::span<uint8_t>>> entryReads) {
+		std::vector<std::pair<std::shared_ptr<const RandomAccessStream>, std::vector<ReadRequest>>> storages;
+		for (const auto& [pEntry, relativeOffset, target] : entryReads) {
+			auto storage = pEntry->Provider->SharedStorage();
+			if (!storage.Stream) {
+				pEntry->Provider->ReadStream(relativeOffset, target.data(), target.size_bytes());
+				continue;
+			}
 
-public:
-	DataView(const SqpackHeader& header, const SqData::Header& subheader, std::span<Entry*> entries)
-		: m_header(Concat(header, subheader))
-		, m_entries(std::move(entries)) {
+			// What follows the entry in the shared stream belongs to other entries, so the entry is read as zeros past its size instead.
+			const auto available = relativeOffset < storage.Size ? static_cast<size_t>(std::min<uint64_t>(target.size_bytes(), storage.Size - relativeOffset)) : 0;
+			std::ranges::fill(target.subspan(available), 0);
+			if (!available)
+				continue;
+
+			auto group = std::ranges::find(storages, storage.Stream, [](const auto& item) { return item.first; });
+			if (group == storages.end())
+				group = storages.emplace(storages.end(), std::move(storage.Stream), std::vector<ReadRequest>());
+			group->second.emplace_back(ReadRequest{
+				.Offset = storage.Offset + relativeOffset,
+				.Buffer = target.subspan(0, available),
+			});
+		}
+
+		for (auto& [storage, requests] : storages)
+			storage->ReadStreamVectored(requests);
 	}
 
-	uint64_t ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const override {
-		m_pLastEntryProviders.clear();
-		m_nLastRequestedOffset = offset;
-		m_nLastRequestedSize = length;
-		if (!length)
-			return 0;
+	// Fills header and padding parts of the request, and returns which parts of which entries should be read for the rest.
+	// unread is set to the number of bytes at the end of the request that are beyond the end of this stream.
+	std::vector<std::tuple<const Entry*, uint64_t, std::span<uint8_t>>> PrepareRead(uint64_t offset, std::span<uint8_t> out, size_t& unread) const {
+		std::vector<std::tuple<const Entry*, uint64_t, std::span<uint8_t>>> entryReads;
+		unread = 0;
+		if (out.empty())
+			return entryReads;
 
 		auto relativeOffset = offset;
-		auto out = std::span(static_cast<char*>(buf), static_cast<size_t>(length));
 
 		if (relativeOffset < m_header.size()) {
 			const auto src = std::span(m_header).subspan(static_cast<size_t>(relativeOffset));
@@ -370,7 +424,8 @@ public:
 		} else
 			relativeOffset -= m_header.size();
 
-		if (out.empty()) return length;
+		if (out.empty())
+			return entryReads;
 
 		auto it = std::ranges::lower_bound(m_entries, nullptr, [&](Entry* l, Entry* r) {
 			const auto lo = l ? l->OffsetAfterHeaders : relativeOffset;
@@ -388,8 +443,7 @@ public:
 
 				if (relativeOffset < entry.EntrySize) {
 					const auto available = std::min(out.size_bytes(), static_cast<size_t>(entry.EntrySize - relativeOffset));
-					m_pLastEntryProviders.emplace_back(std::make_tuple(entry.Provider.get(), relativeOffset, available));
-					entry.Provider->ReadStream(relativeOffset, out.data(), available);
+					entryReads.emplace_back(&entry, relativeOffset, out.subspan(0, available));
 					out = out.subspan(available);
 					relativeOffset = 0;
 
@@ -411,7 +465,73 @@ public:
 			}
 		}
 
-		return length - out.size_bytes();
+		unread = out.size_bytes();
+		return entryReads;
+	}
+
+public:
+	DataView(const SqpackHeader& header, const SqData::Header& subheader, std::span<Entry*> entries)
+		: m_header(Concat(header, subheader))
+		, m_entries(std::move(entries)) {
+	}
+
+	uint64_t ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const override {
+		size_t unread;
+		const auto entryReads = PrepareRead(offset, std::span(static_cast<uint8_t*>(buf), static_cast<size_t>(length)), unread);
+		RememberRequest(offset, length, entryReads);
+		ReadEntries(entryReads);
+		return length - unread;
+	}
+
+	// Entries covered by the request are read concurrently, and callback is called once all of them complete.
+	void ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const override {
+		size_t unread;
+		std::vector<std::tuple<const Entry*, uint64_t, std::span<uint8_t>>> entryReads;
+		try {
+			entryReads = PrepareRead(offset, std::span(static_cast<uint8_t*>(buf), static_cast<size_t>(length)), unread);
+			RememberRequest(offset, length, entryReads);
+		} catch (...) {
+			return callback(0, std::current_exception());
+		}
+
+		struct Join {
+			std::shared_ptr<const RandomAccessStream> KeepAlive;
+			ReadCompletionCallback Callback;
+			uint64_t Read;
+			std::atomic_size_t Remaining;
+			std::mutex ErrorMtx;
+			std::exception_ptr Error;
+
+			void Complete(std::exception_ptr error) {
+				if (error) {
+					const auto lock = std::lock_guard(ErrorMtx);
+					if (!Error)
+						Error = std::move(error);
+				}
+				if (--Remaining)
+					return;
+				Callback(Error ? 0 : Read, Error);
+			}
+		};
+
+		// One extra count is held until every read has been submitted.
+		const auto join = std::make_shared<Join>();
+		join->KeepAlive = weak_from_this().lock();
+		join->Callback = std::move(callback);
+		join->Read = length - unread;
+		join->Remaining = entryReads.size() + 1;
+		for (const auto& [pEntry, relativeOffset, target] : entryReads) {
+			try {
+				pEntry->Provider->ReadStreamPartialAsync(relativeOffset, target.data(), target.size_bytes(), [join, expected = target.size_bytes()](uint64_t read, std::exception_ptr error) {
+					if (!error && read != expected)
+						error = std::make_exception_ptr(std::runtime_error("Reached end of stream before reading all of the requested data."));
+					join->Complete(std::move(error));
+				});
+			} catch (...) {
+				join->Complete(std::current_exception());
+			}
+		}
+		join->Complete(nullptr);
 	}
 
 	uint64_t StreamSize() const override {
@@ -419,8 +539,9 @@ public:
 	}
 
 	std::string DescribeState() const override {
-		auto res = std::format("Sqpack::Creator::DataView({}->{})", m_nLastRequestedOffset, m_nLastRequestedSize);
-		for (const auto& [p, off, len] : m_pLastEntryProviders) {
+		const auto lock = std::lock_guard(m_lastRequestMtx);
+		auto res = std::format("Sqpack::Creator::DataView({}->{})", m_lastRequest.Offset, m_lastRequest.Size);
+		for (const auto& [p, off, len] : m_lastRequest.EntryProviders) {
 			res += std::format(" [{}: {}->{}: {}]", p->PathSpec(), off, len, p->DescribeState());
 		}
 		return res;
@@ -433,49 +554,30 @@ Sqex::Sqpack::Creator::SqpackViews Sqex::Sqpack::Creator::AsViews(bool strict) {
 	std::vector<std::pair<size_t, size_t>> dataEntryRanges;
 
 	auto res = SqpackViews{
-		.HashOnlyEntries = std::move(m_pImpl->m_hashOnlyEntries),
-		.FullPathEntries = std::move(m_pImpl->m_fullEntries),
+		.EntriesByPath = std::move(m_pImpl->m_entries),
 	};
 	
-	res.Entries.reserve(m_pImpl->m_fullEntries.size() + m_pImpl->m_hashOnlyEntries.size());
-	for (auto& entry : res.HashOnlyEntries | std::views::values)
-		res.Entries.emplace_back(entry.get());
-	for (auto& entry : res.FullPathEntries | std::views::values)
+	res.EntriesByPath.Sort();
+	res.Entries.reserve(res.EntriesByPath.size());
+	for (const auto& entry : res.EntriesByPath.Values())
 		res.Entries.emplace_back(entry.get());
 
-	std::map<std::pair<uint32_t, uint32_t>, std::vector<Entry*>> pairHashes;
-	std::map<uint32_t, std::vector<Entry*>> fullHashes;
-	for (const auto& entry : res.Entries) {
-		const auto& pathSpec = entry->Provider->PathSpec();
-		pairHashes[std::make_pair(pathSpec.PathHash, pathSpec.NameHash)].emplace_back(entry);
-		fullHashes[pathSpec.FullPathHash].emplace_back(entry);
-	}
+	// Resolving the size of an entry may open its file or compress it, so do it for all entries at once.
+	static constexpr size_t SizeResolutionChunkSize = 64;
+	Win32::ParallelFor((res.Entries.size() + SizeResolutionChunkSize - 1) / SizeResolutionChunkSize, [&res](size_t chunk) {
+		for (size_t i = chunk * SizeResolutionChunkSize, i_ = std::min(res.Entries.size(), i + SizeResolutionChunkSize); i < i_; ++i) {
+			auto& entry = res.Entries[i];
+			const auto& pathSpec = entry->Provider->PathSpec();
+			entry->EntrySize = Align(std::max(entry->EntryReservedSize, static_cast<uint32_t>(entry->Provider->StreamSize()))).Alloc;
+			entry->PadSize = 0;
+			entry->Provider = std::make_shared<HotSwappableEntryProvider>(pathSpec, entry->EntrySize, std::move(entry->Provider));
+		}
+	});
 
 	for (size_t i = 0; i < res.Entries.size(); ++i) {
 		auto& entry = res.Entries[i];
-		const auto& pathSpec = entry->Provider->PathSpec();
-		entry->EntrySize = Align(std::max(entry->EntryReservedSize, static_cast<uint32_t>(entry->Provider->StreamSize()))).Alloc;
-		entry->PadSize = 0;
-		entry->Provider = std::make_shared<HotSwappableEntryProvider>(pathSpec, entry->EntrySize, std::move(entry->Provider));
-
 		if (dataSubheaders.empty() ||
 			sizeof SqpackHeader + sizeof SqData::Header + dataSubheaders.back().DataSize + entry->EntrySize + entry->PadSize > dataSubheaders.back().MaxFileSize) {
-			if (strict && !dataSubheaders.empty()) {
-				CryptoPP::SHA1 sha1;
-				for (auto j = dataEntryRanges.back().first, j_ = j + dataEntryRanges.back().second; j < j_; ++j) {
-					const auto& entry = res.Entries[j];
-					const auto& provider = *entry->Provider;
-					const auto length = provider.StreamSize();
-					uint8_t buf[4096];
-					for (uint64_t j = 0; j < length; j += sizeof buf) {
-						const auto readlen = static_cast<size_t>(std::min<uint64_t>(sizeof buf, length - j));
-						provider.ReadStream(j, buf, readlen);
-						sha1.Update(buf, readlen);
-					}
-				}
-				sha1.Final(reinterpret_cast<byte*>(dataSubheaders.back().DataSha1.Value));
-				dataSubheaders.back().Sha1.SetFromSpan(reinterpret_cast<char*>(&dataSubheaders.back()), offsetof(Sqpack::SqData::Header, Sha1));
-			}
 			dataSubheaders.emplace_back(SqData::Header{
 				.HeaderSize = sizeof SqData::Header,
 				.Unknown1 = SqData::Header::Unknown1_Value,
@@ -493,60 +595,123 @@ Sqex::Sqpack::Creator::SqpackViews Sqex::Sqpack::Creator::AsViews(bool strict) {
 		dataSubheaders.back().DataSize = dataSubheaders.back().DataSize + entry->EntrySize + entry->PadSize;
 		dataEntryRanges.back().second++;
 	}
-	
-	std::vector<SqIndex::PairHashLocator> fileEntries1;
-	std::vector<SqIndex::PairHashWithTextLocator> conflictEntries1;
-	for (const auto& [pairHash, correspondingEntries] : pairHashes) {
-		if (correspondingEntries.size() == 1) {
-			fileEntries1.emplace_back(SqIndex::PairHashLocator{ pairHash.second, pairHash.first, correspondingEntries.front()->Locator, 0 });
-		} else {
-			fileEntries1.emplace_back(SqIndex::PairHashLocator{ pairHash.second, pairHash.first, SqIndex::LEDataLocator::Synonym(), 0});
-			uint32_t i = 0;
-			for (const auto& entry : correspondingEntries) {
-				conflictEntries1.emplace_back(SqIndex::PairHashWithTextLocator{
-					.NameHash = pairHash.second,
-					.PathHash = pairHash.first,
-					.Locator = entry->Locator,
-					.ConflictIndex = i++,
-					});
-				const auto path = entry->Provider->PathSpec().NativeRepresentation();
-				strncpy_s(conflictEntries1.back().FullPath, path.c_str(), path.size());
+
+	std::vector<std::function<void()>> tasks;
+
+	// Data files get their hashes as soon as they are filled up, so the last one is left without.
+	for (size_t i = 0; strict && i + 1 < dataSubheaders.size(); ++i) {
+		tasks.emplace_back([&dataSubheader = dataSubheaders[i], entries = std::span(res.Entries).subspan(dataEntryRanges[i].first, dataEntryRanges[i].second)]() {
+			CryptoPP::SHA1 sha1;
+			std::vector<uint8_t> buf(262144);
+			for (const auto& entry : entries) {
+				const auto& provider = *entry->Provider;
+				const auto length = provider.StreamSize();
+				for (uint64_t j = 0; j < length; j += buf.size()) {
+					const auto readlen = static_cast<size_t>(std::min<uint64_t>(buf.size(), length - j));
+					provider.ReadStream(j, &buf[0], readlen);
+					sha1.Update(&buf[0], readlen);
+				}
 			}
-		}
+			sha1.Final(reinterpret_cast<byte*>(dataSubheader.DataSha1.Value));
+			dataSubheader.Sha1.SetFromSpan(reinterpret_cast<char*>(&dataSubheader), offsetof(Sqpack::SqData::Header, Sha1));
+		});
 	}
-	conflictEntries1.emplace_back(SqIndex::PairHashWithTextLocator{
-		.NameHash = SqIndex::PairHashWithTextLocator::EndOfList,
-		.PathHash = SqIndex::PairHashWithTextLocator::EndOfList,
-		.Locator = 0,
-		.ConflictIndex = SqIndex::PairHashWithTextLocator::EndOfList,
+
+	tasks.emplace_back([this, &res, strict, dataFilesCount = dataSubheaders.size()]() {
+		std::vector<std::tuple<uint32_t, uint32_t, Entry*>> pairHashes;
+		pairHashes.reserve(res.Entries.size());
+		for (const auto& entry : res.Entries) {
+			const auto& pathSpec = entry->Provider->PathSpec();
+			pairHashes.emplace_back(pathSpec.PathHash, pathSpec.NameHash, entry);
+		}
+		std::ranges::stable_sort(pairHashes, [](const auto& l, const auto& r) {
+			if (std::get<0>(l) != std::get<0>(r))
+				return std::get<0>(l) < std::get<0>(r);
+			return std::get<1>(l) < std::get<1>(r);
 		});
 
-	std::vector<SqIndex::FullHashLocator> fileEntries2;
-	std::vector<SqIndex::FullHashWithTextLocator> conflictEntries2;
-	for (const auto& [fullHash, correspondingEntries] : fullHashes) {
-		if (correspondingEntries.size() == 1) {
-			fileEntries2.emplace_back(SqIndex::FullHashLocator{ fullHash, correspondingEntries.front()->Locator });
-		} else {
-			fileEntries2.emplace_back(SqIndex::FullHashLocator{ fullHash, SqIndex::LEDataLocator::Synonym() });
-			uint32_t i = 0;
-			for (const auto& entry : correspondingEntries) {
-				conflictEntries2.emplace_back(SqIndex::FullHashWithTextLocator{
-					.FullPathHash = fullHash,
-					.UnusedHash = 0,
-					.Locator = entry->Locator,
-					.ConflictIndex = i++,
-					});
-				const auto path = entry->Provider->PathSpec().NativeRepresentation();
-				strncpy_s(conflictEntries2.back().FullPath, path.c_str(), path.size());
+		std::vector<SqIndex::PairHashLocator> fileEntries;
+		std::vector<SqIndex::PairHashWithTextLocator> conflictEntries;
+		for (auto it = pairHashes.begin(); it != pairHashes.end();) {
+			const auto [pathHash, nameHash, firstEntry] = *it;
+			auto next = it + 1;
+			while (next != pairHashes.end() && std::get<0>(*next) == pathHash && std::get<1>(*next) == nameHash)
+				++next;
+
+			if (next - it == 1) {
+				fileEntries.emplace_back(SqIndex::PairHashLocator{ nameHash, pathHash, firstEntry->Locator, 0 });
+			} else {
+				fileEntries.emplace_back(SqIndex::PairHashLocator{ nameHash, pathHash, SqIndex::LEDataLocator::Synonym(), 0 });
+				uint32_t i = 0;
+				for (; it != next; ++it) {
+					const auto entry = std::get<2>(*it);
+					conflictEntries.emplace_back(SqIndex::PairHashWithTextLocator{
+						.NameHash = nameHash,
+						.PathHash = pathHash,
+						.Locator = entry->Locator,
+						.ConflictIndex = i++,
+						});
+					const auto path = entry->Provider->PathSpec().NativeRepresentation();
+					strncpy_s(conflictEntries.back().FullPath, path.c_str(), path.size());
+				}
 			}
+			it = next;
 		}
-	}
-	conflictEntries2.emplace_back(SqIndex::FullHashWithTextLocator{
-		.FullPathHash = SqIndex::FullHashWithTextLocator::EndOfList,
-		.UnusedHash = SqIndex::FullHashWithTextLocator::EndOfList,
-		.Locator = 0,
-		.ConflictIndex = SqIndex::FullHashWithTextLocator::EndOfList,
-		});
+		conflictEntries.emplace_back(SqIndex::PairHashWithTextLocator{
+			.NameHash = SqIndex::PairHashWithTextLocator::EndOfList,
+			.PathHash = SqIndex::PairHashWithTextLocator::EndOfList,
+			.Locator = 0,
+			.ConflictIndex = SqIndex::PairHashWithTextLocator::EndOfList,
+			});
+
+		res.Index1 = std::make_shared<Index1View>(dataFilesCount, std::move(fileEntries), std::move(conflictEntries), m_pImpl->m_sqpackIndexSegment3, std::vector<SqIndex::PathHashLocator>(), strict);
+	});
+
+	tasks.emplace_back([this, &res, strict, dataFilesCount = dataSubheaders.size()]() {
+		std::vector<std::pair<uint32_t, Entry*>> fullHashes;
+		fullHashes.reserve(res.Entries.size());
+		for (const auto& entry : res.Entries)
+			fullHashes.emplace_back(entry->Provider->PathSpec().FullPathHash, entry);
+		std::ranges::stable_sort(fullHashes, {}, &std::pair<uint32_t, Entry*>::first);
+
+		std::vector<SqIndex::FullHashLocator> fileEntries;
+		std::vector<SqIndex::FullHashWithTextLocator> conflictEntries;
+		for (auto it = fullHashes.begin(); it != fullHashes.end();) {
+			const auto [fullHash, firstEntry] = *it;
+			auto next = it + 1;
+			while (next != fullHashes.end() && next->first == fullHash)
+				++next;
+
+			if (next - it == 1) {
+				fileEntries.emplace_back(SqIndex::FullHashLocator{ fullHash, firstEntry->Locator });
+			} else {
+				fileEntries.emplace_back(SqIndex::FullHashLocator{ fullHash, SqIndex::LEDataLocator::Synonym() });
+				uint32_t i = 0;
+				for (; it != next; ++it) {
+					const auto entry = it->second;
+					conflictEntries.emplace_back(SqIndex::FullHashWithTextLocator{
+						.FullPathHash = fullHash,
+						.UnusedHash = 0,
+						.Locator = entry->Locator,
+						.ConflictIndex = i++,
+						});
+					const auto path = entry->Provider->PathSpec().NativeRepresentation();
+					strncpy_s(conflictEntries.back().FullPath, path.c_str(), path.size());
+				}
+			}
+			it = next;
+		}
+		conflictEntries.emplace_back(SqIndex::FullHashWithTextLocator{
+			.FullPathHash = SqIndex::FullHashWithTextLocator::EndOfList,
+			.UnusedHash = SqIndex::FullHashWithTextLocator::EndOfList,
+			.Locator = 0,
+			.ConflictIndex = SqIndex::FullHashWithTextLocator::EndOfList,
+			});
+
+		res.Index2 = std::make_shared<Index2View>(dataFilesCount, std::move(fileEntries), std::move(conflictEntries), m_pImpl->m_sqpackIndex2Segment3, std::vector<SqIndex::PathHashLocator>(), strict);
+	});
+
+	Win32::ParallelFor(tasks.size(), [&tasks](size_t i) { tasks[i](); });
 
 	memcpy(dataHeader.Signature, SqpackHeader::Signature_Value, sizeof SqpackHeader::Signature_Value);
 	dataHeader.HeaderSize = sizeof SqpackHeader;
@@ -556,8 +721,6 @@ Sqex::Sqpack::Creator::SqpackViews Sqex::Sqpack::Creator::AsViews(bool strict) {
 	if (strict)
 		dataHeader.Sha1.SetFromSpan(reinterpret_cast<char*>(&dataHeader), offsetof(SqpackHeader, Sha1));
 
-	res.Index1 = std::make_shared<Index1View>(dataSubheaders.size(), std::move(fileEntries1), std::move(conflictEntries1), m_pImpl->m_sqpackIndexSegment3, std::vector<SqIndex::PathHashLocator>(), strict);
-	res.Index2 = std::make_shared<Index2View>(dataSubheaders.size(), std::move(fileEntries2), std::move(conflictEntries2), m_pImpl->m_sqpackIndex2Segment3, std::vector<SqIndex::PathHashLocator>(), strict);
 	for (size_t i = 0; i < dataSubheaders.size(); ++i)
 		res.Data.emplace_back(std::make_shared<DataView>(dataHeader, dataSubheaders[i], std::span(res.Entries).subspan(dataEntryRanges[i].first, dataEntryRanges[i].second)));
 
@@ -565,19 +728,15 @@ Sqex::Sqpack::Creator::SqpackViews Sqex::Sqpack::Creator::AsViews(bool strict) {
 }
 
 std::shared_ptr<Sqex::RandomAccessStream> Sqex::Sqpack::Creator::operator[](const EntryPathSpec& pathSpec) const {
-	if (const auto it = m_pImpl->m_hashOnlyEntries.find(pathSpec); it != m_pImpl->m_hashOnlyEntries.end())
-		return std::make_shared<BufferedRandomAccessStream>(std::make_shared<EntryRawStream>(it->second->Provider));
-	if (const auto it = m_pImpl->m_fullEntries.find(pathSpec); it != m_pImpl->m_fullEntries.end())
-		return std::make_shared<BufferedRandomAccessStream>(std::make_shared<EntryRawStream>(it->second->Provider));
+	if (const auto entry = m_pImpl->m_entries.Find(pathSpec))
+		return std::make_shared<BufferedRandomAccessStream>(std::make_shared<EntryRawStream>((*entry)->Provider));
 	throw std::out_of_range(std::format("PathSpec({}) not found", pathSpec));
 }
 
 std::vector<Sqex::Sqpack::EntryPathSpec> Sqex::Sqpack::Creator::AllPathSpec() const {
 	std::vector<EntryPathSpec> res;
-	res.reserve(m_pImpl->m_hashOnlyEntries.size() + m_pImpl->m_fullEntries.size());
-	for (const auto& entry : m_pImpl->m_hashOnlyEntries | std::views::keys)
-		res.emplace_back(entry);
-	for (const auto& entry : m_pImpl->m_fullEntries | std::views::keys)
-		res.emplace_back(entry);
+	res.reserve(m_pImpl->m_entries.size());
+	for (const auto& entry : m_pImpl->m_entries.Values())
+		res.emplace_back(entry->Provider->PathSpec());
 	return res;
 }
@@ -0,0 +1,176 @@
+#include "pch.h"
+#include "Sqex_Sqpack_EntryCache.h"
+
+static std::string ToHexString(const uint8_t* data, size_t length) {
+	std::string res;
+	res.reserve(length * 2);
+	for (size_t i = 0; i < length; ++i)
+		res += std::format("{:02x}", data[i]);
+	return res;
+}
+
+Sqex::Sqpack::EntryCache& Sqex::Sqpack::EntryCache::Instance() {
+	static EntryCache instance;
+	return instance;
+}
+
+void Sqex::Sqpack::EntryCache::Configure(std::filesystem::path dir, uint64_t maxSize) {
+	const auto lock = std::lock_guard(m_mtx);
+	m_dir = std::move(dir);
+	m_maxSize = maxSize;
+	m_totalSize = 0;
+	if (m_dir.empty())
+		return;
+
+	std::error_code ec;
+	create_directories(m_dir, ec);
+	for (const auto& item : std::filesystem::directory_iterator(m_dir, ec)) {
+		if (!item.is_regular_file(ec))
+			continue;
+
+		// Leftovers from writes interrupted in a previous session.
+		if (item.path().extension() == L".tmp")
+			remove(item.path(), ec);
+		else
+			m_totalSize += item.file_size(ec);
+	}
+	EvictUntil(m_maxSize);
+}
+
+bool Sqex::Sqpack::EntryCache::Enabled() const {
+	const auto lock = std::lock_guard(m_mtx);
+	return !m_dir.empty() && m_maxSize;
+}
+
+std::string Sqex::Sqpack::EntryCache::MakeKey(std::string_view tag, const std::filesystem::path& source) {
+	const auto path = canonical(source).wstring();
+	const auto size = file_size(source);
+	const auto mtime = last_write_time(source).time_since_epoch().count();
+
+	CryptoPP::SHA1 sha1;
+	sha1.Update(reinterpret_cast<const byte*>(tag.data()), tag.size());
+	sha1.Update(reinterpret_cast<const byte*>(path.data()), path.size() * sizeof path[0]);
+	sha1.Update(reinterpret_cast<const byte*>(&size), sizeof size);
+	sha1.Update(reinterpret_cast<const byte*>(&mtime), sizeof mtime);
+
+	uint8_t digest[CryptoPP::SHA1::DIGESTSIZE];
+	sha1.Final(digest);
+	return ToHexString(digest, sizeof digest);
+}
+
+std::string Sqex::Sqpack::EntryCache::MakeKey(std::string_view tag, const RandomAccessStream& source) {
+	const auto size = source.StreamSize();
+
+	CryptoPP::SHA1 sha1;
+	sha1.Update(reinterpret_cast<const byte*>(tag.data()), tag.size());
+	sha1.Update(reinterpret_cast<const byte*>(&size), sizeof size);
+
+	std::vector<uint8_t> buf(static_cast<size_t>(std::min<uint64_t>(size, 1048576)));
+	for (uint64_t offset = 0; offset < size; offset += buf.size()) {
+		const auto length = static_cast<size_t>(std::min<uint64_t>(buf.size(), size - offset));
+		source.ReadStream(offset, buf.data(), length);
+		sha1.Update(buf.data(), length);
+	}
+
+	uint8_t digest[CryptoPP::SHA1::DIGESTSIZE];
+	sha1.Final(digest);
+	return ToHexString(digest, sizeof digest);
+}
+
+std::shared_ptr<const Sqex::RandomAccessStream> Sqex::Sqpack::EntryCache::Find(const std::string& key) {
+	std::filesystem::path path;
+	{
+		const auto lock = std::lock_guard(m_mtx);
+		if (m_dir.empty() || !m_maxSize)
+			return nullptr;
+		path = m_dir / key;
+	}
+
+	std::error_code ec;
+	if (!exists(path, ec))
+		return nullptr;
+
+	try {
+		auto file = Win32::Handle::FromCreateFile(path, GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING);
+
+		const auto header = file.Read<FileHeader>(0);
+		if (memcmp(header.Signature, FileHeader::Signature_Value, sizeof header.Signature) != 0
+			|| file.GetFileSize() != sizeof header + header.EntrySize)
+			throw CorruptDataException("Invalid cached entry");
+
+		// Mark as recently used, so that eviction removes entries that have not been used for the longest time first.
+		FILETIME now;
+		GetSystemTimeAsFileTime(&now);
+		SetFileTime(file, nullptr, nullptr, &now);
+
+		return std::make_shared<FileRandomAccessStream>(std::move(file), sizeof header, header.EntrySize);
+	} catch (const std::exception&) {
+		remove(path, ec);
+		return nullptr;
+	}
+}
+
+void Sqex::Sqpack::EntryCache::Put(const std::string& key, const RandomAccessStream& entry) {
+	std::filesystem::path path;
+	{
+		const auto lock = std::lock_guard(m_mtx);
+		if (m_dir.empty() || !m_maxSize)
+			return;
+		path = m_dir / key;
+	}
+
+	const auto entrySize = entry.StreamSize();
+	const auto tmpPath = std::filesystem::path(path).replace_extension(std::format(L"{}.tmp", GetCurrentThreadId()));
+	std::error_code ec;
+	try {
+		{
+			const auto file = Win32::Handle::FromCreateFile(tmpPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS);
+
+			FileHeader header{};
+			memcpy(header.Signature, FileHeader::Signature_Value, sizeof header.Signature);
+			header.EntrySize = entrySize;
+			file.Write(0, &header, sizeof header);
+
+			std::vector<uint8_t> buf(static_cast<size_t>(std::min<uint64_t>(entrySize, 1048576)));
+			for (uint64_t offset = 0; offset < entrySize; offset += buf.size()) {
+				const auto length = static_cast<size_t>(std::min<uint64_t>(buf.size(), entrySize - offset));
+				entry.ReadStream(offset, buf.data(), length);
+				file.Write(sizeof header + offset, buf.data(), length);
+			}
+		}
+
+		const auto lock = std::lock_guard(m_mtx);
+		EvictUntil(m_maxSize > sizeof FileHeader + entrySize ? m_maxSize - sizeof FileHeader - entrySize : 0);
+		rename(tmpPath, path);
+		m_totalSize += sizeof FileHeader + entrySize;
+	} catch (const std::exception&) {
+		remove(tmpPath, ec);
+	}
+}
+
+void Sqex::Sqpack::EntryCache::EvictUntil(uint64_t size) {
+	if (m_totalSize <= size)
+		return;
+
+	std::error_code ec;
+	std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+	for (const auto& item : std::filesystem::directory_iterator(m_dir, ec)) {
+		if (item.is_regular_file(ec) && item.path().extension() != L".tmp")
+			files.emplace_back(item.last_write_time(ec), item.path());
+	}
+	std::ranges::sort(files);
+
+	m_totalSize = 0;
+	for (const auto& path : files | std::views::values)
+		m_totalSize += file_size(path, ec);
+
+	for (const auto& path : files | std::views::values) {
+		if (m_totalSize <= size)
+			break;
+
+		// Entries that fail to be removed are counted until the next eviction attempt.
+		const auto fileSize = file_size(path, ec);
+		if (remove(path, ec))
+			m_totalSize -= fileSize;
+	}
+}
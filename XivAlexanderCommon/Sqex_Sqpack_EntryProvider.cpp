@@ -1,9 +1,68 @@
 #include "pch.h"
 #include "Sqex_Sqpack_EntryProvider.h"
 
+#include <cmath>
+#include <optional>
+
 #include "Sqex_Model.h"
+#include "Sqex_Sqpack_EntryCache.h"
 #include "XaZlib.h"
 
+namespace {
+	// Compresses blocks of an entry under a CompressionPolicy.
+	class BlockCompressor {
+		// Deflate rarely saves anything on blocks with a higher order-0 entropy, in bits per byte.
+		static constexpr double AdaptiveStoreEntropyThreshold = 7.5;
+
+		const Sqex::Sqpack::CompressionPolicy m_policy;
+		std::optional<Utils::ZlibReusableDeflater> m_deflater;
+
+		static double EstimateEntropy(std::span<const uint8_t> data) {
+			uint32_t counts[256]{};
+			for (const auto b : data)
+				++counts[b];
+
+			double entropy = 0;
+			for (const auto count : counts) {
+				if (!count)
+					continue;
+				const auto p = static_cast<double>(count) / static_cast<double>(data.size());
+				entropy -= p * std::log2(p);
+			}
+			return entropy;
+		}
+
+	public:
+		BlockCompressor(Sqex::Sqpack::CompressionPolicy policy)
+			: m_policy(policy) {
+			switch (policy) {
+				case Sqex::Sqpack::CompressionPolicy::Best:
+					m_deflater.emplace(Z_BEST_COMPRESSION, Z_DEFLATED, -15);
+					break;
+				case Sqex::Sqpack::CompressionPolicy::Fast:
+					m_deflater.emplace(Z_BEST_SPEED, Z_DEFLATED, -15);
+					break;
+				case Sqex::Sqpack::CompressionPolicy::Adaptive:
+					m_deflater.emplace(Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15);
+					break;
+			}
+		}
+
+		// Returns the compressed block, or an empty span if the block should be stored uncompressed.
+		std::span<const uint8_t> operator()(std::span<const uint8_t> data) {
+			if (!m_deflater || data.empty())
+				return {};
+			if (m_policy == Sqex::Sqpack::CompressionPolicy::Adaptive && EstimateEntropy(data) >= AdaptiveStoreEntropyThreshold)
+				return {};
+
+			const auto compressed = (*m_deflater)(data);
+			if (compressed.size() >= data.size())
+				return {};
+			return compressed;
+		}
+	};
+}
+
 uint64_t Sqex::Sqpack::EmptyEntryProvider::ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const {
 	if (offset < sizeof SqData::FileEntryHeader) {
 		const auto header = SqData::FileEntryHeader{
@@ -47,11 +106,15 @@ uint64_t Sqex::Sqpack::LazyFileOpeningEntryProvider::StreamSize() const {
 		return estimate;
 
 	const_cast<LazyFileOpeningEntryProvider*>(this)->Resolve();
+	if (m_cached)
+		return m_cached->StreamSize();
 	return StreamSize(*m_stream);
 }
 
 uint64_t Sqex::Sqpack::LazyFileOpeningEntryProvider::ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const {
 	const_cast<LazyFileOpeningEntryProvider*>(this)->Resolve();
+	if (m_cached)
+		return m_cached->ReadStreamPartial(offset, buf, length);
 	return ReadStreamPartial(*m_stream, offset, buf, length);
 }
 
@@ -68,9 +131,24 @@ void Sqex::Sqpack::LazyFileOpeningEntryProvider::Resolve() {
 	if (!m_initializationMutex)
 		return;
 
-	Initialize(*m_stream);
+	auto& cache = EntryCache::Instance();
+	std::string cacheKey;
+	if (const auto tag = EntryCacheTag(); !tag.empty() && cache.Enabled()) {
+		try {
+			cacheKey = m_path.empty() ? EntryCache::MakeKey(tag, *m_stream) : EntryCache::MakeKey(tag, m_path);
+			m_cached = cache.Find(cacheKey);
+		} catch (const std::exception&) {
+			cacheKey.clear();
+		}
+	}
+
+	if (!m_cached)
+		Initialize(*m_stream);
 
 	m_initializationMutex = nullptr;
+
+	if (!m_cached && !cacheKey.empty())
+		cache.Put(cacheKey, *this);
 }
 
 void Sqex::Sqpack::OnTheFlyBinaryEntryProvider::Initialize(const RandomAccessStream& stream) {
@@ -210,7 +288,7 @@ void Sqex::Sqpack::MemoryBinaryEntryProvider::Initialize(const RandomAccessStrea
 		.BlockCountOrVersion = 0,
 	};
 
-	ZlibReusableDeflater deflater(Z_BEST_COMPRESSION, Z_DEFLATED, -15);
+	BlockCompressor compressor(m_compressionPolicy);
 	std::vector<uint8_t> entryBody;
 	entryBody.reserve(rawSize);
 
@@ -219,15 +297,16 @@ void Sqex::Sqpack::MemoryBinaryEntryProvider::Initialize(const RandomAccessStrea
 		uint8_t buf[BlockDataSize];
 		const auto len = std::min<uint32_t>(BlockDataSize, rawSize - i);
 		stream.ReadStream(i, buf, len);
-		auto compressed = deflater(std::span(buf, len));
+		const auto compressed = compressor(std::span(buf, len));
+		const auto payload = compressed.empty() ? std::span<const uint8_t>(buf, len) : compressed;
 
 		SqData::BlockHeader header{
 			.HeaderSize = sizeof SqData::BlockHeader,
 			.Version = 0,
-			.CompressedSize = static_cast<uint32_t>(compressed.size()),
+			.CompressedSize = compressed.empty() ? SqData::BlockHeader::CompressedSizeNotCompressed : static_cast<uint32_t>(compressed.size()),
 			.DecompressedSize = len,
 		};
-		const auto alignmentInfo = Align(sizeof header + compressed.size());
+		const auto alignmentInfo = Align(sizeof header + payload.size());
 
 		locators.emplace_back(SqData::BlockHeaderLocator{
 			locators.empty() ? 0 : locators.back().BlockSize + locators.back().Offset,
@@ -239,7 +318,7 @@ void Sqex::Sqpack::MemoryBinaryEntryProvider::Initialize(const RandomAccessStrea
 
 		auto ptr = entryBody.end() - static_cast<SSIZE_T>(alignmentInfo.Alloc);
 		ptr = std::copy_n(reinterpret_cast<uint8_t*>(&header), sizeof header, ptr);
-		ptr = std::copy(compressed.begin(), compressed.end(), ptr);
+		ptr = std::copy(payload.begin(), payload.end(), ptr);
 		std::fill_n(ptr, alignmentInfo.Pad, 0);
 	}
 
@@ -701,7 +780,7 @@ void Sqex::Sqpack::MemoryTextureEntryProvider::Initialize(const RandomAccessStre
 	}
 	m_mipmapSizes.back() = entryHeader.DecompressedSize - m_mipmapSizes.back();
 
-	ZlibReusableDeflater deflater(Z_BEST_COMPRESSION, Z_DEFLATED, -15);
+	BlockCompressor compressor(m_compressionPolicy);
 	std::vector<uint8_t> entryBody;
 	entryBody.reserve(static_cast<SSIZE_T>(stream.StreamSize()));
 
@@ -722,15 +801,16 @@ void Sqex::Sqpack::MemoryTextureEntryProvider::Initialize(const RandomAccessStre
 			const auto buf = std::span(readBuffer).subspan(0, len);
 			stream.ReadStream(offset, std::span(buf));
 			offset += len;
-			auto compressed = deflater(buf);
+			const auto compressed = compressor(buf);
+			const auto payload = compressed.empty() ? std::span<const uint8_t>(buf) : compressed;
 
 			SqData::BlockHeader header{
 				.HeaderSize = sizeof SqData::BlockHeader,
 				.Version = 0,
-				.CompressedSize = static_cast<uint32_t>(compressed.size()),
+				.CompressedSize = compressed.empty() ? SqData::BlockHeader::CompressedSizeNotCompressed : static_cast<uint32_t>(compressed.size()),
 				.DecompressedSize = len,
 			};
-			const auto alignmentInfo = Align(sizeof header + compressed.size());
+			const auto alignmentInfo = Align(sizeof header + payload.size());
 
 			subBlockSizes.push_back(static_cast<uint16_t>(alignmentInfo.Alloc));
 			blockOffsetCounter += subBlockSizes.back();
@@ -739,7 +819,7 @@ void Sqex::Sqpack::MemoryTextureEntryProvider::Initialize(const RandomAccessStre
 
 			auto ptr = entryBody.end() - static_cast<SSIZE_T>(alignmentInfo.Alloc);
 			ptr = std::copy_n(reinterpret_cast<uint8_t*>(&header), sizeof header, ptr);
-			ptr = std::copy(compressed.begin(), compressed.end(), ptr);
+			ptr = std::copy(payload.begin(), payload.end(), ptr);
 			std::fill_n(ptr, alignmentInfo.Pad, 0);
 		}
 
@@ -780,6 +860,21 @@ uint64_t Sqex::Sqpack::MemoryTextureEntryProvider::ReadStreamPartial(const Rando
 	return available;
 }
 
+void Sqex::Sqpack::RandomAccessStreamAsEntryProviderView::ReadStreamPartialVectored(std::span<ReadRequest> requests) const {
+	std::vector<ReadRequest> translated;
+	translated.reserve(requests.size());
+	for (const auto& request : requests) {
+		const auto offset = std::min(request.Offset, m_size);
+		translated.emplace_back(ReadRequest{
+			.Offset = m_offset + offset,
+			.Buffer = request.Buffer.subspan(0, static_cast<size_t>(std::min<uint64_t>(request.Buffer.size_bytes(), m_size - offset))),
+		});
+	}
+	m_stream->ReadStreamPartialVectored(translated);
+	for (size_t i = 0; i < requests.size(); ++i)
+		requests[i].Read = translated[i].Read;
+}
+
 uint64_t Sqex::Sqpack::HotSwappableEntryProvider::ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const {
 	if (offset >= m_reservedSize)
 		return 0;
@@ -811,3 +906,63 @@ uint64_t Sqex::Sqpack::HotSwappableEntryProvider::ReadStreamPartial(uint64_t off
 	}
 	return length;
 }
+
+void Sqex::Sqpack::HotSwappableEntryProvider::ReadStreamPartialVectored(std::span<ReadRequest> requests) const {
+	if (m_stream || !m_baseStream)
+		return EmptyEntryProvider::ReadStreamPartialVectored(requests);
+
+	// Same clamping as ReadStreamPartial: the base stream is read up to its size, and the rest of the reserved space is zeros.
+	const auto baseSize = m_baseStream->StreamSize();
+	std::vector<ReadRequest> translated;
+	translated.reserve(requests.size());
+	for (const auto& request : requests) {
+		const auto offset = std::min(request.Offset, baseSize);
+		translated.emplace_back(ReadRequest{
+			.Offset = offset,
+			.Buffer = request.Buffer.subspan(0, static_cast<size_t>(std::min<uint64_t>(request.Buffer.size_bytes(), baseSize - offset))),
+		});
+	}
+	m_baseStream->ReadStreamPartialVectored(translated);
+
+	for (size_t i = 0; i < requests.size(); ++i) {
+		auto& request = requests[i];
+		if (request.Offset >= m_reservedSize) {
+			request.Read = 0;
+			continue;
+		}
+		if (translated[i].Read != translated[i].Buffer.size_bytes())
+			throw std::logic_error("HotSwappableEntryProvider underlying data read fail");
+
+		const auto length = static_cast<size_t>(std::min<uint64_t>(request.Buffer.size_bytes(), m_reservedSize - request.Offset));
+		void(std::ranges::fill(request.Buffer.subspan(translated[i].Buffer.size_bytes(), length - translated[i].Buffer.size_bytes()), 0));
+		request.Read = length;
+	}
+}
+
+void Sqex::Sqpack::HotSwappableEntryProvider::ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const {
+	auto stream = m_stream ? m_stream : m_baseStream;
+	if (!stream || offset >= m_reservedSize) {
+		uint64_t read;
+		try {
+			read = ReadStreamPartial(offset, buf, length);
+		} catch (...) {
+			return callback(0, std::current_exception());
+		}
+		return callback(read, nullptr);
+	}
+
+	// Same clamping as ReadStreamPartial; the padding is filled before the read starts, so that it is done by the time callback is called.
+	length = std::min<uint64_t>(length, m_reservedSize - offset);
+	const auto underlyingStreamLength = stream->StreamSize();
+	const auto dataLength = offset < underlyingStreamLength ? std::min(length, underlyingStreamLength - offset) : 0;
+	std::fill_n(static_cast<uint8_t*>(buf) + dataLength, static_cast<size_t>(length - dataLength), 0);
+	if (!dataLength)
+		return callback(length, nullptr);
+
+	const auto pStream = stream.get();
+	pStream->ReadStreamPartialAsync(offset, buf, dataLength, [stream = std::move(stream), length, dataLength, callback = std::move(callback)](uint64_t read, std::exception_ptr error) {
+		if (!error && read != dataLength)
+			error = std::make_exception_ptr(std::logic_error("HotSwappableEntryProvider underlying data read fail"));
+		callback(error ? 0 : length, error);
+	});
+}
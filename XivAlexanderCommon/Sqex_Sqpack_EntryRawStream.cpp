@@ -2,6 +2,7 @@
 #include "Sqex_Sqpack_EntryRawStream.h"
 
 #include "Sqex_Texture.h"
+#include "Utils_Win32_ThreadPool.h"
 #include "XaZlib.h"
 
 Sqex::Sqpack::EntryRawStream::BinaryStreamDecoder::BinaryStreamDecoder(const EntryRawStream* stream)
@@ -22,6 +23,129 @@ Sqex::Sqpack::EntryRawStream::BinaryStreamDecoder::BinaryStreamDecoder(const Ent
 		throw CorruptDataException("Data truncated (sum(BlockHeaderLocator.DecompressedDataSize) < FileEntryHeader.DecompresedSize)");
 }
 
+Sqex::Sqpack::DecodedBlockCache::DecodedBlockCache(size_t capacity)
+	: m_capacity(capacity) {
+}
+
+Sqex::Sqpack::DecodedBlockCache& Sqex::Sqpack::DecodedBlockCache::Instance() {
+	static DecodedBlockCache instance;
+	return instance;
+}
+
+size_t Sqex::Sqpack::DecodedBlockCache::Capacity() const {
+	const auto lock = std::lock_guard(m_mtx);
+	return m_capacity;
+}
+
+void Sqex::Sqpack::DecodedBlockCache::Capacity(size_t capacity) {
+	const auto lock = std::lock_guard(m_mtx);
+	m_capacity = capacity;
+	EvictUntil(m_capacity);
+}
+
+Sqex::Sqpack::DecodedBlockCache::Statistics Sqex::Sqpack::DecodedBlockCache::GetStatistics() const {
+	const auto lock = std::lock_guard(m_mtx);
+	return {
+		.Hits = m_hits,
+		.Misses = m_misses,
+		.Evictions = m_evictions,
+		.Entries = m_items.size(),
+		.Bytes = m_bytes,
+		.Capacity = m_capacity,
+	};
+}
+
+std::shared_ptr<const std::vector<uint8_t>> Sqex::Sqpack::DecodedBlockCache::Find(const std::shared_ptr<const RandomAccessStream>& stream, uint64_t offset) {
+	const auto lock = std::lock_guard(m_mtx);
+	const auto it = m_index.find(Key{stream.get(), offset});
+	if (it == m_index.end()) {
+		m_misses++;
+		return nullptr;
+	}
+
+	if (it->second->Stream.expired()) {
+		Erase(it->second);
+		m_misses++;
+		return nullptr;
+	}
+
+	m_items.splice(m_items.begin(), m_items, it->second);
+	m_hits++;
+	return it->second->Data;
+}
+
+void Sqex::Sqpack::DecodedBlockCache::Put(const std::shared_ptr<const RandomAccessStream>& stream, uint64_t offset, std::shared_ptr<const std::vector<uint8_t>> data) {
+	const auto lock = std::lock_guard(m_mtx);
+	if (data->size() > m_capacity)
+		return;
+
+	const auto key = Key{stream.get(), offset};
+	if (const auto it = m_index.find(key); it != m_index.end())
+		Erase(it->second);  // another thread decoded the same block, or the stream at the address has changed
+
+	EvictUntil(m_capacity - data->size());
+	m_bytes += data->size();
+	m_items.emplace_front(Item{key, stream, std::move(data)});
+	m_index.emplace(key, m_items.begin());
+}
+
+void Sqex::Sqpack::DecodedBlockCache::Clear() {
+	const auto lock = std::lock_guard(m_mtx);
+	m_items.clear();
+	m_index.clear();
+	m_bytes = 0;
+}
+
+void Sqex::Sqpack::DecodedBlockCache::EvictUntil(size_t bytes) {
+	while (m_bytes > bytes) {
+		Erase(std::prev(m_items.end()));
+		m_evictions++;
+	}
+}
+
+void Sqex::Sqpack::DecodedBlockCache::Erase(std::list<Item>::iterator it) {
+	m_bytes -= it->Data->size();
+	m_index.erase(it->Id);
+	m_items.erase(it);
+}
+
+// Raw deflate inflater of the calling thread, shared by serial reads and the thread pool workers of parallel ones.
+static Utils::ZlibReusableInflater& ThreadInflater() {
+	thread_local Utils::ZlibReusableInflater inflater{-15};
+	return inflater;
+}
+
+// Compressed block whose inflation has been postponed, so that multiple blocks can be inflated at once.
+struct DeferredBlock {
+	std::vector<uint8_t> Source;
+	std::span<uint8_t> Target;
+	size_t RelativeOffset;
+	size_t DecompressedSize;
+
+	void Inflate(Utils::ZlibReusableInflater& inflater) const {
+		if (RelativeOffset) {
+			const auto buf = inflater(Source, DecompressedSize);
+			if (buf.size_bytes() != DecompressedSize)
+				throw Sqex::CorruptDataException(std::format("Expected {} bytes, inflated to {} bytes",
+					DecompressedSize, buf.size_bytes()));
+			std::copy_n(&buf[RelativeOffset], Target.size_bytes(), Target.begin());
+		} else {
+			const auto buf = inflater(Source, Target);
+			if (buf.size_bytes() != Target.size_bytes())
+				throw Sqex::CorruptDataException(std::format("Expected {} bytes, inflated to {} bytes",
+					Target.size_bytes(), buf.size_bytes()));
+		}
+	}
+};
+
+// Inflates blocks using the calling thread and the process default thread pool.
+// Blocks are independently compressed and write to disjoint ranges, so they can be processed in any order.
+static void InflateDeferredBlocks(std::span<const DeferredBlock> blocks) {
+	Utils::Win32::ParallelFor(blocks.size(), [blocks](size_t i) {
+		blocks[i].Inflate(ThreadInflater());
+	});
+}
+
 struct Sqex::Sqpack::EntryRawStream::StreamDecoder::ReadStreamState {
 	const RandomAccessStream& Underlying;
 	std::span<uint8_t> destination;
@@ -29,10 +153,25 @@ struct Sqex::Sqpack::EntryRawStream::StreamDecoder::ReadStreamState {
 	uint64_t relativeOffset = 0;
 	uint32_t requestOffsetVerify = 0;
 
-	ZlibReusableInflater m_inflater{-15};
+	// If set, compressed blocks are queued here instead of being inflated right away; see FlushDeferred.
+	std::vector<DeferredBlock>* deferred = nullptr;
+
+	// If set, decoded blocks are looked up from and stored into DecodedBlockCache, keyed by offset in this stream.
+	std::shared_ptr<const RandomAccessStream> cacheStorage;
+	uint64_t cacheBaseOffset = 0;
+
+	SqData::BlockHeader lastBlockHeader{};
 
 	[[nodiscard]] const auto& AsHeader() const {
-		return *reinterpret_cast<const SqData::BlockHeader*>(&readBuffer[0]);
+		return lastBlockHeader;
+	}
+
+	void UseBlockCache(const EntryProvider& provider) {
+		if (!DecodedBlockCache::Instance().Capacity())
+			return;
+		const auto storage = provider.SharedStorage();
+		cacheStorage = storage.Stream;
+		cacheBaseOffset = storage.Offset;
 	}
 
 private:
@@ -52,11 +191,36 @@ private:
 			throw CorruptDataException("Duplicate read on same region");
 	}
 
+	void Consume(std::span<const uint8_t> decoded) {
+		if (relativeOffset < decoded.size_bytes()) {
+			const auto available = std::min(destination.size_bytes(), static_cast<size_t>(decoded.size_bytes() - relativeOffset));
+			std::copy_n(&decoded[static_cast<size_t>(relativeOffset)], available, destination.begin());
+			destination = destination.subspan(available);
+			relativeOffset = 0;
+		} else
+			relativeOffset -= decoded.size_bytes();
+	}
+
 public:
 	void Progress(
 		const uint32_t requestOffset,
 		uint32_t blockOffset
 	) {
+		if (cacheStorage) {
+			if (const auto cached = DecodedBlockCache::Instance().Find(cacheStorage, cacheBaseOffset + blockOffset)) {
+				lastBlockHeader = {};
+				lastBlockHeader.DecompressedSize = static_cast<uint32_t>(cached->size());
+
+				AttemptSatisfyRequestOffset(requestOffset);
+				if (destination.empty())
+					return;
+
+				requestOffsetVerify += lastBlockHeader.DecompressedSize;
+				Consume(*cached);
+				return;
+			}
+		}
+
 		const auto read = std::span(&readBuffer[0], static_cast<size_t>(Underlying.ReadStreamPartial(blockOffset, &readBuffer[0], readBuffer.size())));
 		const auto& blockHeader = *reinterpret_cast<const SqData::BlockHeader*>(&readBuffer[0]);
 
@@ -65,6 +229,7 @@ public:
 			Progress(requestOffset, blockOffset);
 			return;
 		}
+		lastBlockHeader = blockHeader;
 
 		AttemptSatisfyRequestOffset(requestOffset);
 		if (destination.empty())
@@ -72,7 +237,25 @@ public:
 
 		requestOffsetVerify += blockHeader.DecompressedSize;
 
-		if (relativeOffset < blockHeader.DecompressedSize) {
+		if (relativeOffset < blockHeader.DecompressedSize && cacheStorage && !deferred) {
+			// Decode the whole block, so that adjacent reads can reuse it.
+			auto decoded = std::make_shared<std::vector<uint8_t>>(blockHeader.DecompressedSize);
+			if (blockHeader.CompressedSize == SqData::BlockHeader::CompressedSizeNotCompressed) {
+				if (sizeof blockHeader + blockHeader.DecompressedSize > read.size_bytes())
+					throw CorruptDataException("Failed to read block");
+				std::copy_n(&read[sizeof blockHeader], decoded->size(), decoded->begin());
+			} else {
+				if (sizeof blockHeader + blockHeader.CompressedSize > read.size_bytes())
+					throw CorruptDataException("Failed to read block");
+				const auto buf = ThreadInflater()(read.subspan(sizeof blockHeader, blockHeader.CompressedSize), std::span(*decoded));
+				if (buf.size_bytes() != decoded->size())
+					throw CorruptDataException(std::format("Expected {} bytes, inflated to {} bytes",
+						decoded->size(), buf.size_bytes()));
+			}
+			Consume(*decoded);
+			DecodedBlockCache::Instance().Put(cacheStorage, cacheBaseOffset + blockOffset, std::move(decoded));
+
+		} else if (relativeOffset < blockHeader.DecompressedSize) {
 			auto target = destination.subspan(0, std::min(destination.size_bytes(), static_cast<size_t>(blockHeader.DecompressedSize - relativeOffset)));
 			if (blockHeader.CompressedSize == SqData::BlockHeader::CompressedSizeNotCompressed) {
 				std::copy_n(&read[static_cast<size_t>(sizeof blockHeader + relativeOffset)], target.size(), target.begin());
@@ -80,8 +263,16 @@ public:
 				if (sizeof blockHeader + blockHeader.CompressedSize > read.size_bytes())
 					throw CorruptDataException("Failed to read block");
 				
-				if (relativeOffset) {
-					const auto buf = m_inflater(read.subspan(sizeof blockHeader, blockHeader.CompressedSize), blockHeader.DecompressedSize);
+				if (deferred) {
+					const auto source = read.subspan(sizeof blockHeader, blockHeader.CompressedSize);
+					deferred->emplace_back(DeferredBlock{
+						.Source = {source.begin(), source.end()},
+						.Target = target,
+						.RelativeOffset = static_cast<size_t>(relativeOffset),
+						.DecompressedSize = blockHeader.DecompressedSize,
+					});
+				} else if (relativeOffset) {
+					const auto buf = ThreadInflater()(read.subspan(sizeof blockHeader, blockHeader.CompressedSize), blockHeader.DecompressedSize);
 					if (buf.size_bytes() != blockHeader.DecompressedSize)
 						throw CorruptDataException(std::format("Expected {} bytes, inflated to {} bytes",
 							blockHeader.DecompressedSize.Value(), buf.size_bytes()));
@@ -89,7 +280,7 @@ public:
 						target.size_bytes(),
 						target.begin());
 				} else {
-					const auto buf = m_inflater(read.subspan(sizeof blockHeader, blockHeader.CompressedSize), target);
+					const auto buf = ThreadInflater()(read.subspan(sizeof blockHeader, blockHeader.CompressedSize), target);
 					if (buf.size_bytes() != target.size_bytes())
 						throw CorruptDataException(std::format("Expected {} bytes, inflated to {} bytes",
 							target.size_bytes(), buf.size_bytes()));
@@ -101,6 +292,16 @@ public:
 		} else
 			relativeOffset -= blockHeader.DecompressedSize;
 	}
+
+	void FlushDeferred() {
+		if (!deferred || deferred->empty())
+			return;
+		if (deferred->size() == 1)
+			deferred->front().Inflate(ThreadInflater());
+		else
+			InflateDeferredBlocks(*deferred);
+		deferred->clear();
+	}
 };
 
 uint64_t Sqex::Sqpack::EntryRawStream::BinaryStreamDecoder::ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) {
@@ -118,6 +319,10 @@ uint64_t Sqex::Sqpack::EntryRawStream::BinaryStreamDecoder::ReadStreamPartial(ui
 		.relativeOffset = offset - m_offsets[it],
 		.requestOffsetVerify = m_offsets[it],
 	};
+	std::vector<DeferredBlock> deferred;
+	if (ParallelDecompression() && length >= ParallelDecompressionMinLength)
+		info.deferred = &deferred;
+	info.UseBlockCache(Underlying());
 
 	for (; it < m_offsets.size(); ++it) {
 		info.Progress(m_offsets[it], m_blockOffsets[it]);
@@ -125,6 +330,7 @@ uint64_t Sqex::Sqpack::EntryRawStream::BinaryStreamDecoder::ReadStreamPartial(ui
 			break;
 	}
 
+	info.FlushDeferred();
 	MaxBlockSize = info.readBuffer.size();
 	return length - info.destination.size_bytes();
 }
@@ -170,6 +376,10 @@ uint64_t Sqex::Sqpack::EntryRawStream::TextureStreamDecoder::ReadStreamPartial(u
 		.readBuffer = std::vector<uint8_t>(MaxBlockSize),
 		.relativeOffset = offset,
 	};
+	std::vector<DeferredBlock> deferred;
+	if (ParallelDecompression() && length >= ParallelDecompressionMinLength)
+		info.deferred = &deferred;
+	info.UseBlockCache(Underlying());
 
 	if (info.relativeOffset < Head.size()) {
 		const auto available = std::min(info.destination.size_bytes(), static_cast<size_t>(Head.size() - info.relativeOffset));
@@ -218,6 +428,7 @@ uint64_t Sqex::Sqpack::EntryRawStream::TextureStreamDecoder::ReadStreamPartial(u
 			break;
 	}
 
+	info.FlushDeferred();
 	MaxBlockSize = info.readBuffer.size();
 	return length - info.destination.size_bytes();
 }
@@ -310,6 +521,10 @@ uint64_t Sqex::Sqpack::EntryRawStream::ModelStreamDecoder::ReadStreamPartial(uin
 		.readBuffer = std::vector<uint8_t>(MaxBlockSize),
 		.relativeOffset = offset,
 	};
+	std::vector<DeferredBlock> deferred;
+	if (ParallelDecompression() && length >= ParallelDecompressionMinLength)
+		info.deferred = &deferred;
+	info.UseBlockCache(Underlying());
 
 	if (info.relativeOffset < Head.size()) {
 		const auto available = std::min(info.destination.size_bytes(), static_cast<size_t>(Head.size() - info.relativeOffset));
@@ -338,21 +553,24 @@ uint64_t Sqex::Sqpack::EntryRawStream::ModelStreamDecoder::ReadStreamPartial(uin
 			break;
 	}
 
+	info.FlushDeferred();
 	MaxBlockSize = info.readBuffer.size();
 	return length - info.destination.size_bytes();
 }
 
-Sqex::Sqpack::EntryRawStream::EntryRawStream(const EntryProvider* provider)
+Sqex::Sqpack::EntryRawStream::EntryRawStream(const EntryProvider* provider, bool parallelDecompression)
 	: m_provider(provider)
+	, m_parallelDecompression(parallelDecompression)
 	, m_entryHeader(m_provider->ReadStream<SqData::FileEntryHeader>(0))
 	, m_decoder(
 		m_entryHeader.Type == SqData::FileEntryType::Empty || m_entryHeader.DecompressedSize == 0 ? nullptr : m_entryHeader.Type == SqData::FileEntryType::Binary ? static_cast<std::unique_ptr<StreamDecoder>>(std::make_unique<BinaryStreamDecoder>(this)) : m_entryHeader.Type == SqData::FileEntryType::Texture ? static_cast<std::unique_ptr<StreamDecoder>>(std::make_unique<TextureStreamDecoder>(this)) : m_entryHeader.Type == SqData::FileEntryType::Model ? static_cast<std::unique_ptr<StreamDecoder>>(std::make_unique<ModelStreamDecoder>(this)) : nullptr
 	) {
 }
 
-Sqex::Sqpack::EntryRawStream::EntryRawStream(std::shared_ptr<const EntryProvider> provider)
+Sqex::Sqpack::EntryRawStream::EntryRawStream(std::shared_ptr<const EntryProvider> provider, bool parallelDecompression)
 	: m_providerShared(std::move(provider))
 	, m_provider(m_providerShared.get())
+	, m_parallelDecompression(parallelDecompression)
 	, m_entryHeader(m_provider->ReadStream<SqData::FileEntryHeader>(0))
 	, m_decoder(
 		m_entryHeader.Type == SqData::FileEntryType::Empty || m_entryHeader.DecompressedSize == 0 ? nullptr : m_entryHeader.Type == SqData::FileEntryType::Binary ? static_cast<std::unique_ptr<StreamDecoder>>(std::make_unique<BinaryStreamDecoder>(this)) : m_entryHeader.Type == SqData::FileEntryType::Texture ? static_cast<std::unique_ptr<StreamDecoder>>(std::make_unique<TextureStreamDecoder>(this)) : m_entryHeader.Type == SqData::FileEntryType::Model ? static_cast<std::unique_ptr<StreamDecoder>>(std::make_unique<ModelStreamDecoder>(this)) : nullptr
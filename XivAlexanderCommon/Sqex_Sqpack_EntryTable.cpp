@@ -0,0 +1,238 @@
+#include "pch.h"
+#include "Sqex_Sqpack_EntryTable.h"
+
+Sqex::Sqpack::PathArena::PathArena() = default;
+
+Sqex::Sqpack::PathArena::PathArena(PathArena&& r) noexcept
+	: m_chunks(std::move(r.m_chunks))
+	, m_chunkUsed(std::exchange(r.m_chunkUsed, ChunkSize))
+	, m_chunkBytes(std::exchange(r.m_chunkBytes, 0))
+	, m_paths(std::move(r.m_paths))
+	, m_slots(std::move(r.m_slots))
+	, m_mask(std::exchange(r.m_mask, 0)) {
+}
+
+Sqex::Sqpack::PathArena& Sqex::Sqpack::PathArena::operator=(PathArena&& r) noexcept {
+	m_chunks = std::move(r.m_chunks);
+	m_chunkUsed = std::exchange(r.m_chunkUsed, ChunkSize);
+	m_chunkBytes = std::exchange(r.m_chunkBytes, 0);
+	m_paths = std::move(r.m_paths);
+	m_slots = std::move(r.m_slots);
+	m_mask = std::exchange(r.m_mask, 0);
+	return *this;
+}
+
+Sqex::Sqpack::PathArena::~PathArena() = default;
+
+std::string Sqex::Sqpack::PathArena::Normalize(const EntryPathSpec& pathSpec) {
+	// Same normalization as SqexHash, so that paths that hash the same get the same id.
+	auto s = pathSpec.NativeRepresentation();
+	for (auto& c : s)
+		if ('A' <= c && c <= 'Z')
+			c += 'a' - 'A';
+	return s;
+}
+
+size_t Sqex::Sqpack::PathArena::FindSlot(std::string_view normalizedPath) const {
+	for (auto i = std::hash<std::string_view>()(normalizedPath) & m_mask; ; i = (i + 1) & m_mask) {
+		const auto id = m_slots[i];
+		if (id == NoPath || m_paths[id - 1] == normalizedPath)
+			return i;
+	}
+}
+
+Sqex::Sqpack::PathArena::Id Sqex::Sqpack::PathArena::Intern(const EntryPathSpec& pathSpec) {
+	if (!pathSpec.HasOriginal())
+		return NoPath;
+
+	const auto path = Normalize(pathSpec);
+
+	if ((m_paths.size() + 1) * 2 > m_slots.size()) {
+		m_slots.assign(std::max<size_t>(16, m_slots.size() * 2), NoPath);
+		m_mask = m_slots.size() - 1;
+		for (size_t i = 0; i < m_paths.size(); ++i)
+			m_slots[FindSlot(m_paths[i])] = static_cast<Id>(i + 1);
+	}
+
+	const auto slot = FindSlot(path);
+	if (m_slots[slot] != NoPath)
+		return m_slots[slot];
+
+	if (m_paths.size() >= UINT32_MAX - 1)
+		throw std::length_error("too many paths");
+
+	if (path.size() > ChunkSize - m_chunkUsed) {
+		const auto size = std::max(ChunkSize, path.size());
+		m_chunks.emplace_back(std::make_unique<char[]>(size));
+		m_chunkBytes += size;
+		m_chunkUsed = 0;
+	}
+	const auto ptr = m_chunks.back().get() + m_chunkUsed;
+	std::copy_n(path.begin(), path.size(), ptr);
+
+	// A path longer than ChunkSize gets a chunk of its own, which is full once it is in.
+	m_chunkUsed = std::min(ChunkSize, m_chunkUsed + path.size());
+
+	m_paths.emplace_back(ptr, path.size());
+	m_slots[slot] = static_cast<Id>(m_paths.size());
+	return m_slots[slot];
+}
+
+Sqex::Sqpack::PathArena::Id Sqex::Sqpack::PathArena::Find(const EntryPathSpec& pathSpec) const {
+	if (!pathSpec.HasOriginal() || m_paths.empty())
+		return NoPath;
+	return m_slots[FindSlot(Normalize(pathSpec))];
+}
+
+size_t Sqex::Sqpack::PathArena::ByteCount() const {
+	return m_chunkBytes
+		+ m_chunks.capacity() * sizeof m_chunks[0]
+		+ m_paths.capacity() * sizeof m_paths[0]
+		+ m_slots.capacity() * sizeof m_slots[0];
+}
+
+Sqex::Sqpack::EntryKeyTable::EntryKeyTable() = default;
+
+Sqex::Sqpack::EntryKeyTable::EntryKeyTable(EntryKeyTable&&) noexcept = default;
+
+Sqex::Sqpack::EntryKeyTable& Sqex::Sqpack::EntryKeyTable::operator=(EntryKeyTable&&) noexcept = default;
+
+Sqex::Sqpack::EntryKeyTable::~EntryKeyTable() = default;
+
+size_t Sqex::Sqpack::EntryKeyTable::Hash(const Key& key) {
+	// Same mixing as Reader::LocatorLookupTable, with FullPathHash folded in.
+	auto k = (static_cast<uint64_t>(key.PathHash) << 32 | key.NameHash) ^ (static_cast<uint64_t>(key.FullPathHash) * 0x9e3779b97f4a7c15ULL);
+	k ^= k >> 31;
+	k *= 0x7fb5d329728ea185ULL;
+	k ^= k >> 27;
+	return static_cast<size_t>(k);
+}
+
+void Sqex::Sqpack::EntryKeyTable::InsertHashSlot(size_t index) {
+	for (auto i = Hash(m_keys[index]) & m_mask; ; i = (i + 1) & m_mask) {
+		if (!m_hashSlots[i]) {
+			m_hashSlots[i] = static_cast<uint32_t>(index + 1);
+			m_hashSlotUsed++;
+			return;
+		}
+	}
+}
+
+void Sqex::Sqpack::EntryKeyTable::RebuildHashSlots() {
+	const auto hashOnlyCount = static_cast<size_t>(std::ranges::count(m_keys, PathArena::NoPath, &Key::PathId));
+
+	size_t capacity = 16;
+	while (capacity < hashOnlyCount * 2 + 2)
+		capacity <<= 1;
+	m_hashSlots.assign(capacity, 0);
+	m_hashSlotUsed = 0;
+	m_mask = capacity - 1;
+	for (size_t i = 0; i < m_keys.size(); ++i)
+		if (m_keys[i].PathId == PathArena::NoPath)
+			InsertHashSlot(i);
+}
+
+size_t Sqex::Sqpack::EntryKeyTable::InsertKey(const EntryPathSpec& pathSpec) {
+	if (m_keys.size() >= UINT32_MAX - 1)
+		throw std::length_error("too many entries");
+
+	const auto index = m_keys.size();
+	const auto pathId = m_arena.Intern(pathSpec);
+	m_keys.emplace_back(Key{pathSpec.PathHash, pathSpec.NameHash, pathSpec.FullPathHash, pathId});
+
+	if (pathId != PathArena::NoPath) {
+		if (m_pathIndex.size() < pathId)
+			m_pathIndex.resize(pathId, 0);
+		if (!m_pathIndex[pathId - 1])
+			m_pathIndex[pathId - 1] = static_cast<uint32_t>(index + 1);
+	} else if ((m_hashSlotUsed + 1) * 2 > m_hashSlots.size())
+		RebuildHashSlots();
+	else
+		InsertHashSlot(index);
+
+	return index;
+}
+
+void Sqex::Sqpack::EntryKeyTable::ReserveKeys(size_t count) {
+	m_keys.reserve(count);
+}
+
+void Sqex::Sqpack::EntryKeyTable::ReorderKeys(std::span<const uint32_t> order) {
+	std::vector<Key> keys;
+	keys.reserve(m_keys.size());
+	for (const auto i : order)
+		keys.emplace_back(m_keys[i]);
+	m_keys = std::move(keys);
+
+	// Entries sharing a path are possible if one got its path later; keep the one that has been found by the path.
+	std::vector<uint32_t> newIndices(order.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		newIndices[order[i]] = static_cast<uint32_t>(i);
+	for (auto& index : m_pathIndex)
+		if (index)
+			index = newIndices[index - 1] + 1;
+
+	RebuildHashSlots();
+}
+
+std::vector<uint32_t> Sqex::Sqpack::EntryKeyTable::SortedOrder() const {
+	std::vector<uint32_t> order(m_keys.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::ranges::sort(order, [this](uint32_t li, uint32_t ri) {
+		const auto& l = m_keys[li];
+		const auto& r = m_keys[ri];
+		if ((l.PathId == PathArena::NoPath) != (r.PathId == PathArena::NoPath))
+			return l.PathId == PathArena::NoPath;
+		if (l.PathId != PathArena::NoPath)
+			return m_arena[l.PathId] < m_arena[r.PathId];
+		if (l.FullPathHash != r.FullPathHash)
+			return l.FullPathHash < r.FullPathHash;
+		if (l.PathHash != r.PathHash)
+			return l.PathHash < r.PathHash;
+		return l.NameHash < r.NameHash;
+	});
+	return order;
+}
+
+size_t Sqex::Sqpack::EntryKeyTable::FindIndex(const EntryPathSpec& pathSpec) const {
+	if (!m_hashSlots.empty()) {
+		const auto key = Key{pathSpec.PathHash, pathSpec.NameHash, pathSpec.FullPathHash, PathArena::NoPath};
+		for (auto i = Hash(key) & m_mask; m_hashSlots[i]; i = (i + 1) & m_mask) {
+			const auto& k = m_keys[m_hashSlots[i] - 1];
+			if (k.PathId == PathArena::NoPath && k.FullPathHash == key.FullPathHash && k.PathHash == key.PathHash && k.NameHash == key.NameHash)
+				return m_hashSlots[i] - 1;
+		}
+	}
+
+	if (const auto pathId = m_arena.Find(pathSpec); pathId != PathArena::NoPath && m_pathIndex[pathId - 1])
+		return m_pathIndex[pathId - 1] - 1;
+
+	return NotFound;
+}
+
+void Sqex::Sqpack::EntryKeyTable::SetPath(size_t index, const EntryPathSpec& pathSpec) {
+	auto& key = m_keys[index];
+	if (key.PathId != PathArena::NoPath)
+		return;
+
+	// The hash slot stays, but lookups skip it from now on as the key is no longer without a path.
+	key.PathId = m_arena.Intern(pathSpec);
+	if (key.PathId == PathArena::NoPath)
+		return;
+	if (m_pathIndex.size() < key.PathId)
+		m_pathIndex.resize(key.PathId, 0);
+	if (!m_pathIndex[key.PathId - 1])
+		m_pathIndex[key.PathId - 1] = static_cast<uint32_t>(index + 1);
+}
+
+std::string_view Sqex::Sqpack::EntryKeyTable::PathAt(size_t index) const {
+	const auto id = m_keys[index].PathId;
+	return id == PathArena::NoPath ? std::string_view() : m_arena[id];
+}
+
+size_t Sqex::Sqpack::EntryKeyTable::ByteCount() const {
+	return m_arena.ByteCount()
+		+ m_keys.capacity() * sizeof m_keys[0]
+		+ m_pathIndex.capacity() * sizeof m_pathIndex[0]
+		+ m_hashSlots.capacity() * sizeof m_hashSlots[0];
+}
@@ -3,9 +3,64 @@
 
 #include "Sqex_Sqpack_EntryRawStream.h"
 
+static Utils::Win32::FileMapping::View MapIndexFileView(const Utils::Win32::Handle& hFile) {
+	if (!hFile.GetFileSize())
+		return Utils::Win32::FileMapping::View(nullptr);  // CreateFileMapping fails on empty files
+
+	try {
+		const auto mapping = Utils::Win32::FileMapping::Create(hFile);
+		// The view keeps a reference to the mapping object, so the mapping handle itself can be closed now.
+		return Utils::Win32::FileMapping::View::Create(mapping);
+	} catch (const Utils::Win32::Error&) {
+		return Utils::Win32::FileMapping::View(nullptr);
+	}
+}
+
+Sqex::Sqpack::Reader::LocatorLookupTable::LocatorLookupTable(size_t count) {
+	size_t capacity = 16;
+	while (capacity < count * 2)
+		capacity <<= 1;
+	m_slots.resize(capacity, Slot{0, nullptr});
+	m_mask = capacity - 1;
+}
+
+size_t Sqex::Sqpack::Reader::LocatorLookupTable::Hash(uint64_t key) {
+	// Hash values are CRC32 based, but (PathHash, NameHash) pairs share upper bits within a folder; mix them together.
+	key ^= key >> 31;
+	key *= 0x7fb5d329728ea185ULL;
+	key ^= key >> 27;
+	return static_cast<size_t>(key);
+}
+
+void Sqex::Sqpack::Reader::LocatorLookupTable::Insert(uint64_t key, const SqIndex::LEDataLocator& locator) {
+	for (auto i = Hash(key) & m_mask; ; i = (i + 1) & m_mask) {
+		auto& slot = m_slots[i];
+		if (!slot.Locator) {
+			slot = {key, &locator};
+			return;
+		}
+		if (slot.Key == key)
+			return;  // keep the first one, as lower_bound would do
+	}
+}
+
+const Sqex::Sqpack::SqIndex::LEDataLocator* Sqex::Sqpack::Reader::LocatorLookupTable::Find(uint64_t key) const {
+	for (auto i = Hash(key) & m_mask; ; i = (i + 1) & m_mask) {
+		const auto& slot = m_slots[i];
+		if (!slot.Locator)
+			return nullptr;
+		if (slot.Key == key)
+			return slot.Locator;
+	}
+}
+
 template<typename HashLocatorT, typename TextLocatorT>
-Sqex::Sqpack::Reader::SqIndexType<HashLocatorT, TextLocatorT>::SqIndexType(const Win32::Handle& hFile, bool strictVerify)
-	: Data(hFile.Read<uint8_t>(0, static_cast<size_t>(hFile.GetFileSize())))
+Sqex::Sqpack::Reader::SqIndexType<HashLocatorT, TextLocatorT>::SqIndexType(const Win32::Handle& hFile, bool strictVerify, bool memoryMapped)
+	: DataView(memoryMapped ? MapIndexFileView(hFile) : Win32::FileMapping::View(nullptr))
+	, DataBuffer(DataView ? std::vector<uint8_t>() : hFile.Read<uint8_t>(0, static_cast<size_t>(hFile.GetFileSize())))
+	, Data(DataView
+		? std::span(static_cast<const uint8_t*>(*DataView), static_cast<size_t>(hFile.GetFileSize()))
+		: std::span(DataBuffer))
 	, Header(*reinterpret_cast<const SqpackHeader*>(&Data[0]))
 	, IndexHeader(*reinterpret_cast<const SqIndex::Header*>(&Data[Header.HeaderSize]))
 	, HashLocators(reinterpret_cast<const HashLocatorT*>(&Data[IndexHeader.HashLocatorSegment.Offset]),
@@ -30,10 +85,25 @@ Sqex::Sqpack::Reader::SqIndexType<HashLocatorT, TextLocatorT>::SqIndexType(const
 	}
 }
 
-Sqex::Sqpack::Reader::SqIndex1Type::SqIndex1Type(const Win32::Handle& hFile, bool strictVerify)
-	: SqIndexType<SqIndex::PairHashLocator, SqIndex::PairHashWithTextLocator>(hFile, strictVerify)
+static Sqex::Sqpack::Reader::LocatorLookupTable BuildLookupTable(std::span<const Sqex::Sqpack::SqIndex::PairHashLocator> locators) {
+	Sqex::Sqpack::Reader::LocatorLookupTable res(locators.size());
+	for (const auto& locator : locators)
+		res.Insert((static_cast<uint64_t>(locator.PathHash) << 32) | locator.NameHash, locator.Locator);
+	return res;
+}
+
+static Sqex::Sqpack::Reader::LocatorLookupTable BuildLookupTable(std::span<const Sqex::Sqpack::SqIndex::FullHashLocator> locators) {
+	Sqex::Sqpack::Reader::LocatorLookupTable res(locators.size());
+	for (const auto& locator : locators)
+		res.Insert(locator.FullPathHash, locator.Locator);
+	return res;
+}
+
+Sqex::Sqpack::Reader::SqIndex1Type::SqIndex1Type(const Win32::Handle& hFile, bool strictVerify, bool memoryMapped, bool buildLookupTable)
+	: SqIndexType<SqIndex::PairHashLocator, SqIndex::PairHashWithTextLocator>(hFile, strictVerify, memoryMapped)
 	, PathHashLocators(reinterpret_cast<const SqIndex::PathHashLocator*>(&Data[IndexHeader.PathHashLocatorSegment.Offset]),
-		IndexHeader.PathHashLocatorSegment.Size / sizeof SqIndex::PathHashLocator) {
+		IndexHeader.PathHashLocatorSegment.Size / sizeof SqIndex::PathHashLocator)
+	, LookupTable(buildLookupTable ? BuildLookupTable(HashLocators) : LocatorLookupTable()) {
 	if (strictVerify) {
 		if (IndexHeader.PathHashLocatorSegment.Size % sizeof SqIndex::PathHashLocator)
 			throw CorruptDataException("PathHashLocators has an invalid size alignment");
@@ -53,6 +123,12 @@ std::span<const Sqex::Sqpack::SqIndex::PairHashLocator> Sqex::Sqpack::Reader::Sq
 }
 
 const Sqex::Sqpack::SqIndex::LEDataLocator& Sqex::Sqpack::Reader::SqIndex1Type::GetLocator(uint32_t pathHash, uint32_t nameHash) const {
+	if (!LookupTable.Empty()) {
+		if (const auto pLocator = LookupTable.Find((static_cast<uint64_t>(pathHash) << 32) | nameHash))
+			return *pLocator;
+		throw std::out_of_range(std::format("NameHash {:08x} in PathHash {:08x} not found", nameHash, pathHash));
+	}
+
 	const auto locators = GetPairHashLocators(pathHash);
 	const auto it = std::lower_bound(locators.begin(), locators.end(), nameHash, PathSpecComparator());
 	if (it == locators.end() || it->NameHash != nameHash)
@@ -60,11 +136,18 @@ const Sqex::Sqpack::SqIndex::LEDataLocator& Sqex::Sqpack::Reader::SqIndex1Type::
 	return it->Locator;
 }
 
-Sqex::Sqpack::Reader::SqIndex2Type::SqIndex2Type(const Win32::Handle& hFile, bool strictVerify)
-	: SqIndexType<SqIndex::FullHashLocator, SqIndex::FullHashWithTextLocator>(hFile, strictVerify) {
+Sqex::Sqpack::Reader::SqIndex2Type::SqIndex2Type(const Win32::Handle& hFile, bool strictVerify, bool memoryMapped, bool buildLookupTable)
+	: SqIndexType<SqIndex::FullHashLocator, SqIndex::FullHashWithTextLocator>(hFile, strictVerify, memoryMapped)
+	, LookupTable(buildLookupTable ? BuildLookupTable(HashLocators) : LocatorLookupTable()) {
 }
 
 const Sqex::Sqpack::SqIndex::LEDataLocator& Sqex::Sqpack::Reader::SqIndex2Type::GetLocator(uint32_t fullPathHash) const {
+	if (!LookupTable.Empty()) {
+		if (const auto pLocator = LookupTable.Find(fullPathHash))
+			return *pLocator;
+		throw std::out_of_range(std::format("FullPathHash {:08x} not found", fullPathHash));
+	}
+
 	const auto it = std::lower_bound(HashLocators.begin(), HashLocators.end(), fullPathHash, PathSpecComparator());
 	if (it == HashLocators.end() || it->FullPathHash != fullPathHash)
 		throw std::out_of_range(std::format("FullPathHash {:08x} not found", fullPathHash));
@@ -92,31 +175,36 @@ Sqex::Sqpack::Reader::SqDataType::SqDataType(Win32::Handle hFile, const uint32_t
 	}
 }
 
-Sqex::Sqpack::Reader::Reader(const std::filesystem::path& indexFile, bool strictVerify)
-	: Index1(Win32::Handle::FromCreateFile(std::filesystem::path(indexFile).replace_extension(".index"), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN), strictVerify)
-	, Index2(Win32::Handle::FromCreateFile(std::filesystem::path(indexFile).replace_extension(".index2"), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN), strictVerify) {
+namespace {
+	// Orders locators by data file and then by offset, ignoring synonym flag.
+	struct LocatorPositionComparator {
+		bool operator()(const Sqex::Sqpack::SqIndex::LEDataLocator& l, const Sqex::Sqpack::SqIndex::LEDataLocator& r) const {
+			if (l.DatFileIndex != r.DatFileIndex)
+				return l.DatFileIndex < r.DatFileIndex;
+			return l.DatFileOffset() < r.DatFileOffset();
+		}
+	};
+}
 
-	std::vector<std::pair<SqIndex::LEDataLocator, std::tuple<uint32_t, uint32_t, const char*>>> offsets1;
-	offsets1.reserve(
-		std::max(Index1.HashLocators.size() + Index1.TextLocators.size(), Index2.HashLocators.size() + Index2.TextLocators.size())
-		+ Index1.IndexHeader.TextLocatorSegment.Count
-	);
-	for (const auto& item : Index1.HashLocators)
-		if (!item.Locator.IsSynonym)
-			offsets1.emplace_back(item.Locator, std::make_tuple(item.PathHash, item.NameHash, static_cast<const char*>(nullptr)));
-	for (const auto& item : Index1.TextLocators)
-		offsets1.emplace_back(item.Locator, std::make_tuple(item.PathHash, item.NameHash, item.FullPath));
+Sqex::Sqpack::Reader::Reader(const std::filesystem::path& indexFile, bool strictVerify, bool memoryMappedIndex, bool buildLookupTables)
+	: Index1(Win32::Handle::FromCreateFile(std::filesystem::path(indexFile).replace_extension(".index"), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, memoryMappedIndex ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN), strictVerify, memoryMappedIndex, buildLookupTables)
+	, Index2(Win32::Handle::FromCreateFile(std::filesystem::path(indexFile).replace_extension(".index2"), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, memoryMappedIndex ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN), strictVerify, memoryMappedIndex, buildLookupTables) {
 
-	std::vector<std::pair<SqIndex::LEDataLocator, std::tuple<uint32_t, const char*>>> offsets2;
+	size_t entryCount1 = Index1.TextLocators.size(), entryCount2 = Index2.TextLocators.size();
+	for (const auto& item : Index1.HashLocators)
+		entryCount1 += item.Locator.IsSynonym ? 0 : 1;
 	for (const auto& item : Index2.HashLocators)
-		if (!item.Locator.IsSynonym)
-			offsets2.emplace_back(item.Locator, std::make_tuple(item.FullPathHash, static_cast<const char*>(nullptr)));
-	for (const auto& item : Index2.TextLocators)
-		offsets2.emplace_back(item.Locator, std::make_tuple(item.FullPathHash, item.FullPath));
-
-	if (offsets1.size() != offsets2.size())
+		entryCount2 += item.Locator.IsSynonym ? 0 : 1;
+	if (entryCount1 != entryCount2)
 		throw CorruptDataException(".index and .index2 do not have the same number of files contained");
 
+	m_sortedLocators.reserve(entryCount1 + Index1.IndexHeader.TextLocatorSegment.Count);
+	for (const auto& item : Index1.HashLocators)
+		if (!item.Locator.IsSynonym)
+			m_sortedLocators.emplace_back(item.Locator);
+	for (const auto& item : Index1.TextLocators)
+		m_sortedLocators.emplace_back(item.Locator);
+
 	Data.reserve(Index1.IndexHeader.TextLocatorSegment.Count);
 	for (uint32_t i = 0; i < Index1.IndexHeader.TextLocatorSegment.Count; ++i) {
 		Data.emplace_back(SqDataType{
@@ -124,62 +212,83 @@ Sqex::Sqpack::Reader::Reader(const std::filesystem::path& indexFile, bool strict
 			i,
 			strictVerify,
 			});
-		offsets1.emplace_back(SqIndex::LEDataLocator(i, Data[i].Stream->StreamSize()), std::make_tuple(UINT32_MAX, UINT32_MAX, static_cast<const char*>(nullptr)));
-		offsets2.emplace_back(SqIndex::LEDataLocator(i, Data[i].Stream->StreamSize()), std::make_tuple(UINT32_MAX, static_cast<const char*>(nullptr)));
+		m_sortedLocators.emplace_back(i, Data[i].Stream->StreamSize());
 	}
-	
-	struct Comparator {
-		bool operator()(const SqIndex::LEDataLocator& l, const SqIndex::LEDataLocator& r) const {
-			if (l.DatFileIndex != r.DatFileIndex)
-				return l.DatFileIndex < r.DatFileIndex;
-			if (l.DatFileOffset() != r.DatFileOffset())
-				return l.DatFileOffset() < r.DatFileOffset();
-			return false;
-		}
+	std::ranges::sort(m_sortedLocators, LocatorPositionComparator());
 
-		bool operator()(const std::pair<SqIndex::LEDataLocator, std::tuple<uint32_t, uint32_t, const char*>>& l, const std::pair<SqIndex::LEDataLocator, std::tuple<uint32_t, uint32_t, const char*>>& r) const {
-			return (*this)(l.first, r.first);
-		}
+	if (strictVerify) {
+		std::vector<SqIndex::LEDataLocator> locators2;
+		locators2.reserve(m_sortedLocators.size());
+		for (const auto& item : Index2.HashLocators)
+			if (!item.Locator.IsSynonym)
+				locators2.emplace_back(item.Locator);
+		for (const auto& item : Index2.TextLocators)
+			locators2.emplace_back(item.Locator);
+		for (uint32_t i = 0; i < Index1.IndexHeader.TextLocatorSegment.Count; ++i)
+			locators2.emplace_back(i, Data[i].Stream->StreamSize());
+		std::ranges::sort(locators2, LocatorPositionComparator());
 
-		bool operator()(const std::pair<SqIndex::LEDataLocator, std::tuple<uint32_t, const char*>>& l, const std::pair<SqIndex::LEDataLocator, std::tuple<uint32_t, const char*>>& r) const {
-			return (*this)(l.first, r.first);
+		for (size_t i = 0; i < m_sortedLocators.size(); ++i) {
+			if (m_sortedLocators[i] != locators2[i])
+				throw CorruptDataException(".index and .index2 have items with different locators");
+			if (m_sortedLocators[i].IsSynonym)
+				throw CorruptDataException("Synonym remains after conflict resolution");
 		}
+	}
+}
 
-		bool operator()(const std::pair<SqIndex::LEDataLocator, EntryInfoType>& l, const std::pair<SqIndex::LEDataLocator, EntryInfoType>& r) const {
-			return l.first < r.first;
-		}
-	};
+uint64_t Sqex::Sqpack::Reader::GetAllocation(SqIndex::LEDataLocator locator) const {
+	const auto next = std::ranges::upper_bound(m_sortedLocators, locator, LocatorPositionComparator());
+	if (next == m_sortedLocators.end() || next->DatFileIndex != locator.DatFileIndex)
+		throw std::out_of_range(std::format("Locator {:08x} does not point to a position inside a data file", locator.Value));
+	return next->DatFileOffset() - locator.DatFileOffset();
+}
 
-	std::sort(offsets1.begin(), offsets1.end(), Comparator());
-	std::sort(offsets2.begin(), offsets2.end(), Comparator());
-	EntryInfo.reserve(offsets1.size());
+const std::vector<std::pair<Sqex::Sqpack::SqIndex::LEDataLocator, Sqex::Sqpack::Reader::EntryInfoType>>& Sqex::Sqpack::Reader::GetEntryInfo() const {
+	std::call_once(m_entryInfoOnce, [this]() {
+		std::vector<std::pair<SqIndex::LEDataLocator, std::tuple<uint32_t, uint32_t, const char*>>> offsets1;
+		offsets1.reserve(Index1.HashLocators.size() + Index1.TextLocators.size());
+		for (const auto& item : Index1.HashLocators)
+			if (!item.Locator.IsSynonym)
+				offsets1.emplace_back(item.Locator, std::make_tuple(item.PathHash, item.NameHash, static_cast<const char*>(nullptr)));
+		for (const auto& item : Index1.TextLocators)
+			offsets1.emplace_back(item.Locator, std::make_tuple(item.PathHash, item.NameHash, item.FullPath));
 
-	if (strictVerify) {
+		std::vector<std::pair<SqIndex::LEDataLocator, std::tuple<uint32_t, const char*>>> offsets2;
+		offsets2.reserve(offsets1.size());
+		for (const auto& item : Index2.HashLocators)
+			if (!item.Locator.IsSynonym)
+				offsets2.emplace_back(item.Locator, std::make_tuple(item.FullPathHash, static_cast<const char*>(nullptr)));
+		for (const auto& item : Index2.TextLocators)
+			offsets2.emplace_back(item.Locator, std::make_tuple(item.FullPathHash, item.FullPath));
+
+		std::ranges::sort(offsets1, LocatorPositionComparator(), [](const auto& item) -> const SqIndex::LEDataLocator& { return item.first; });
+		std::ranges::sort(offsets2, LocatorPositionComparator(), [](const auto& item) -> const SqIndex::LEDataLocator& { return item.first; });
+
+		m_entryInfo.reserve(offsets1.size());
 		for (size_t i = 0; i < offsets1.size(); ++i) {
-			if (offsets1[i].first != offsets2[i].first)
-				throw CorruptDataException(".index and .index2 have items with different locators");
-			if (offsets1[i].first.IsSynonym)
-				throw CorruptDataException("Synonym remains after conflict resolution");
+			const auto pathHash = std::get<0>(offsets1[i].second);
+			const auto nameHash = std::get<1>(offsets1[i].second);
+			const auto fullPathHash = std::get<0>(offsets2[i].second);
+			const auto fullPath = std::get<2>(offsets1[i].second) ? std::get<2>(offsets1[i].second) : std::get<1>(offsets2[i].second);
+			m_entryInfo.emplace_back(offsets1[i].first, EntryInfoType{
+				.PathHash = pathHash,
+				.NameHash = nameHash,
+				.FullPathHash = fullPathHash,
+				.PathId = fullPath ? m_entryPaths.Intern(EntryPathSpec(pathHash, nameHash, fullPathHash, std::string(fullPath))) : PathArena::NoPath,
+				.Allocation = GetAllocation(offsets1[i].first),
+				});
 		}
-	}
 
-	for (size_t curr = 1, prev = 0; curr < offsets1.size(); ++curr, ++prev) {
-		if (offsets1[prev].first.DatFileIndex != offsets1[curr].first.DatFileIndex)
-			continue;
-		EntryInfo.emplace_back(offsets1[prev].first, EntryInfoType{
-			.PathSpec = EntryPathSpec(
-				std::get<0>(offsets1[prev].second),
-				std::get<1>(offsets1[prev].second),
-				std::get<0>(offsets2[prev].second),
-				std::get<2>(offsets1[prev].second) ? std::string(std::get<2>(offsets1[prev].second)) :
-					std::get<1>(offsets2[prev].second) ? std::string(std::get<1>(offsets2[prev].second)) :
-						std::string()
-			),
-			.Allocation = offsets1[curr].first.DatFileOffset() - offsets1[prev].first.DatFileOffset(),
-			});
-	}
+		std::ranges::sort(m_entryInfo, [](const auto& l, const auto& r) { return l.first < r.first; });
+	});
+	return m_entryInfo;
+}
 
-	std::sort(EntryInfo.begin(), EntryInfo.end(), Comparator());
+Sqex::Sqpack::EntryPathSpec Sqex::Sqpack::Reader::PathSpecOf(const EntryInfoType& entryInfo) const {
+	if (entryInfo.PathId == PathArena::NoPath)
+		return {entryInfo.PathHash, entryInfo.NameHash, entryInfo.FullPathHash};
+	return {entryInfo.PathHash, entryInfo.NameHash, entryInfo.FullPathHash, std::string(m_entryPaths[entryInfo.PathId])};
 }
 
 const Sqex::Sqpack::SqIndex::LEDataLocator& Sqex::Sqpack::Reader::GetLocator(const EntryPathSpec& pathSpec) const {
@@ -207,19 +316,8 @@ std::shared_ptr<Sqex::Sqpack::EntryProvider> Sqex::Sqpack::Reader::GetEntryProvi
 }
 
 std::shared_ptr<Sqex::Sqpack::EntryProvider> Sqex::Sqpack::Reader::GetEntryProvider(const EntryPathSpec& pathSpec) const {
-	struct Comparator {
-		bool operator()(const std::pair<SqIndex::LEDataLocator, EntryInfoType>& l, const SqIndex::LEDataLocator& r) const {
-			return l.first < r;
-		}
-
-		bool operator()(const SqIndex::LEDataLocator& l, const std::pair<SqIndex::LEDataLocator, EntryInfoType>& r) const {
-			return l < r.first;
-		}
-	};
-
 	const auto& locator = GetLocator(pathSpec);
-	const auto entryInfo = std::lower_bound(EntryInfo.begin(), EntryInfo.end(), locator, Comparator());
-	return GetEntryProvider(pathSpec, locator, entryInfo->second.Allocation);
+	return GetEntryProvider(pathSpec, locator, GetAllocation(locator));
 }
 
 std::shared_ptr<Sqex::RandomAccessStream> Sqex::Sqpack::Reader::GetFile(const EntryPathSpec& pathSpec) const {
@@ -78,11 +78,11 @@ size_t Sqex::Texture::RawDataLength(Format type, size_t width, size_t height) {
 			return width * height * sizeof RGBAHHHH;
 
 		case Format::DXT1:
-			return width * height * 8;
+			return (width + 3) / 4 * ((height + 3) / 4) * 8;
 
 		case Format::DXT3:
 		case Format::DXT5:
-			return width * height * 16;
+			return (width + 3) / 4 * ((height + 3) / 4) * 16;
 
 		case Format::Unknown:
 		default:
@@ -0,0 +1,397 @@
+#include "pch.h"
+#include "Sqex_Texture.h"
+
+#include <immintrin.h>
+#include <intrin.h>
+
+namespace {
+	// Arithmetic below is kept identical to the per-pixel conversions in RGBA8888, so that results are bit-exact.
+	// Kernels use SSE2 only, which every supported CPU has; F16C is used for half floats when available.
+
+	bool HasF16C() {
+		static const auto available = []() {
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 1)
+				return false;
+
+			__cpuid(info, 1);
+			const auto osxsave = (info[2] & (1 << 27)) != 0;
+			const auto avx = (info[2] & (1 << 28)) != 0;
+			const auto f16c = (info[2] & (1 << 29)) != 0;
+			return osxsave && avx && f16c && (_xgetbv(0) & 6) == 6;
+		}();
+		return available;
+	}
+
+	void ConvertL8(const uint8_t* source, uint32_t* target, size_t count) {
+		size_t i = 0;
+		const auto opaque = _mm_set1_epi8(static_cast<char>(0xFF));
+		for (; i + 16 <= count; i += 16) {
+			const auto l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+			const auto ll = _mm_unpacklo_epi8(l, l);
+			const auto la = _mm_unpacklo_epi8(l, opaque);
+			const auto hh = _mm_unpackhi_epi8(l, l);
+			const auto ha = _mm_unpackhi_epi8(l, opaque);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i + 0]), _mm_unpacklo_epi16(ll, la));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i + 4]), _mm_unpackhi_epi16(ll, la));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i + 8]), _mm_unpacklo_epi16(hh, ha));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i + 12]), _mm_unpackhi_epi16(hh, ha));
+		}
+		for (; i < count; ++i)
+			target[i] = source[i] * 0x10101UL | 0xFF000000UL;
+	}
+
+	void ConvertRGBA4444(const uint8_t* source, uint32_t* target, size_t count) {
+		size_t i = 0;
+		const auto lowNibbles = _mm_set1_epi8(0x0F);
+		for (; i + 8 <= count; i += 8) {
+			const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i * 2]));
+			const auto lo = _mm_and_si128(v, lowNibbles);
+			const auto hi = _mm_and_si128(_mm_srli_epi16(v, 4), lowNibbles);
+
+			// Each byte holds a nibble, so multiplying by 17 is the same as copying it into the upper half of the byte.
+			auto rgba = _mm_unpacklo_epi8(lo, hi);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i + 0]), _mm_or_si128(rgba, _mm_slli_epi16(rgba, 4)));
+			rgba = _mm_unpackhi_epi8(lo, hi);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i + 4]), _mm_or_si128(rgba, _mm_slli_epi16(rgba, 4)));
+		}
+		for (const auto view = reinterpret_cast<const Sqex::Texture::RGBA4444*>(source); i < count; ++i)
+			target[i] = Sqex::Texture::RGBA8888(view[i].R * 17, view[i].G * 17, view[i].B * 17, view[i].A * 17).Value;
+	}
+
+	void ConvertRGBA5551(const uint8_t* source, uint32_t* target, size_t count) {
+		size_t i = 0;
+		const auto mask5 = _mm_set1_epi16(31);
+		const auto mul255 = _mm_set1_epi16(255);
+		// floor(x / 31) == mulhi(x, ceil(2^20 / 31)) >> 4 for every x <= 31 * 255.
+		const auto div31 = _mm_set1_epi16(static_cast<short>(33826));
+		const auto scale = [&](__m128i v) {
+			return _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(_mm_and_si128(v, mask5), mul255), div31), 4);
+		};
+		for (; i + 8 <= count; i += 8) {
+			const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i * 2]));
+			const auto r = scale(v);
+			const auto g = scale(_mm_srli_epi16(v, 5));
+			const auto b = scale(_mm_srli_epi16(v, 10));
+			const auto a = _mm_mullo_epi16(_mm_srli_epi16(v, 15), mul255);
+			const auto rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+			const auto ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i + 0]), _mm_unpacklo_epi16(rg, ba));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i + 4]), _mm_unpackhi_epi16(rg, ba));
+		}
+		for (const auto view = reinterpret_cast<const Sqex::Texture::RGBA5551*>(source); i < count; ++i)
+			target[i] = Sqex::Texture::RGBA8888(view[i].R * 255 / 31, view[i].G * 255 / 31, view[i].B * 255 / 31, view[i].A * 255).Value;
+	}
+
+	// Same as RGBAHHHH::Half::operator float, on 4 halves zero-extended into 32-bit lanes.
+	__m128 HalfToFloatSse2(__m128i h) {
+		const auto expMant = _mm_and_si128(h, _mm_set1_epi32(0x7FFF));
+		const auto sign = _mm_slli_epi32(_mm_xor_si128(h, expMant), 16);
+		const auto scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+		const auto infNan = _mm_and_si128(_mm_cmpgt_epi32(expMant, _mm_set1_epi32(0x7BFF)), _mm_set1_epi32(0xFF << 23));
+		return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infNan)));
+	}
+
+	// Same as RGBA8888::SetFromF, for 2 pixels.
+	__m128i FloatsToRGBA8888(__m128 p0, __m128 p1) {
+		const auto zero = _mm_setzero_ps();
+		const auto max = _mm_set1_ps(255.f);
+		const auto q0 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(p0, max), zero), max));
+		const auto q1 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(p1, max), zero), max));
+		return _mm_packus_epi16(_mm_packs_epi32(q0, q1), _mm_setzero_si128());
+	}
+
+	template<bool UseF16C>
+	void ConvertRGBAF(const uint8_t* source, uint32_t* target, size_t count) {
+		size_t i = 0;
+		for (; i + 2 <= count; i += 2) {
+			const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i * 8]));
+			__m128 p0, p1;
+			if constexpr (UseF16C) {
+				p0 = _mm_cvtph_ps(v);
+				p1 = _mm_cvtph_ps(_mm_srli_si128(v, 8));
+			} else {
+				p0 = HalfToFloatSse2(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+				p1 = HalfToFloatSse2(_mm_unpackhi_epi16(v, _mm_setzero_si128()));
+			}
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&target[i]), FloatsToRGBA8888(p0, p1));
+		}
+		for (const auto view = reinterpret_cast<const Sqex::Texture::RGBAHHHH*>(source); i < count; ++i) {
+			Sqex::Texture::RGBA8888 pixel;
+			pixel.SetFromF(view[i]);
+			target[i] = pixel.Value;
+		}
+	}
+
+	// Conversions from RGBA8888 round to the nearest representable value.
+
+	// Same as (v * max + 127) / 255 for each 16-bit lane holding a channel.
+	__m128i ScaleChannels(__m128i v, __m128i max) {
+		const auto t = _mm_add_epi16(_mm_mullo_epi16(v, max), _mm_set1_epi16(127));
+		// floor(t / 255) == (t + 1 + (t >> 8)) >> 8 for every t below 65535.
+		return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, _mm_set1_epi16(1)), _mm_srli_epi16(t, 8)), 8);
+	}
+
+	// Adds the two 32-bit lanes of each pixel, for the 2 pixels of lo and the 2 pixels of hi.
+	__m128i AddPixelLanePairs(__m128i lo, __m128i hi) {
+		return _mm_add_epi32(
+			_mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0))),
+			_mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1))));
+	}
+
+	// Luma with BT.601 weights; images converted from L8 have identical channels, which map back to the same value.
+	uint8_t PixelToL8(uint32_t p) {
+		return static_cast<uint8_t>(((p & 0xFF) * 77 + (p >> 8 & 0xFF) * 150 + (p >> 16 & 0xFF) * 29 + 128) >> 8);
+	}
+
+	void ConvertToL8(const uint32_t* source, uint8_t* target, size_t count) {
+		size_t i = 0;
+		const auto zero = _mm_setzero_si128();
+		const auto weights = _mm_setr_epi16(77, 150, 29, 0, 77, 150, 29, 0);
+		const auto half = _mm_set1_epi32(128);
+		const auto luma4 = [&](size_t offset) {
+			const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[offset]));
+			const auto sum = AddPixelLanePairs(_mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights), _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights));
+			return _mm_srli_epi32(_mm_add_epi32(sum, half), 8);
+		};
+		for (; i + 16 <= count; i += 16) {
+			const auto l01 = _mm_packs_epi32(luma4(i), luma4(i + 4));
+			const auto l23 = _mm_packs_epi32(luma4(i + 8), luma4(i + 12));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i]), _mm_packus_epi16(l01, l23));
+		}
+		for (; i < count; ++i)
+			target[i] = PixelToL8(source[i]);
+	}
+
+	void ConvertToRGBA4444(const uint32_t* source, uint8_t* target, size_t count) {
+		size_t i = 0;
+		const auto zero = _mm_setzero_si128();
+		const auto max = _mm_set1_epi16(15);
+		const auto lowNibble = _mm_set1_epi32(0x0F);
+		const auto highNibble = _mm_set1_epi32(0xF0);
+		// Each 32-bit lane holds 2 scaled channels; combine them into the byte they share.
+		const auto combine = [&](__m128i v) {
+			return _mm_or_si128(_mm_and_si128(v, lowNibble), _mm_and_si128(_mm_srli_epi32(v, 12), highNibble));
+		};
+		for (; i + 8 <= count; i += 8) {
+			const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+			const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i + 4]));
+			const auto ab01 = _mm_packs_epi32(combine(ScaleChannels(_mm_unpacklo_epi8(a, zero), max)), combine(ScaleChannels(_mm_unpackhi_epi8(a, zero), max)));
+			const auto ab23 = _mm_packs_epi32(combine(ScaleChannels(_mm_unpacklo_epi8(b, zero), max)), combine(ScaleChannels(_mm_unpackhi_epi8(b, zero), max)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 2]), _mm_packus_epi16(ab01, ab23));
+		}
+		for (const auto view = reinterpret_cast<Sqex::Texture::RGBA4444*>(target); i < count; ++i) {
+			const Sqex::Texture::RGBA8888 p(source[i]);
+			view[i].SetFrom((p.R * 15 + 127) / 255, (p.G * 15 + 127) / 255, (p.B * 15 + 127) / 255, (p.A * 15 + 127) / 255);
+		}
+	}
+
+	void ConvertToRGBA5551(const uint32_t* source, uint8_t* target, size_t count) {
+		size_t i = 0;
+		const auto zero = _mm_setzero_si128();
+		const auto max = _mm_set1_epi16(31);
+		const auto alphaLanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+		// Alpha goes into the sign bit; only the low 16 bits of each sum are used.
+		const auto shifts = _mm_setr_epi16(1, 32, 1024, -32768, 1, 32, 1024, -32768);
+		const auto pack2 = [&](__m128i v) {
+			const auto scaled = ScaleChannels(v, max);
+			const auto alpha = _mm_srli_epi16(v, 7);
+			return _mm_madd_epi16(_mm_or_si128(_mm_andnot_si128(alphaLanes, scaled), _mm_and_si128(alphaLanes, alpha)), shifts);
+		};
+		for (; i + 8 <= count; i += 8) {
+			const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+			const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i + 4]));
+			// Sign extending the low 16 bits keeps them intact through the saturating pack.
+			const auto pa = _mm_srai_epi32(_mm_slli_epi32(AddPixelLanePairs(pack2(_mm_unpacklo_epi8(a, zero)), pack2(_mm_unpackhi_epi8(a, zero))), 16), 16);
+			const auto pb = _mm_srai_epi32(_mm_slli_epi32(AddPixelLanePairs(pack2(_mm_unpacklo_epi8(b, zero)), pack2(_mm_unpackhi_epi8(b, zero))), 16), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 2]), _mm_packs_epi32(pa, pb));
+		}
+		for (const auto view = reinterpret_cast<Sqex::Texture::RGBA5551*>(target); i < count; ++i) {
+			const Sqex::Texture::RGBA8888 p(source[i]);
+			view[i].SetFrom((p.R * 31 + 127) / 255, (p.G * 31 + 127) / 255, (p.B * 31 + 127) / 255, p.A >> 7);
+		}
+	}
+
+	// Rounds to the nearest even half; only handles zero and normal halves, which covers every 8-bit value divided by 255.
+	uint16_t UnitFloatToHalf(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof bits);
+		if (!bits)
+			return 0;
+
+		const auto mantissa = bits & 0x7FFFFF;
+		auto half = ((bits >> 23) - 127 + 15) << 10 | mantissa >> 13;
+		const auto rest = mantissa & 0x1FFF;
+		if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+			++half;
+		return static_cast<uint16_t>(half);
+	}
+
+	template<bool UseF16C>
+	void ConvertToRGBAF(const uint32_t* source, uint8_t* target, size_t count) {
+		size_t i = 0;
+		if constexpr (UseF16C) {
+			const auto zero = _mm_setzero_si128();
+			const auto max = _mm_set1_ps(255.f);
+			for (; i + 2 <= count; i += 2) {
+				const auto v = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&source[i])), zero);
+				const auto p0 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), max);
+				const auto p1 = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), max);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 8]), _mm_unpacklo_epi64(
+					_mm_cvtps_ph(p0, _MM_FROUND_TO_NEAREST_INT),
+					_mm_cvtps_ph(p1, _MM_FROUND_TO_NEAREST_INT)));
+			}
+		}
+		for (; i < count; ++i) {
+			for (size_t c = 0; c < 4; ++c) {
+				const auto half = UnitFloatToHalf(static_cast<float>(source[i] >> (8 * c) & 0xFF) / 255.f);
+				memcpy(&target[i * 8 + c * 2], &half, sizeof half);
+			}
+		}
+	}
+
+	// Packing L8 planes scales channels down rounding towards zero, as font atlases have always been.
+
+	// Same as v * max / 255 for each 16-bit lane holding a channel.
+	__m128i TruncateChannels(__m128i v, __m128i max) {
+		const auto t = _mm_mullo_epi16(v, max);
+		return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, _mm_set1_epi16(1)), _mm_srli_epi16(t, 8)), 8);
+	}
+
+	void InterleaveL8ToRGBA4444(const uint8_t* r, const uint8_t* g, const uint8_t* b, const uint8_t* a, uint8_t* target, size_t count) {
+		size_t i = 0;
+		const auto zero = _mm_setzero_si128();
+		const auto max = _mm_set1_epi16(15);
+		// Each 16-bit lane of the result is a pixel; R and B take the low nibbles of its two bytes.
+		const auto pack8 = [&](__m128i r8, __m128i g8, __m128i b8, __m128i a8) {
+			const auto rb = _mm_or_si128(TruncateChannels(r8, max), _mm_slli_epi16(TruncateChannels(b8, max), 8));
+			const auto ga = _mm_or_si128(TruncateChannels(g8, max), _mm_slli_epi16(TruncateChannels(a8, max), 8));
+			return _mm_or_si128(rb, _mm_slli_epi16(ga, 4));
+		};
+		for (; i + 16 <= count; i += 16) {
+			const auto rv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&r[i]));
+			const auto gv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&g[i]));
+			const auto bv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&b[i]));
+			const auto av = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&a[i]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 2]), pack8(
+				_mm_unpacklo_epi8(rv, zero), _mm_unpacklo_epi8(gv, zero), _mm_unpacklo_epi8(bv, zero), _mm_unpacklo_epi8(av, zero)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 2 + 16]), pack8(
+				_mm_unpackhi_epi8(rv, zero), _mm_unpackhi_epi8(gv, zero), _mm_unpackhi_epi8(bv, zero), _mm_unpackhi_epi8(av, zero)));
+		}
+		for (const auto view = reinterpret_cast<Sqex::Texture::RGBA4444*>(target); i < count; ++i)
+			view[i].SetFrom(r[i] * 15 / 255, g[i] * 15 / 255, b[i] * 15 / 255, a[i] * 15 / 255);
+	}
+
+	void InterleaveL8ToRGBA8888(const uint8_t* r, const uint8_t* g, const uint8_t* b, const uint8_t* a, uint8_t* target, size_t count) {
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			const auto rv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&r[i]));
+			const auto gv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&g[i]));
+			const auto bv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&b[i]));
+			const auto av = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&a[i]));
+			const auto rgLo = _mm_unpacklo_epi8(rv, gv);
+			const auto rgHi = _mm_unpackhi_epi8(rv, gv);
+			const auto baLo = _mm_unpacklo_epi8(bv, av);
+			const auto baHi = _mm_unpackhi_epi8(bv, av);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 4 + 0]), _mm_unpacklo_epi16(rgLo, baLo));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 4 + 16]), _mm_unpackhi_epi16(rgLo, baLo));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 4 + 32]), _mm_unpacklo_epi16(rgHi, baHi));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 4 + 48]), _mm_unpackhi_epi16(rgHi, baHi));
+		}
+		for (const auto view = reinterpret_cast<Sqex::Texture::RGBA8888*>(target); i < count; ++i)
+			view[i].SetFrom(r[i], g[i], b[i], a[i]);
+	}
+}
+
+void Sqex::Texture::ConvertToRGBA8888(Format type, std::span<const uint8_t> source, std::span<RGBA8888> target) {
+	const auto pixelCount = target.size();
+	if (!pixelCount)
+		return;
+	if (source.size_bytes() < RawDataLength(type, pixelCount, 1))
+		throw std::runtime_error("Truncated data detected");
+
+	const auto out = &target[0].Value;
+	switch (type) {
+		case Format::L8_1:
+		case Format::L8_2:
+			return ConvertL8(source.data(), out, pixelCount);
+
+		case Format::RGBA4444:
+			return ConvertRGBA4444(source.data(), out, pixelCount);
+
+		case Format::RGBA5551:
+			return ConvertRGBA5551(source.data(), out, pixelCount);
+
+		case Format::RGBA_1:
+		case Format::RGBA_2:
+			std::copy_n(source.data(), pixelCount * sizeof RGBA8888, reinterpret_cast<uint8_t*>(out));
+			return;
+
+		case Format::RGBAF:
+			if (HasF16C())
+				return ConvertRGBAF<true>(source.data(), out, pixelCount);
+			else
+				return ConvertRGBAF<false>(source.data(), out, pixelCount);
+
+		default:
+			throw std::invalid_argument("Not an uncompressed format");
+	}
+}
+
+void Sqex::Texture::ConvertFromRGBA8888(Format type, std::span<const RGBA8888> source, std::span<uint8_t> target) {
+	const auto pixelCount = source.size();
+	if (!pixelCount)
+		return;
+	if (target.size_bytes() < RawDataLength(type, pixelCount, 1))
+		throw std::invalid_argument("Target too small");
+
+	const auto in = &source[0].Value;
+	switch (type) {
+		case Format::L8_1:
+		case Format::L8_2:
+			return ConvertToL8(in, target.data(), pixelCount);
+
+		case Format::RGBA4444:
+			return ConvertToRGBA4444(in, target.data(), pixelCount);
+
+		case Format::RGBA5551:
+			return ConvertToRGBA5551(in, target.data(), pixelCount);
+
+		case Format::RGBA_1:
+		case Format::RGBA_2:
+			std::copy_n(reinterpret_cast<const uint8_t*>(in), pixelCount * sizeof RGBA8888, target.data());
+			return;
+
+		case Format::RGBAF:
+			if (HasF16C())
+				return ConvertToRGBAF<true>(in, target.data(), pixelCount);
+			else
+				return ConvertToRGBAF<false>(in, target.data(), pixelCount);
+
+		default:
+			throw std::invalid_argument("Unsupported type");
+	}
+}
+
+void Sqex::Texture::InterleaveL8Channels(Format type, std::span<const uint8_t> r, std::span<const uint8_t> g, std::span<const uint8_t> b, std::span<const uint8_t> a, std::span<uint8_t> target) {
+	const auto pixelCount = r.size();
+	if (g.size() != pixelCount || b.size() != pixelCount || a.size() != pixelCount)
+		throw std::invalid_argument("Channel sizes differ");
+	if (!pixelCount)
+		return;
+	if (target.size_bytes() < RawDataLength(type, pixelCount, 1))
+		throw std::invalid_argument("Target too small");
+
+	switch (type) {
+		case Format::RGBA4444:
+			return InterleaveL8ToRGBA4444(r.data(), g.data(), b.data(), a.data(), target.data(), pixelCount);
+
+		case Format::RGBA_1:
+		case Format::RGBA_2:
+			return InterleaveL8ToRGBA8888(r.data(), g.data(), b.data(), a.data(), target.data(), pixelCount);
+
+		default:
+			throw std::invalid_argument("Unsupported type");
+	}
+}
@@ -0,0 +1,378 @@
+#include "pch.h"
+#include "Sqex_Texture.h"
+
+#include <cfloat>
+#include <cmath>
+#include <immintrin.h>
+
+#include "Utils_Win32_ThreadPool.h"
+
+namespace {
+	// Blocks are compressed in bands of about this many pixels, each band on whichever thread picks it up first.
+	constexpr size_t BandPixelCount = 65536;
+
+	struct ColorBlock {
+		Utils::LE<uint16_t> Color0;
+		Utils::LE<uint16_t> Color1;
+		Utils::LE<uint32_t> Indices;
+	};
+	static_assert(sizeof ColorBlock == 8);
+
+	// Same expansion as the decoders, so that palettes used for choosing indices are the ones that will be seen.
+	void Expand565(uint16_t color, int& r, int& g, int& b) {
+		auto temp = (color >> 11) * 255 + 16;
+		r = (temp / 32 + temp) / 32;
+		temp = ((color & 0x07E0) >> 5) * 255 + 32;
+		g = (temp / 64 + temp) / 64;
+		temp = (color & 0x001F) * 255 + 16;
+		b = (temp / 32 + temp) / 32;
+	}
+
+	uint16_t Quantize565(float r, float g, float b) {
+		const auto q = [](float v, int max) {
+			return static_cast<uint16_t>(std::lround(Utils::Clamp(v, 0.f, 255.f) * static_cast<float>(max) / 255.f));
+		};
+		return static_cast<uint16_t>(q(r, 31) << 11 | q(g, 63) << 5 | q(b, 31));
+	}
+
+	// Fetches a block of pixels; pixels past the right and bottom edges repeat the last column and row.
+	void LoadBlock(std::span<const Sqex::Texture::RGBA8888> pixels, size_t width, size_t height, size_t bx, size_t by, __m128i* rows) {
+		for (size_t j = 0; j < 4; ++j) {
+			const auto y = std::min(by * 4 + j, height - 1);
+			const auto row = &pixels[y * width];
+			if (bx * 4 + 4 <= width) {
+				rows[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&row[bx * 4]));
+			} else {
+				uint32_t tmp[4];
+				for (size_t i = 0; i < 4; ++i)
+					tmp[i] = row[std::min(bx * 4 + i, width - 1)].Value;
+				rows[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tmp));
+			}
+		}
+	}
+
+	// Squared RGB distances between 4 pixels with alpha cleared, and a color with its channels in 16-bit lanes, repeated twice.
+	__m128i ColorDistances(__m128i pixels, __m128i color) {
+		const auto zero = _mm_setzero_si128();
+		const auto lo = _mm_sub_epi16(_mm_unpacklo_epi8(pixels, zero), color);
+		const auto hi = _mm_sub_epi16(_mm_unpackhi_epi8(pixels, zero), color);
+		const auto sqLo = _mm_castsi128_ps(_mm_madd_epi16(lo, lo));
+		const auto sqHi = _mm_castsi128_ps(_mm_madd_epi16(hi, hi));
+		return _mm_add_epi32(
+			_mm_castps_si128(_mm_shuffle_ps(sqLo, sqHi, _MM_SHUFFLE(2, 0, 2, 0))),
+			_mm_castps_si128(_mm_shuffle_ps(sqLo, sqHi, _MM_SHUFFLE(3, 1, 3, 1))));
+	}
+
+	// Picks the closest of the 4 colors of the palette for each pixel, and returns the squared error of the choice.
+	uint32_t SelectColorIndices(const __m128i* rows, uint16_t color0, uint16_t color1, uint32_t& indices) {
+		int r0, g0, b0, r1, g1, b1;
+		Expand565(color0, r0, g0, b0);
+		Expand565(color1, r1, g1, b1);
+		const __m128i palette[4]{
+			_mm_setr_epi16(r0, g0, b0, 0, r0, g0, b0, 0),
+			_mm_setr_epi16(r1, g1, b1, 0, r1, g1, b1, 0),
+			_mm_setr_epi16((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 0, (2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 0),
+			_mm_setr_epi16((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 0, (r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 0),
+		};
+
+		const auto rgbMask = _mm_set1_epi32(0x00FFFFFF);
+		auto error = _mm_setzero_si128();
+		alignas(16) uint32_t best[16];
+		for (size_t j = 0; j < 4; ++j) {
+			const auto pixels = _mm_and_si128(rows[j], rgbMask);
+			auto bestDistance = ColorDistances(pixels, palette[0]);
+			auto bestIndex = _mm_setzero_si128();
+			for (int k = 1; k < 4; ++k) {
+				const auto distance = ColorDistances(pixels, palette[k]);
+				const auto closer = _mm_cmplt_epi32(distance, bestDistance);
+				bestDistance = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, bestDistance));
+				bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)), _mm_andnot_si128(closer, bestIndex));
+			}
+			error = _mm_add_epi32(error, bestDistance);
+			_mm_store_si128(reinterpret_cast<__m128i*>(&best[j * 4]), bestIndex);
+		}
+
+		indices = 0;
+		for (size_t i = 0; i < 16; ++i)
+			indices |= best[i] << (2 * i);
+
+		error = _mm_add_epi32(error, _mm_shuffle_epi32(error, _MM_SHUFFLE(1, 0, 3, 2)));
+		error = _mm_add_epi32(error, _mm_shuffle_epi32(error, _MM_SHUFFLE(2, 3, 0, 1)));
+		return static_cast<uint32_t>(_mm_cvtsi128_si32(error));
+	}
+
+	// Endpoints at the corners of the bounding box of the colors, moved slightly inwards.
+	void FastColorEndpoints(const __m128i* rows, uint16_t& color0, uint16_t& color1) {
+		auto min = _mm_min_epu8(_mm_min_epu8(rows[0], rows[1]), _mm_min_epu8(rows[2], rows[3]));
+		auto max = _mm_max_epu8(_mm_max_epu8(rows[0], rows[1]), _mm_max_epu8(rows[2], rows[3]));
+		min = _mm_min_epu8(min, _mm_shuffle_epi32(min, _MM_SHUFFLE(1, 0, 3, 2)));
+		max = _mm_max_epu8(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(1, 0, 3, 2)));
+		min = _mm_min_epu8(min, _mm_shuffle_epi32(min, _MM_SHUFFLE(2, 3, 0, 1)));
+		max = _mm_max_epu8(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		const auto lo = static_cast<uint32_t>(_mm_cvtsi128_si32(min));
+		const auto hi = static_cast<uint32_t>(_mm_cvtsi128_si32(max));
+		float c0[3], c1[3];
+		for (size_t i = 0; i < 3; ++i) {
+			const auto l = static_cast<float>(lo >> (8 * i) & 0xFF);
+			const auto h = static_cast<float>(hi >> (8 * i) & 0xFF);
+			const auto inset = (h - l) / 16.f;
+			c0[i] = h - inset;
+			c1[i] = l + inset;
+		}
+		color0 = Quantize565(c0[0], c0[1], c0[2]);
+		color1 = Quantize565(c1[0], c1[1], c1[2]);
+	}
+
+	// Endpoints at the extremes of the colors along their principal axis.
+	void PrincipalAxisColorEndpoints(const uint32_t* pixels, uint16_t& color0, uint16_t& color1) {
+		float mean[3]{};
+		float min[3]{255.f, 255.f, 255.f}, max[3]{};
+		for (size_t i = 0; i < 16; ++i) {
+			for (size_t c = 0; c < 3; ++c) {
+				const auto v = static_cast<float>(pixels[i] >> (8 * c) & 0xFF);
+				mean[c] += v;
+				min[c] = std::min(min[c], v);
+				max[c] = std::max(max[c], v);
+			}
+		}
+		for (auto& v : mean)
+			v /= 16.f;
+
+		float cov[6]{};
+		for (size_t i = 0; i < 16; ++i) {
+			const auto r = static_cast<float>(pixels[i] & 0xFF) - mean[0];
+			const auto g = static_cast<float>(pixels[i] >> 8 & 0xFF) - mean[1];
+			const auto b = static_cast<float>(pixels[i] >> 16 & 0xFF) - mean[2];
+			cov[0] += r * r;
+			cov[1] += r * g;
+			cov[2] += r * b;
+			cov[3] += g * g;
+			cov[4] += g * b;
+			cov[5] += b * b;
+		}
+
+		float axis[3]{max[0] - min[0], max[1] - min[1], max[2] - min[2]};
+		for (size_t iteration = 0; iteration < 4; ++iteration) {
+			const float next[3]{
+				axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2],
+				axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4],
+				axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5],
+			};
+			const auto scale = std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+			if (scale < 1e-6f)
+				break;
+			for (size_t c = 0; c < 3; ++c)
+				axis[c] = next[c] / scale;
+		}
+
+		auto minDot = FLT_MAX, maxDot = -FLT_MAX;
+		uint32_t minPixel = pixels[0], maxPixel = pixels[0];
+		for (size_t i = 0; i < 16; ++i) {
+			const auto dot = axis[0] * static_cast<float>(pixels[i] & 0xFF)
+				+ axis[1] * static_cast<float>(pixels[i] >> 8 & 0xFF)
+				+ axis[2] * static_cast<float>(pixels[i] >> 16 & 0xFF);
+			if (dot < minDot) {
+				minDot = dot;
+				minPixel = pixels[i];
+			}
+			if (dot > maxDot) {
+				maxDot = dot;
+				maxPixel = pixels[i];
+			}
+		}
+
+		color0 = Quantize565(static_cast<float>(maxPixel & 0xFF), static_cast<float>(maxPixel >> 8 & 0xFF), static_cast<float>(maxPixel >> 16 & 0xFF));
+		color1 = Quantize565(static_cast<float>(minPixel & 0xFF), static_cast<float>(minPixel >> 8 & 0xFF), static_cast<float>(minPixel >> 16 & 0xFF));
+	}
+
+	// Least squares fit of the endpoints to the pixels, given which palette entry each pixel uses.
+	bool RefineColorEndpoints(const uint32_t* pixels, uint32_t indices, uint16_t& color0, uint16_t& color1) {
+		static constexpr float Weights[4]{1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+
+		float aa = 0, ab = 0, bb = 0;
+		float ax[3]{}, bx[3]{};
+		for (size_t i = 0; i < 16; ++i) {
+			const auto a = Weights[indices >> (2 * i) & 3];
+			const auto b = 1.f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (size_t c = 0; c < 3; ++c) {
+				const auto v = static_cast<float>(pixels[i] >> (8 * c) & 0xFF);
+				ax[c] += a * v;
+				bx[c] += b * v;
+			}
+		}
+
+		const auto det = aa * bb - ab * ab;
+		if (std::abs(det) < 1e-6f)
+			return false;
+
+		float c0[3], c1[3];
+		for (size_t c = 0; c < 3; ++c) {
+			c0[c] = (bb * ax[c] - ab * bx[c]) / det;
+			c1[c] = (aa * bx[c] - ab * ax[c]) / det;
+		}
+		color0 = Quantize565(c0[0], c0[1], c0[2]);
+		color1 = Quantize565(c1[0], c1[1], c1[2]);
+		return true;
+	}
+
+	// DXT1 blocks are always written in the opaque 4 color mode, which the color blocks of DXT3 and DXT5 use regardless of endpoint order.
+	void CompressColorBlock(const __m128i* rows, Sqex::Texture::DxtEncodeQuality quality, bool dxt1, ColorBlock& block) {
+		uint16_t color0, color1;
+		uint32_t indices;
+		uint32_t error;
+		if (quality == Sqex::Texture::DxtEncodeQuality::Fast) {
+			FastColorEndpoints(rows, color0, color1);
+			error = SelectColorIndices(rows, color0, color1, indices);
+		} else {
+			alignas(16) uint32_t pixels[16];
+			for (size_t j = 0; j < 4; ++j)
+				_mm_store_si128(reinterpret_cast<__m128i*>(&pixels[j * 4]), rows[j]);
+
+			PrincipalAxisColorEndpoints(pixels, color0, color1);
+			error = SelectColorIndices(rows, color0, color1, indices);
+			for (size_t iteration = 0; iteration < 2 && error; ++iteration) {
+				uint16_t refined0, refined1;
+				uint32_t refinedIndices;
+				if (!RefineColorEndpoints(pixels, indices, refined0, refined1))
+					break;
+				const auto refinedError = SelectColorIndices(rows, refined0, refined1, refinedIndices);
+				if (refinedError >= error)
+					break;
+				color0 = refined0;
+				color1 = refined1;
+				indices = refinedIndices;
+				error = refinedError;
+			}
+		}
+
+		if (color0 == color1)
+			indices = 0;
+		else if (dxt1 && color0 < color1) {
+			std::swap(color0, color1);
+			indices ^= 0x55555555;  // 0 <-> 1, 2 <-> 3
+		}
+
+		block.Color0 = color0;
+		block.Color1 = color1;
+		block.Indices = indices;
+	}
+
+	void CompressExplicitAlphaBlock(const uint32_t* pixels, uint8_t* block) {
+		for (size_t i = 0; i < 16; i += 2) {
+			const auto a0 = ((pixels[i] >> 24) * 15 + 127) / 255;
+			const auto a1 = ((pixels[i + 1] >> 24) * 15 + 127) / 255;
+			block[i / 2] = static_cast<uint8_t>(a0 | a1 << 4);
+		}
+	}
+
+	// Same palettes as the decoders.
+	void MakeAlphaPalette(uint32_t alpha0, uint32_t alpha1, uint32_t* palette) {
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		if (alpha0 > alpha1) {
+			for (uint32_t code = 2; code < 8; ++code)
+				palette[code] = ((8 - code) * alpha0 + (code - 1) * alpha1) / 7;
+		} else {
+			for (uint32_t code = 2; code < 6; ++code)
+				palette[code] = ((6 - code) * alpha0 + (code - 1) * alpha1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	uint32_t SelectAlphaIndices(const uint32_t* pixels, uint32_t alpha0, uint32_t alpha1, uint64_t& indices) {
+		uint32_t palette[8];
+		MakeAlphaPalette(alpha0, alpha1, palette);
+
+		uint32_t error = 0;
+		indices = 0;
+		for (size_t i = 0; i < 16; ++i) {
+			const auto a = static_cast<int>(pixels[i] >> 24);
+			uint32_t bestCode = 0, bestDistance = UINT32_MAX;
+			for (uint32_t code = 0; code < 8; ++code) {
+				const auto distance = static_cast<uint32_t>(std::abs(a - static_cast<int>(palette[code])));
+				if (distance < bestDistance) {
+					bestDistance = distance;
+					bestCode = code;
+				}
+			}
+			indices |= static_cast<uint64_t>(bestCode) << (3 * i);
+			error += bestDistance * bestDistance;
+		}
+		return error;
+	}
+
+	// The 8 value mode spans the alpha range; the high quality mode also tries the 6 value mode with exact 0 and 255,
+	// spanning only the values in between.
+	void CompressInterpolatedAlphaBlock(const uint32_t* pixels, Sqex::Texture::DxtEncodeQuality quality, uint8_t* block) {
+		uint32_t min = 255, max = 0, innerMin = 255, innerMax = 0;
+		for (size_t i = 0; i < 16; ++i) {
+			const auto a = pixels[i] >> 24;
+			min = std::min(min, a);
+			max = std::max(max, a);
+			if (a != 0 && a != 255) {
+				innerMin = std::min(innerMin, a);
+				innerMax = std::max(innerMax, a);
+			}
+		}
+
+		uint32_t alpha0 = max, alpha1 = min;
+		uint64_t indices;
+		auto error = SelectAlphaIndices(pixels, alpha0, alpha1, indices);
+		if (quality == Sqex::Texture::DxtEncodeQuality::High && error && innerMin <= innerMax) {
+			uint64_t indices6;
+			if (const auto error6 = SelectAlphaIndices(pixels, innerMin, innerMax, indices6); error6 < error) {
+				alpha0 = innerMin;
+				alpha1 = innerMax;
+				indices = indices6;
+			}
+		}
+
+		block[0] = static_cast<uint8_t>(alpha0);
+		block[1] = static_cast<uint8_t>(alpha1);
+		for (size_t i = 0; i < 6; ++i)
+			block[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+	}
+}
+
+std::vector<uint8_t> Sqex::Texture::CompressDXT(Format type, size_t width, size_t height, std::span<const RGBA8888> pixels, DxtEncodeQuality quality) {
+	if (type != Format::DXT1 && type != Format::DXT3 && type != Format::DXT5)
+		throw std::invalid_argument("Not a DXT format");
+	if (pixels.size() < width * height)
+		throw std::invalid_argument("Not enough pixels");
+
+	const auto blockSize = type == Format::DXT1 ? size_t{8} : size_t{16};
+	const auto blocksPerRow = (width + 3) / 4;
+	const auto blockRowCount = (height + 3) / 4;
+	std::vector<uint8_t> result(RawDataLength(type, width, height));
+	if (result.empty())
+		return result;
+
+	const auto blockRowsPerBand = std::max<size_t>(1, BandPixelCount / 4 / std::max<size_t>(1, width));
+	Win32::ParallelFor((blockRowCount + blockRowsPerBand - 1) / blockRowsPerBand, [&](size_t band) {
+		for (auto by = band * blockRowsPerBand, byTo = std::min(blockRowCount, by + blockRowsPerBand); by < byTo; ++by) {
+			for (size_t bx = 0; bx < blocksPerRow; ++bx) {
+				const auto block = &result[(by * blocksPerRow + bx) * blockSize];
+
+				__m128i rows[4];
+				LoadBlock(pixels, width, height, bx, by, rows);
+				CompressColorBlock(rows, quality, type == Format::DXT1, *reinterpret_cast<ColorBlock*>(type == Format::DXT1 ? block : block + 8));
+
+				if (type != Format::DXT1) {
+					alignas(16) uint32_t blockPixels[16];
+					for (size_t j = 0; j < 4; ++j)
+						_mm_store_si128(reinterpret_cast<__m128i*>(&blockPixels[j * 4]), rows[j]);
+					if (type == Format::DXT3)
+						CompressExplicitAlphaBlock(blockPixels, block);
+					else
+						CompressInterpolatedAlphaBlock(blockPixels, quality, block);
+				}
+			}
+		}
+	});
+	return result;
+}
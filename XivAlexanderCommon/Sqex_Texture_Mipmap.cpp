@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Sqex_Texture_Mipmap.h"
 
+#include "Utils_Win32_ThreadPool.h"
 #include "XaDxtDecompression.h"
 
 std::shared_ptr<const Sqex::Texture::MipmapStream> Sqex::Texture::MipmapStream::ViewARGB8888(Format type) const {
@@ -402,6 +403,9 @@ std::shared_ptr<Sqex::Texture::MemoryBackedMipmap> Sqex::Texture::MemoryBackedMi
 	if (type != Format::RGBA_1 && type != Format::RGBA_2)
 		throw std::invalid_argument("invalid argb8888 compression type");
 
+	// Images are converted in bands of about this many pixels, each band on whichever thread picks it up first.
+	static constexpr size_t BandPixelCount = 65536;
+
 	const auto width = stream->Width();
 	const auto height = stream->Height();
 	const auto pixelCount = static_cast<size_t>(width) * height;
@@ -409,50 +413,27 @@ std::shared_ptr<Sqex::Texture::MemoryBackedMipmap> Sqex::Texture::MemoryBackedMi
 
 	std::vector<uint8_t> result(pixelCount * sizeof RGBA8888);
 	const auto rgba8888view = std::span(reinterpret_cast<RGBA8888*>(&result[0]), result.size() / sizeof RGBA8888);
-	uint32_t pos = 0, read = 0;
-	uint8_t buf8[8192];
 	switch (stream->Type()) {
 		case Format::L8_1:
 		case Format::L8_2:
-		{
-			if (cbSource < pixelCount)
-				throw std::runtime_error("Truncated data detected");
-			while (const auto len = static_cast<uint32_t>(std::min<uint64_t>(cbSource - read, sizeof buf8))) {
-				stream->ReadStream(read, buf8, len);
-				read += len;
-				for (size_t i = 0; i < len; ++pos, ++i) {
-					rgba8888view[pos].Value = buf8[i] * 0x10101UL | 0xFF000000UL;
-					// result[pos].R = result[pos].G = result[pos].B = result[pos].A = buf8[i];
-				}
-			}
-			break;
-		}
-
 		case Format::RGBA4444:
-		{
-			if (cbSource < pixelCount * sizeof RGBA4444)
-				throw std::runtime_error("Truncated data detected");
-			const auto view = std::span(reinterpret_cast<RGBA4444*>(buf8), sizeof buf8 / sizeof RGBA4444);
-			while (const auto len = static_cast<uint32_t>(std::min<uint64_t>(cbSource - read, sizeof buf8))) {
-				stream->ReadStream(read, buf8, len);
-				read += len;
-				for (size_t i = 0, count = len / sizeof RGBA4444; i < count; ++pos, ++i)
-					rgba8888view[pos].SetFrom(view[i].R * 17, view[i].G * 17, view[i].B * 17, view[i].A * 17);
-			}
-			break;
-		}
-
 		case Format::RGBA5551:
+		case Format::RGBAF:
 		{
-			if (cbSource < pixelCount * sizeof RGBA5551)
+			const auto sourceType = stream->Type();
+			const auto cbRow = RawDataLength(sourceType, width, 1);
+			if (cbSource < cbRow * height)
 				throw std::runtime_error("Truncated data detected");
-			const auto view = std::span(reinterpret_cast<RGBA5551*>(buf8), sizeof buf8 / sizeof RGBA5551);
-			while (const auto len = static_cast<uint32_t>(std::min<uint64_t>(cbSource - read, sizeof buf8))) {
-				stream->ReadStream(read, buf8, len);
-				read += len;
-				for (size_t i = 0, count = len / sizeof RGBA5551; i < count; ++pos, ++i)
-					rgba8888view[pos].SetFrom(view[i].R * 255 / 31, view[i].G * 255 / 31, view[i].B * 255 / 31, view[i].A * 255);
-			}
+
+			const auto source = stream->ReadStreamIntoVector<uint8_t>(0, cbRow * height);
+			const auto rowsPerBand = std::max<size_t>(1, BandPixelCount / std::max<size_t>(1, width));
+			Win32::ParallelFor((height + rowsPerBand - 1) / rowsPerBand, [&](size_t band) {
+				const auto y = band * rowsPerBand;
+				const auto rows = std::min<size_t>(rowsPerBand, height - y);
+				ConvertToRGBA8888(sourceType,
+					std::span(source).subspan(y * cbRow, rows * cbRow),
+					rgba8888view.subspan(y * width, rows * width));
+			});
 			break;
 		}
 
@@ -463,75 +444,28 @@ std::shared_ptr<Sqex::Texture::MemoryBackedMipmap> Sqex::Texture::MemoryBackedMi
 			stream->ReadStream(0, std::span(rgba8888view));
 			break;
 
-		case Format::RGBAF:
-		{
-			if (cbSource < pixelCount * sizeof RGBAHHHH)
-				throw std::runtime_error("Truncated data detected");
-			stream->ReadStream(0, std::span(rgba8888view));
-			const auto view = std::span(reinterpret_cast<RGBAHHHH*>(buf8), sizeof buf8 / sizeof RGBAHHHH);
-			while (const auto len = static_cast<uint32_t>(std::min<uint64_t>(cbSource - read, sizeof buf8))) {
-				stream->ReadStream(read, buf8, len);
-				read += len;
-				for (size_t i = 0, count = len / sizeof RGBAHHHH; i < count; ++pos, ++i)
-					rgba8888view[pos].SetFromF(view[i]);
-			}
-			break;
-		}
-
 		case Format::DXT1:
-		{
-			if (cbSource < pixelCount * 8)
-				throw std::runtime_error("Truncated data detected");
-			while (const auto len = static_cast<uint32_t>(std::min<uint64_t>(cbSource - read, sizeof buf8))) {
-				stream->ReadStream(read, buf8, len);
-				read += len;
-				for (size_t i = 0, count = len; i < count; i += 8, pos += 8) {
-					DecompressBlockDXT1(
-						pos / 2 % width,
-						pos / 2 / width * 4,
-						width, &buf8[i], reinterpret_cast<uint32_t*>(&rgba8888view[0]));
-				}
-			}
-			break;
-		}
-
 		case Format::DXT3:
-		{
-			if (cbSource < pixelCount * 16)
-				throw std::runtime_error("Truncated data detected");
-			while (const auto len = static_cast<uint32_t>(std::min<uint64_t>(cbSource - read, sizeof buf8))) {
-				stream->ReadStream(read, buf8, len);
-				read += len;
-				for (size_t i = 0, count = len; i < count; i += 16, pos += 16) {
-					DecompressBlockDXT1(
-						pos / 4 % width,
-						pos / 4 / width * 4,
-						width, &buf8[i], reinterpret_cast<uint32_t*>(&rgba8888view[0]));
-					for (size_t dy = 0; dy < 4; dy += 1) {
-						for (size_t dx = 0; dx < 4; dx += 2) {
-							rgba8888view[dy * width + dx].A = 17 * (buf8[i + dy * 2 + dx / 2] & 0xF);
-							rgba8888view[dy * width + dx + 1].A = 17 * (buf8[i + dy * 2 + dx / 2] >> 4);
-						}
-					}
-				}
-			}
-			break;
-		}
-
 		case Format::DXT5:
 		{
-			if (cbSource < pixelCount * 16)
+			const auto decode = stream->Type() == Format::DXT1 ? &DecompressBlockRowDXT1 : (stream->Type() == Format::DXT3 ? &DecompressBlockRowDXT3 : &DecompressBlockRowDXT5);
+			const auto instructionSet = DxtDecoderBestInstructionSet();
+			const size_t blockRowSize = (width + 3) / 4 * (stream->Type() == Format::DXT1 ? 8 : 16);
+			const uint32_t blockRowCount = (height + 3) / 4;
+			if (cbSource < blockRowSize * blockRowCount)
 				throw std::runtime_error("Truncated data detected");
-			while (const auto len = static_cast<uint32_t>(std::min<uint64_t>(cbSource - read, sizeof buf8))) {
-				stream->ReadStream(read, buf8, len);
-				read += len;
-				for (size_t i = 0, count = len; i < count; i += 16, pos += 16) {
-					DecompressBlockDXT5(
-						pos / 4 % width,
-						pos / 4 / width * 4,
-						width, &buf8[i], reinterpret_cast<uint32_t*>(&rgba8888view[0]));
+
+			// Each row of blocks decodes independently of the others.
+			const auto blockRows = stream->ReadStreamIntoVector<uint8_t>(0, blockRowSize * blockRowCount);
+			const auto blockRowsPerBand = static_cast<uint32_t>(std::max<size_t>(1, BandPixelCount / 4 / std::max<size_t>(1, width)));
+			Win32::ParallelFor((blockRowCount + blockRowsPerBand - 1) / blockRowsPerBand, [&](size_t band) {
+				const auto blockRowFrom = static_cast<uint32_t>(band) * blockRowsPerBand;
+				const auto blockRowTo = std::min(blockRowCount, blockRowFrom + blockRowsPerBand);
+				for (auto blockRow = blockRowFrom; blockRow < blockRowTo; ++blockRow) {
+					const auto y = blockRow * 4U;
+					decode(width, std::min(4U, height - y), &blockRows[blockRow * blockRowSize], &rgba8888view[static_cast<size_t>(y) * width].Value, instructionSet);
 				}
-			}
+			});
 			break;
 		}
 
@@ -543,6 +477,26 @@ std::shared_ptr<Sqex::Texture::MemoryBackedMipmap> Sqex::Texture::MemoryBackedMi
 	return std::make_shared<MemoryBackedMipmap>(stream->Width(), stream->Height(), type, std::move(result));
 }
 
+std::shared_ptr<Sqex::Texture::MemoryBackedMipmap> Sqex::Texture::MemoryBackedMipmap::NewFromARGB8888(uint16_t width, uint16_t height, std::span<const RGBA8888> pixels, Format type, DxtEncodeQuality quality) {
+	const auto pixelCount = static_cast<size_t>(width) * height;
+	if (pixels.size() < pixelCount)
+		throw std::invalid_argument("Not enough pixels");
+
+	switch (type) {
+		case Format::DXT1:
+		case Format::DXT3:
+		case Format::DXT5:
+			return std::make_shared<MemoryBackedMipmap>(width, height, type, CompressDXT(type, width, height, pixels, quality));
+
+		default:
+		{
+			std::vector<uint8_t> result(RawDataLength(type, width, height));
+			ConvertFromRGBA8888(type, pixels.subspan(0, pixelCount), result);
+			return std::make_shared<MemoryBackedMipmap>(width, height, type, std::move(result));
+		}
+	}
+}
+
 uint64_t Sqex::Texture::MemoryBackedMipmap::ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const {
 	const auto available = static_cast<size_t>(std::min(m_data.size() - offset, length));
 	std::copy_n(&m_data[static_cast<size_t>(offset)], available, static_cast<char*>(buf));
@@ -27,19 +27,59 @@ void Sqex::Texture::ModifiableTextureStream::AppendMipmap(std::shared_ptr<Memory
 		throw std::invalid_argument("invalid mipmap type");
 	m_mipmaps.emplace_back(std::move(mipmap));
 	m_header.MipmapCount = static_cast<uint16_t>(m_mipmaps.size());
+	UpdateMipmapOffsets();
+}
+
+void Sqex::Texture::ModifiableTextureStream::UpdateMipmapOffsets() {
+	// The offset table itself grows with the mipmap count, so the first offset has to be computed from the final count.
+	m_mipmapOffsets.resize(m_mipmaps.size());
+	if (m_mipmaps.empty())
+		return;
+	m_mipmapOffsets[0] = static_cast<uint32_t>(Align(sizeof m_header + std::span(m_mipmapOffsets).size_bytes()).Alloc);
+	for (size_t i = 1; i < m_mipmaps.size(); ++i)
+		m_mipmapOffsets[i] = static_cast<uint32_t>(m_mipmapOffsets[i - 1] + Align(m_mipmaps[i - 1]->StreamSize()).Alloc);
+}
+
+void Sqex::Texture::ModifiableTextureStream::AppendHalvedMipmaps(std::vector<RGBA8888> pixels, size_t width, size_t height, MipmapFilter filter, size_t maxCount, DxtEncodeQuality quality) {
+	while (m_mipmaps.size() < maxCount && width >= 2 && height >= 2) {
+		pixels = HalveRGBA8888(pixels, width, height, filter);
+		width /= 2;
+		height /= 2;
+		AppendMipmap(MemoryBackedMipmap::NewFromARGB8888(static_cast<uint16_t>(width), static_cast<uint16_t>(height), pixels, m_header.Type, quality));
+	}
+}
+
+void Sqex::Texture::ModifiableTextureStream::AppendMipmapChain(const MipmapStream& source, MipmapFilter filter, size_t maxCount, DxtEncodeQuality quality) {
+	const size_t width = source.Width();
+	const size_t height = source.Height();
+	if (width != m_header.Width >> m_mipmaps.size())
+		throw std::invalid_argument("invalid mipmap width");
+	if (height != m_header.Height >> m_mipmaps.size())
+		throw std::invalid_argument("invalid mipmap height");
+	if (m_mipmaps.size() >= maxCount || !width || !height)
+		return;
+
+	auto pixels = source.ViewARGB8888(Format::RGBA_1)->ReadStreamIntoVector<RGBA8888>(0, width * height);
+	AppendMipmap(MemoryBackedMipmap::NewFromARGB8888(static_cast<uint16_t>(width), static_cast<uint16_t>(height), pixels, m_header.Type, quality));
+	AppendHalvedMipmaps(std::move(pixels), width, height, filter, maxCount, quality);
+}
+
+void Sqex::Texture::ModifiableTextureStream::GenerateMipmaps(MipmapFilter filter, size_t maxCount, DxtEncodeQuality quality) {
+	if (m_mipmaps.empty())
+		throw std::runtime_error("no mipmap to generate from");
 
-	m_mipmapOffsets.clear();
-	m_mipmapOffsets.push_back(static_cast<uint32_t>(Align(sizeof m_header + std::span(m_mipmapOffsets).size_bytes())));
-	for (size_t i = 0; i < m_mipmaps.size() - 1; ++i)
-		m_mipmapOffsets.push_back(static_cast<uint32_t>(m_mipmapOffsets[i] + Align(m_mipmaps[i]->StreamSize()).Alloc));
+	TruncateMipmap(1);
+	const auto& first = *m_mipmaps[0];
+	AppendHalvedMipmaps(first.ViewARGB8888(Format::RGBA_1)->ReadStreamIntoVector<RGBA8888>(0, static_cast<size_t>(first.Width()) * first.Height()),
+		first.Width(), first.Height(), filter, maxCount, quality);
 }
 
 void Sqex::Texture::ModifiableTextureStream::TruncateMipmap(size_t count) {
-	if (m_mipmaps.size() > count)
+	if (m_mipmaps.size() < count)
 		throw std::invalid_argument("only truncation is supported");
 	m_mipmaps.resize(count);
-	m_mipmapOffsets.resize(count);
 	m_header.MipmapCount = static_cast<uint16_t>(count);
+	UpdateMipmapOffsets();
 }
 
 uint64_t Sqex::Texture::ModifiableTextureStream::StreamSize() const {
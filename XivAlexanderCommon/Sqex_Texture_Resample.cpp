@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "Sqex_Texture.h"
+
+#include <array>
+#include <cmath>
+#include <immintrin.h>
+
+#include "Utils_Win32_ThreadPool.h"
+
+namespace {
+	// Images are resampled in tiles of rows of about this many destination pixels, each tile on whichever thread picks it up first.
+	constexpr size_t TilePixelCount = 16384;
+
+	// Averages 2x2 blocks of 4 horizontally adjacent destination pixels at once, rounding to nearest.
+	void HalveRowBox(const uint32_t* row0, const uint32_t* row1, uint32_t* target, size_t halfWidth) {
+		const auto zero = _mm_setzero_si128();
+		const auto two = _mm_set1_epi16(2);
+
+		// Sums of 2x2 blocks of the 4 pixels at p in each row, into 16-bit channels of 2 destination pixels.
+		const auto sum2x2 = [&](const uint32_t* p0, const uint32_t* p1) {
+			const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p0));
+			const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1));
+			const auto lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+			const auto hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+			return _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)), _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+		};
+
+		size_t x = 0;
+		for (; x + 4 <= halfWidth; x += 4) {
+			const auto s01 = _mm_srli_epi16(_mm_add_epi16(sum2x2(&row0[x * 2], &row1[x * 2]), two), 2);
+			const auto s23 = _mm_srli_epi16(_mm_add_epi16(sum2x2(&row0[x * 2 + 4], &row1[x * 2 + 4]), two), 2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&target[x]), _mm_packus_epi16(s01, s23));
+		}
+		for (; x < halfWidth; ++x) {
+			uint32_t pixel = 0;
+			for (size_t c = 0; c < 32; c += 8) {
+				const auto sum = (row0[x * 2] >> c & 0xFF) + (row0[x * 2 + 1] >> c & 0xFF) + (row1[x * 2] >> c & 0xFF) + (row1[x * 2 + 1] >> c & 0xFF);
+				pixel |= (sum + 2) / 4 << c;
+			}
+			target[x] = pixel;
+		}
+	}
+
+	// Kaiser windowed sinc (width 3, alpha 4) sampled at the 8 source pixels around each destination pixel, normalized.
+	const auto KaiserWeights = []() {
+		const auto bessel0 = [](double x) {
+			double sum = 1, term = 1;
+			for (int k = 1; k < 32; ++k) {
+				term *= x / (2 * k);
+				sum += term * term;
+			}
+			return sum;
+		};
+
+		static constexpr double Width = 3, Alpha = 4;
+		std::array<float, 8> weights{};
+		double total = 0;
+		for (size_t i = 0; i < 8; ++i) {
+			// Distance from the destination pixel center, in destination pixels.
+			const auto x = (static_cast<double>(i) - 3.5) / 2;
+			const auto sinc = x == 0 ? 1. : std::sin(3.14159265358979323846 * x) / (3.14159265358979323846 * x);
+			const auto window = bessel0(Alpha * std::sqrt(1 - (x / Width) * (x / Width))) / bessel0(Alpha);
+			weights[i] = static_cast<float>(sinc * window);
+			total += weights[i];
+		}
+		for (auto& w : weights)
+			w = static_cast<float>(w / total);
+		return weights;
+	}();
+
+	__m128 PixelToFloats(uint32_t pixel) {
+		const auto zero = _mm_setzero_si128();
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(pixel)), zero), zero));
+	}
+
+	uint32_t FloatsToPixel(__m128 channels) {
+		const auto clamped = _mm_min_ps(_mm_max_ps(channels, _mm_setzero_ps()), _mm_set1_ps(255.f));
+		const auto packed = _mm_packs_epi32(_mm_cvtps_epi32(clamped), _mm_setzero_si128());
+		return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(packed, packed)));
+	}
+
+	// Filters a source row horizontally into one float per channel of each destination pixel, clamping at the edges.
+	void FilterRowKaiser(const uint32_t* row, size_t width, size_t halfWidth, __m128* target) {
+		__m128 weights[8];
+		for (size_t k = 0; k < 8; ++k)
+			weights[k] = _mm_set1_ps(KaiserWeights[k]);
+
+		for (size_t x = 0; x < halfWidth; ++x) {
+			auto sum = _mm_setzero_ps();
+			const auto first = static_cast<ptrdiff_t>(x * 2) - 3;
+			if (first >= 0 && static_cast<size_t>(first) + 8 <= width) {
+				for (size_t k = 0; k < 8; ++k)
+					sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], PixelToFloats(row[first + k])));
+			} else {
+				for (size_t k = 0; k < 8; ++k) {
+					const auto sx = static_cast<size_t>(std::clamp<ptrdiff_t>(first + static_cast<ptrdiff_t>(k), 0, static_cast<ptrdiff_t>(width) - 1));
+					sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], PixelToFloats(row[sx])));
+				}
+			}
+			target[x] = sum;
+		}
+	}
+}
+
+std::vector<Sqex::Texture::RGBA8888> Sqex::Texture::HalveRGBA8888(std::span<const RGBA8888> source, size_t width, size_t height, MipmapFilter filter) {
+	if (source.size() < width * height)
+		throw std::invalid_argument("Not enough pixels");
+
+	const auto halfWidth = width / 2;
+	const auto halfHeight = height / 2;
+	std::vector<RGBA8888> result(halfWidth * halfHeight);
+	if (result.empty())
+		return result;
+
+	const auto src = &source[0].Value;
+	const auto dst = &result[0].Value;
+	const auto rowsPerTile = std::max<size_t>(1, TilePixelCount / halfWidth);
+	const auto tileCount = (halfHeight + rowsPerTile - 1) / rowsPerTile;
+	switch (filter) {
+		case MipmapFilter::Box:
+			Win32::ParallelFor(tileCount, [&](size_t tile) {
+				for (auto y = tile * rowsPerTile, yTo = std::min(halfHeight, y + rowsPerTile); y < yTo; ++y)
+					HalveRowBox(&src[y * 2 * width], &src[(y * 2 + 1) * width], &dst[y * halfWidth], halfWidth);
+			});
+			break;
+
+		case MipmapFilter::Kaiser:
+			Win32::ParallelFor(tileCount, [&](size_t tile) {
+				const auto yFrom = tile * rowsPerTile;
+				const auto yTo = std::min(halfHeight, yFrom + rowsPerTile);
+
+				// Horizontally filtered source rows that the vertical pass of this tile reads, clamped at the edges.
+				const auto firstSourceRow = static_cast<ptrdiff_t>(yFrom * 2) - 3;
+				const auto sourceRowCount = (yTo - yFrom) * 2 + 6;
+				std::vector<__m128> filtered(sourceRowCount * halfWidth);
+				for (size_t i = 0; i < sourceRowCount; ++i) {
+					const auto sy = static_cast<size_t>(std::clamp<ptrdiff_t>(firstSourceRow + static_cast<ptrdiff_t>(i), 0, static_cast<ptrdiff_t>(height) - 1));
+					FilterRowKaiser(&src[sy * width], width, halfWidth, &filtered[i * halfWidth]);
+				}
+
+				__m128 weights[8];
+				for (size_t k = 0; k < 8; ++k)
+					weights[k] = _mm_set1_ps(KaiserWeights[k]);
+				for (auto y = yFrom; y < yTo; ++y) {
+					const auto rows = &filtered[(y - yFrom) * 2 * halfWidth];
+					for (size_t x = 0; x < halfWidth; ++x) {
+						auto sum = _mm_setzero_ps();
+						for (size_t k = 0; k < 8; ++k)
+							sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], rows[k * halfWidth + x]));
+						dst[y * halfWidth + x] = FloatsToPixel(sum);
+					}
+				}
+			});
+			break;
+
+		default:
+			throw std::invalid_argument("Unsupported filter");
+	}
+	return result;
+}
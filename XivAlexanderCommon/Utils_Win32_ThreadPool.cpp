@@ -1,6 +1,10 @@
 #include "pch.h"
 #include "Utils_Win32_ThreadPool.h"
 
+#include <atomic>
+#include <latch>
+#include <thread>
+
 Utils::Win32::TpEnvironment::TpEnvironment(int maxCores, int threadPriority)
 	: m_threadPriority(threadPriority)
 	, m_maxCores(maxCores)
@@ -89,3 +93,47 @@ void Utils::Win32::TpEnvironment::Cancel() {
 
 	m_cancelling = false;
 }
+
+void Utils::Win32::ParallelFor(size_t count, const std::function<void(size_t)>& fn) {
+	struct Context {
+		const std::function<void(size_t)>& Fn;
+		size_t Count;
+		std::atomic_size_t Next = 0;
+		std::mutex ErrorMtx;
+		std::exception_ptr Error;
+
+		void Work() {
+			for (size_t i; (i = Next++) < Count;) {
+				try {
+					Fn(i);
+				} catch (...) {
+					const auto lock = std::lock_guard(ErrorMtx);
+					if (!Error)
+						Error = std::current_exception();
+				}
+			}
+		}
+	};
+
+	if (!count)
+		return;
+
+	Context ctx{.Fn = fn, .Count = count};
+	const auto workerCount = std::min<size_t>(count, std::max(1U, std::thread::hardware_concurrency())) - 1;
+	std::latch done(static_cast<ptrdiff_t>(workerCount));
+	std::pair<Context*, std::latch*> param{&ctx, &done};
+	for (size_t i = 0; i < workerCount; ++i) {
+		if (!TrySubmitThreadpoolCallback([](PTP_CALLBACK_INSTANCE, void* p) {
+			const auto& [pCtx, pDone] = *static_cast<std::pair<Context*, std::latch*>*>(p);
+			pCtx->Work();
+			pDone->count_down();
+		}, &param, nullptr))
+			done.count_down();  // calling thread will pick up the slack
+	}
+
+	ctx.Work();
+	done.wait();
+
+	if (ctx.Error)
+		std::rethrow_exception(ctx.Error);
+}
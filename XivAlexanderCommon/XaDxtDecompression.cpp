@@ -7,7 +7,7 @@
 
 #pragma warning(push, 0)
 namespace Utils {
-    // uint32_t PackRGBA(): Helper method that packs RGBA channels into a single 4 byte pixel.
+    // uint32_t PackRGBA(): Helper method that packs RGBA channels into a single 4 byte pixel, laid out as Sqex::Texture::RGBA8888.
     //
     // uint8_t r:     red channel.
     // uint8_t g:     green channel.
@@ -15,7 +15,7 @@ namespace Utils {
     // uint8_t a:     alpha channel.
 
     inline uint32_t PackRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
-        return ((r << 24) | (g << 16) | (b << 8) | a);
+        return (r | (g << 8) | (b << 16) | (a << 24));
     }
 
     // void DecompressBlockDXT1(): Decompresses one block of a DXT1 texture and stores the resulting pixels at the appropriate offset in 'image'.
@@ -0,0 +1,306 @@
+#include "pch.h"
+#include "XaDxtDecompression.h"
+
+#include <array>
+#include <immintrin.h>
+#include <intrin.h>
+
+namespace {
+	// Shuffle control for a row of 4 pixels of a color block, indexed by the row's byte of 2-bit color codes.
+	constexpr auto ColorShuffleLut = []() {
+		std::array<std::array<uint8_t, 16>, 256> lut{};
+		for (size_t code = 0; code < 256; ++code) {
+			for (size_t i = 0; i < 4; ++i) {
+				for (size_t b = 0; b < 4; ++b)
+					lut[code][i * 4 + b] = static_cast<uint8_t>(((code >> (2 * i)) & 3) * 4 + b);
+			}
+		}
+		return lut;
+	}();
+
+	// 3-bit alpha codes of a row of 4 pixels of a DXT5 alpha block spread into bytes, indexed by the row's 12 bits of codes.
+	constexpr auto AlphaIndexLut = []() {
+		std::array<uint32_t, 4096> lut{};
+		for (uint32_t code = 0; code < 4096; ++code) {
+			for (uint32_t i = 0; i < 4; ++i)
+				lut[code] |= ((code >> (3 * i)) & 7) << (8 * i);
+		}
+		return lut;
+	}();
+
+	// Arithmetic below is kept identical to DecompressBlockDXT1/DecompressBlockDXT5, so that results are bit-exact.
+	// Pixels are laid out as Sqex::Texture::RGBA8888, with red in the lowest byte and alpha in the highest.
+	uint32_t PackRGBA(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+		return r | (g << 8) | (b << 16) | (a << 24);
+	}
+
+	void Expand565(uint16_t color, uint32_t& r, uint32_t& g, uint32_t& b) {
+		auto temp = (color >> 11) * 255U + 16;
+		r = (temp / 32 + temp) / 32;
+		temp = ((color & 0x07E0U) >> 5) * 255 + 32;
+		g = (temp / 64 + temp) / 64;
+		temp = (color & 0x001FU) * 255 + 16;
+		b = (temp / 32 + temp) / 32;
+	}
+
+	uint32_t LoadU32(const uint8_t* p) {
+		uint32_t v;
+		memcpy(&v, p, sizeof v);
+		return v;
+	}
+
+	// DXT1 blocks may use the 3 color mode with black, and are opaque; colors of DXT3 and DXT5 blocks are left with zero alpha.
+	void MakeColorPalette(const uint8_t* colorBlock, bool dxt1, uint32_t* palette) {
+		const auto color0 = static_cast<uint16_t>(colorBlock[0] | (colorBlock[1] << 8));
+		const auto color1 = static_cast<uint16_t>(colorBlock[2] | (colorBlock[3] << 8));
+		uint32_t r0, g0, b0, r1, g1, b1;
+		Expand565(color0, r0, g0, b0);
+		Expand565(color1, r1, g1, b1);
+
+		const auto a = dxt1 ? 255U : 0U;
+		palette[0] = PackRGBA(r0, g0, b0, a);
+		palette[1] = PackRGBA(r1, g1, b1, a);
+		if (!dxt1 || color0 > color1) {
+			palette[2] = PackRGBA((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, a);
+			palette[3] = PackRGBA((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, a);
+		} else {
+			palette[2] = PackRGBA((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, a);
+			palette[3] = PackRGBA(0, 0, 0, a);
+		}
+	}
+
+	void MakeAlphaPalette(const uint8_t* alphaBlock, uint8_t* palette) {
+		const uint32_t alpha0 = alphaBlock[0];
+		const uint32_t alpha1 = alphaBlock[1];
+		palette[0] = static_cast<uint8_t>(alpha0);
+		palette[1] = static_cast<uint8_t>(alpha1);
+		if (alpha0 > alpha1) {
+			for (uint32_t code = 2; code < 8; ++code)
+				palette[code] = static_cast<uint8_t>(((8 - code) * alpha0 + (code - 1) * alpha1) / 7);
+		} else {
+			for (uint32_t code = 2; code < 6; ++code)
+				palette[code] = static_cast<uint8_t>(((6 - code) * alpha0 + (code - 1) * alpha1) / 5);
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	uint64_t LoadAlphaIndices(const uint8_t* alphaBlock) {
+		uint64_t v = 0;
+		memcpy(&v, alphaBlock + 2, 6);
+		return v;
+	}
+
+	// Explicit 4-bit alpha of a row of a DXT3 block, scaled to 8 bits and spread into bytes.
+	uint32_t ExplicitAlphaRow(const uint8_t* alphaBlock, size_t row) {
+		const uint32_t r = alphaBlock[row * 2] | (alphaBlock[row * 2 + 1] << 8);
+		return ((r & 0xF) | ((r >> 4 & 0xF) << 8) | ((r >> 8 & 0xF) << 16) | ((r >> 12 & 0xF) << 24)) * 17;
+	}
+
+	template<int DxtVersion>
+	constexpr size_t BlockSize = DxtVersion == 1 ? 8 : 16;
+
+	template<int DxtVersion>
+	void DecodeBlockScalar(const uint8_t* block, uint32_t* pixels) {
+		const auto colorBlock = DxtVersion == 1 ? block : block + 8;
+		uint32_t colors[4];
+		MakeColorPalette(colorBlock, DxtVersion == 1, colors);
+		const auto colorIndices = LoadU32(colorBlock + 4);
+		for (size_t i = 0; i < 16; ++i)
+			pixels[i] = colors[(colorIndices >> (2 * i)) & 3];
+
+		if constexpr (DxtVersion == 3) {
+			for (size_t j = 0; j < 4; ++j) {
+				const auto alphas = ExplicitAlphaRow(block, j);
+				for (size_t i = 0; i < 4; ++i)
+					pixels[j * 4 + i] |= ((alphas >> (8 * i)) & 0xFF) << 24;
+			}
+		} else if constexpr (DxtVersion == 5) {
+			uint8_t alphas[8];
+			MakeAlphaPalette(block, alphas);
+			const auto alphaIndices = LoadAlphaIndices(block);
+			for (size_t i = 0; i < 16; ++i)
+				pixels[i] |= static_cast<uint32_t>(alphas[(alphaIndices >> (3 * i)) & 7]) << 24;
+		}
+	}
+
+	template<int DxtVersion>
+	void DecodeRowScalar(uint32_t width, uint32_t rows, const uint8_t* blocks, uint32_t* image) {
+		for (uint32_t x = 0; x < width; x += 4, blocks += BlockSize<DxtVersion>) {
+			uint32_t pixels[16];
+			DecodeBlockScalar<DxtVersion>(blocks, pixels);
+			const auto columns = std::min(4U, width - x);
+			for (uint32_t j = 0; j < rows; ++j)
+				std::copy_n(&pixels[j * 4], columns, &image[j * width + x]);
+		}
+	}
+
+	template<int DxtVersion>
+	void DecodeBlockSse41(const uint8_t* block, __m128i* rowsOut) {
+		const auto colorBlock = DxtVersion == 1 ? block : block + 8;
+		uint32_t colors[4];
+		MakeColorPalette(colorBlock, DxtVersion == 1, colors);
+		const auto palette = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors));
+		const auto colorIndices = LoadU32(colorBlock + 4);
+
+		__m128i alphaPalette{};
+		uint64_t alphaIndices = 0;
+		if constexpr (DxtVersion == 5) {
+			uint8_t alphas[16]{};
+			MakeAlphaPalette(block, alphas);
+			alphaPalette = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alphas));
+			alphaIndices = LoadAlphaIndices(block);
+		}
+
+		for (size_t j = 0; j < 4; ++j) {
+			auto row = _mm_shuffle_epi8(palette, _mm_loadu_si128(reinterpret_cast<const __m128i*>(ColorShuffleLut[(colorIndices >> (8 * j)) & 0xFF].data())));
+
+			if constexpr (DxtVersion == 3) {
+				row = _mm_or_si128(row, _mm_slli_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(ExplicitAlphaRow(block, j)))), 24));
+			} else if constexpr (DxtVersion == 5) {
+				// Bytes other than the lowest of each pixel have their highest bit set, so that the shuffle zeroes them; alpha is then shifted into the highest byte.
+				const auto control = _mm_or_si128(
+					_mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(AlphaIndexLut[(alphaIndices >> (12 * j)) & 0xFFF]))),
+					_mm_set1_epi32(static_cast<int>(0x80808000)));
+				row = _mm_or_si128(row, _mm_slli_epi32(_mm_shuffle_epi8(alphaPalette, control), 24));
+			}
+
+			rowsOut[j] = row;
+		}
+	}
+
+	template<int DxtVersion>
+	void DecodeRowSse41(uint32_t width, uint32_t rows, const uint8_t* blocks, uint32_t* image, uint32_t stride) {
+		for (uint32_t x = 0; x < width; x += 4, blocks += BlockSize<DxtVersion>) {
+			__m128i pixels[4];
+			DecodeBlockSse41<DxtVersion>(blocks, pixels);
+			if (x + 4 <= width) {
+				for (uint32_t j = 0; j < rows; ++j)
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(&image[j * stride + x]), pixels[j]);
+			} else {
+				for (uint32_t j = 0; j < rows; ++j) {
+					uint32_t tmp[4];
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), pixels[j]);
+					std::copy_n(tmp, width - x, &image[j * stride + x]);
+				}
+			}
+		}
+	}
+
+	// Decodes two horizontally adjacent blocks at once, one in each 128-bit lane.
+	template<int DxtVersion>
+	void DecodeBlockPairAvx2(const uint8_t* block, __m256i* rowsOut) {
+		const auto blockA = block;
+		const auto blockB = block + BlockSize<DxtVersion>;
+		const auto colorBlockA = DxtVersion == 1 ? blockA : blockA + 8;
+		const auto colorBlockB = DxtVersion == 1 ? blockB : blockB + 8;
+
+		uint32_t colors[8];
+		MakeColorPalette(colorBlockA, DxtVersion == 1, &colors[0]);
+		MakeColorPalette(colorBlockB, DxtVersion == 1, &colors[4]);
+		const auto palette = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(colors));
+		const auto colorIndicesA = LoadU32(colorBlockA + 4);
+		const auto colorIndicesB = LoadU32(colorBlockB + 4);
+
+		__m256i alphaPalette{};
+		uint64_t alphaIndicesA = 0, alphaIndicesB = 0;
+		if constexpr (DxtVersion == 5) {
+			uint8_t alphas[32]{};
+			MakeAlphaPalette(blockA, &alphas[0]);
+			MakeAlphaPalette(blockB, &alphas[16]);
+			alphaPalette = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(alphas));
+			alphaIndicesA = LoadAlphaIndices(blockA);
+			alphaIndicesB = LoadAlphaIndices(blockB);
+		}
+
+		for (size_t j = 0; j < 4; ++j) {
+			const auto control = _mm256_set_m128i(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(ColorShuffleLut[(colorIndicesB >> (8 * j)) & 0xFF].data())),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(ColorShuffleLut[(colorIndicesA >> (8 * j)) & 0xFF].data())));
+			auto row = _mm256_shuffle_epi8(palette, control);
+
+			if constexpr (DxtVersion == 3) {
+				row = _mm256_or_si256(row, _mm256_slli_epi32(_mm256_cvtepu8_epi32(_mm_set_epi32(0, 0,
+					static_cast<int>(ExplicitAlphaRow(blockB, j)),
+					static_cast<int>(ExplicitAlphaRow(blockA, j)))), 24));
+			} else if constexpr (DxtVersion == 5) {
+				const auto alphaControl = _mm256_or_si256(
+					_mm256_cvtepu8_epi32(_mm_set_epi32(0, 0,
+						static_cast<int>(AlphaIndexLut[(alphaIndicesB >> (12 * j)) & 0xFFF]),
+						static_cast<int>(AlphaIndexLut[(alphaIndicesA >> (12 * j)) & 0xFFF]))),
+					_mm256_set1_epi32(static_cast<int>(0x80808000)));
+				row = _mm256_or_si256(row, _mm256_slli_epi32(_mm256_shuffle_epi8(alphaPalette, alphaControl), 24));
+			}
+
+			rowsOut[j] = row;
+		}
+	}
+
+	template<int DxtVersion>
+	void DecodeRowAvx2(uint32_t width, uint32_t rows, const uint8_t* blocks, uint32_t* image) {
+		uint32_t x = 0;
+		for (; x + 8 <= width; x += 8, blocks += 2 * BlockSize<DxtVersion>) {
+			__m256i pixels[4];
+			DecodeBlockPairAvx2<DxtVersion>(blocks, pixels);
+			for (uint32_t j = 0; j < rows; ++j)
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(&image[j * width + x]), pixels[j]);
+		}
+		_mm256_zeroupper();
+
+		if (x < width)
+			DecodeRowSse41<DxtVersion>(width - x, rows, blocks, &image[x], width);
+	}
+
+	Utils::DxtDecoderInstructionSet DetectInstructionSet() {
+		int info[4];
+		__cpuid(info, 0);
+		const auto maxLeaf = info[0];
+		if (maxLeaf < 1)
+			return Utils::DxtDecoderInstructionSet::Scalar;
+
+		__cpuid(info, 1);
+		const auto sse41 = (info[2] & (1 << 19)) != 0;
+		const auto osxsave = (info[2] & (1 << 27)) != 0;
+		const auto avx = (info[2] & (1 << 28)) != 0;
+		if (!sse41)
+			return Utils::DxtDecoderInstructionSet::Scalar;
+
+		// AVX2 also needs the OS to preserve YMM registers across context switches.
+		if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+			__cpuidex(info, 7, 0);
+			if (info[1] & (1 << 5))
+				return Utils::DxtDecoderInstructionSet::Avx2;
+		}
+		return Utils::DxtDecoderInstructionSet::Sse41;
+	}
+
+	template<int DxtVersion>
+	void DecodeRow(uint32_t width, uint32_t rows, const uint8_t* blockStorage, uint32_t* image, Utils::DxtDecoderInstructionSet instructionSet) {
+		rows = std::min(rows, 4U);
+		switch (std::min(instructionSet, Utils::DxtDecoderBestInstructionSet())) {
+			case Utils::DxtDecoderInstructionSet::Avx2:
+				return DecodeRowAvx2<DxtVersion>(width, rows, blockStorage, image);
+			case Utils::DxtDecoderInstructionSet::Sse41:
+				return DecodeRowSse41<DxtVersion>(width, rows, blockStorage, image, width);
+			default:
+				return DecodeRowScalar<DxtVersion>(width, rows, blockStorage, image);
+		}
+	}
+}
+
+Utils::DxtDecoderInstructionSet Utils::DxtDecoderBestInstructionSet() {
+	static const auto best = DetectInstructionSet();
+	return best;
+}
+
+void Utils::DecompressBlockRowDXT1(uint32_t width, uint32_t rows, const uint8_t* blockStorage, uint32_t* image, DxtDecoderInstructionSet instructionSet) {
+	DecodeRow<1>(width, rows, blockStorage, image, instructionSet);
+}
+
+void Utils::DecompressBlockRowDXT3(uint32_t width, uint32_t rows, const uint8_t* blockStorage, uint32_t* image, DxtDecoderInstructionSet instructionSet) {
+	DecodeRow<3>(width, rows, blockStorage, image, instructionSet);
+}
+
+void Utils::DecompressBlockRowDXT5(uint32_t width, uint32_t rows, const uint8_t* blockStorage, uint32_t* image, DxtDecoderInstructionSet instructionSet) {
+	DecodeRow<5>(width, rows, blockStorage, image, instructionSet);
+}
@@ -1,6 +1,44 @@
 #include "pch.h"
 #include "XaZlib.h"
 
+#if __has_include(<libdeflate.h>)
+#include <libdeflate.h>
+#define XA_HAS_LIBDEFLATE 1
+#else
+#define XA_HAS_LIBDEFLATE 0
+#endif
+
+namespace {
+	std::atomic<Utils::DeflateBackend> s_deflateBackend = XA_HAS_LIBDEFLATE ? Utils::DeflateBackend::Libdeflate : Utils::DeflateBackend::Zlib;
+
+#if XA_HAS_LIBDEFLATE
+	bool UseLibdeflate(int windowBits) {
+		return windowBits == -15 && s_deflateBackend == Utils::DeflateBackend::Libdeflate;
+	}
+#endif
+}
+
+bool Utils::IsDeflateBackendAvailable(DeflateBackend backend) {
+	switch (backend) {
+		case DeflateBackend::Zlib:
+			return true;
+		case DeflateBackend::Libdeflate:
+			return XA_HAS_LIBDEFLATE;
+		default:
+			return false;
+	}
+}
+
+Utils::DeflateBackend Utils::GetDeflateBackend() {
+	return s_deflateBackend;
+}
+
+void Utils::SetDeflateBackend(DeflateBackend backend) {
+	if (!IsDeflateBackendAvailable(backend))
+		throw std::invalid_argument("Deflate backend not available in this build");
+	s_deflateBackend = backend;
+}
+
 std::string Utils::ZlibError::DescribeReturnCode(int code) {
 	switch (code) {
 		case Z_OK: return "OK";
@@ -39,9 +77,37 @@ Utils::ZlibReusableInflater::ZlibReusableInflater(int windowBits, int defaultBuf
 Utils::ZlibReusableInflater::~ZlibReusableInflater() {
 	if (m_initialized)
 		inflateEnd(&m_zstream);
+#if XA_HAS_LIBDEFLATE
+	if (m_libdeflate)
+		libdeflate_free_decompressor(m_libdeflate);
+#endif
+}
+
+libdeflate_decompressor* Utils::ZlibReusableInflater::Libdeflate() {
+#if XA_HAS_LIBDEFLATE
+	if (!m_libdeflate && !((m_libdeflate = libdeflate_alloc_decompressor())))
+		throw std::bad_alloc();
+#endif
+	return m_libdeflate;
 }
 
 std::span<uint8_t> Utils::ZlibReusableInflater::operator()(std::span<const uint8_t> source) {
+#if XA_HAS_LIBDEFLATE
+	if (UseLibdeflate(m_windowBits)) {
+		if (m_buffer.size() < m_defaultBufferSize)
+			m_buffer.resize(m_defaultBufferSize);
+		while (true) {
+			size_t written;
+			const auto res = libdeflate_deflate_decompress(Libdeflate(), source.data(), source.size(), m_buffer.data(), m_buffer.size(), &written);
+			if (res == LIBDEFLATE_SUCCESS)
+				return std::span(m_buffer).subspan(0, written);
+			if (res != LIBDEFLATE_INSUFFICIENT_SPACE)
+				break;
+			m_buffer.resize(m_buffer.size() * 2);
+		}
+	}
+#endif
+
 	Initialize();
 
 	m_zstream.next_in = &source[0];
@@ -74,6 +140,14 @@ std::span<uint8_t> Utils::ZlibReusableInflater::operator()(std::span<const uint8
 }
 
 std::span<uint8_t> Utils::ZlibReusableInflater::operator()(std::span<const uint8_t> source, std::span<uint8_t> target) {
+#if XA_HAS_LIBDEFLATE
+	// zlib returns as much as fits in target, so anything but a complete decode goes through zlib.
+	if (size_t written;
+		UseLibdeflate(m_windowBits)
+		&& LIBDEFLATE_SUCCESS == libdeflate_deflate_decompress(Libdeflate(), source.data(), source.size(), target.data(), target.size(), &written))
+		return target.subspan(0, written);
+#endif
+
 	Initialize();
 
 	m_zstream.next_in = &source[0];
@@ -111,9 +185,35 @@ Utils::ZlibReusableDeflater::ZlibReusableDeflater(int level, int method, int win
 Utils::ZlibReusableDeflater::~ZlibReusableDeflater() {
 	if (m_initialized)
 		deflateEnd(&m_zstream);
+#if XA_HAS_LIBDEFLATE
+	if (m_libdeflate)
+		libdeflate_free_compressor(m_libdeflate);
+#endif
+}
+
+libdeflate_compressor* Utils::ZlibReusableDeflater::Libdeflate() {
+#if XA_HAS_LIBDEFLATE
+	// zlib levels map onto the same libdeflate levels, which trade off size and speed similarly.
+	if (!m_libdeflate && !((m_libdeflate = libdeflate_alloc_compressor(m_level == Z_DEFAULT_COMPRESSION ? 6 : m_level))))
+		throw std::bad_alloc();
+#endif
+	return m_libdeflate;
 }
 
 std::span<uint8_t> Utils::ZlibReusableDeflater::operator()(std::span<const uint8_t> source) {
+#if XA_HAS_LIBDEFLATE
+	if (UseLibdeflate(m_windowBits)
+		&& m_method == Z_DEFLATED
+		&& m_strategy == Z_DEFAULT_STRATEGY
+		&& (m_level == Z_DEFAULT_COMPRESSION || (m_level >= 0 && m_level <= 9))) {
+		const auto compressor = Libdeflate();
+		if (const auto bound = libdeflate_deflate_compress_bound(compressor, source.size()); m_buffer.size() < bound)
+			m_buffer.resize(bound);
+		if (const auto written = libdeflate_deflate_compress(compressor, source.data(), source.size(), m_buffer.data(), m_buffer.size()))
+			return std::span(m_buffer).subspan(0, written);
+	}
+#endif
+
 	Initialize();
 
 	m_zstream.next_in = &source[0];
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <future>
 #include <mutex>
 #include <span>
 #include <type_traits>
+#include <unordered_map>
 
 #include "Utils_Win32_Handle.h"
 #include "XaMisc.h"
@@ -98,6 +100,15 @@ namespace Sqex {
 	
 	class RandomAccessStream : public std::enable_shared_from_this<RandomAccessStream> {
 	public:
+		struct ReadRequest {
+			uint64_t Offset;
+			std::span<uint8_t> Buffer;
+			uint64_t Read = 0;  // set to the number of bytes read by ReadStreamPartialVectored
+		};
+
+		// Called with the number of bytes read, or with the exception thrown while reading; must not throw.
+		using ReadCompletionCallback = std::function<void(uint64_t read, std::exception_ptr error)>;
+
 		RandomAccessStream();
 		RandomAccessStream(RandomAccessStream&&) = delete;
 		RandomAccessStream(const RandomAccessStream&) = delete;
@@ -108,8 +119,19 @@ namespace Sqex {
 		[[nodiscard]] virtual uint64_t StreamSize() const = 0;
 		virtual uint64_t ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const = 0;
 
+		// Reads multiple ranges at once, in no particular order. Default implementation calls ReadStreamPartial for each request.
+		virtual void ReadStreamPartialVectored(std::span<ReadRequest> requests) const;
+
+		// Starts reading and returns; callback may be called from any thread, possibly before this function returns.
+		// buf must stay valid until callback is called. Default implementation calls ReadStreamPartial from the process default thread pool.
+		virtual void ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const;
+
 		void ReadStream(uint64_t offset, void* buf, uint64_t length) const;
 
+		void ReadStreamVectored(std::span<ReadRequest> requests) const;
+
+		[[nodiscard]] std::future<void> ReadStreamAsync(uint64_t offset, void* buf, uint64_t length) const;
+
 		template<typename T>
 		T ReadStream(uint64_t offset) const {
 			T buf;
@@ -150,18 +172,85 @@ namespace Sqex {
 		virtual std::string DescribeState() const { return {}; }
 	};
 
+	// Process-wide cache of windows read by BufferedRandomAccessStream instances, bounded by total size and evicted in clock order.
+	class StreamPageCache {
+	public:
+		struct Statistics {
+			uint64_t Hits;
+			uint64_t Misses;
+			uint64_t Evictions;
+			size_t Pages;
+			size_t Bytes;
+			size_t Capacity;
+		};
+
+	private:
+		struct Key {
+			const void* Owner;
+			uint64_t Index;
+
+			bool operator==(const Key&) const = default;
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const {
+				return std::hash<const void*>()(key.Owner) ^ std::hash<uint64_t>()(key.Index * 0x9E3779B97F4A7C15ULL);
+			}
+		};
+
+		struct Slot {
+			Key Id;
+			std::shared_ptr<const std::vector<uint8_t>> Data;  // nullptr if the slot is free
+			bool Referenced;
+		};
+
+		mutable std::mutex m_mtx;
+		std::vector<Slot> m_slots;
+		std::vector<size_t> m_freeSlots;
+		std::unordered_map<Key, size_t, KeyHash> m_index;
+		size_t m_hand = 0;
+		size_t m_bytes = 0;
+		size_t m_capacity;
+		uint64_t m_hits = 0;
+		uint64_t m_misses = 0;
+		uint64_t m_evictions = 0;
+
+		void EvictUntil(size_t bytes);
+		void Free(size_t slotIndex);
+
+	public:
+		static constexpr size_t DefaultCapacity = 64 * 1048576;
+
+		StreamPageCache(size_t capacity = DefaultCapacity);
+
+		static StreamPageCache& Instance();
+
+		[[nodiscard]] size_t Capacity() const;
+
+		// Setting capacity to 0 disables caching and releases everything cached.
+		void Capacity(size_t capacity);
+
+		[[nodiscard]] Statistics GetStatistics() const;
+
+		[[nodiscard]] std::shared_ptr<const std::vector<uint8_t>> Find(const void* owner, uint64_t index);
+
+		void Put(const void* owner, uint64_t index, std::shared_ptr<const std::vector<uint8_t>> data);
+
+		// Releases all pages of an owner; must be called before the owner is destroyed.
+		void Forget(const void* owner);
+	};
+
 	class BufferedRandomAccessStream : public RandomAccessStream {
 		const std::shared_ptr<RandomAccessStream> m_stream;
 		const size_t m_bufferSize;
 		const uint64_t m_streamSize;
-		mutable std::vector<void*> m_buffers;
+		mutable std::mutex m_readMtx;
 
 	public:
 		BufferedRandomAccessStream(std::shared_ptr<RandomAccessStream> stream, size_t bufferSize = 65536)
 			: m_stream(std::move(stream))
 			, m_bufferSize(bufferSize)
-			, m_streamSize(m_stream->StreamSize())
-			, m_buffers(Align<uint64_t, size_t>(m_streamSize, m_bufferSize).Count) {
+			, m_streamSize(m_stream->StreamSize()) {
 		}
 
 		~BufferedRandomAccessStream() override;
@@ -192,6 +281,15 @@ namespace Sqex {
 			return m_stream->ReadStreamPartial(m_offset + offset, buf, length);
 		}
 
+		void ReadStreamPartialVectored(std::span<ReadRequest> requests) const override;
+
+		void ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const override {
+			if (offset >= m_size)
+				return callback(0, nullptr);
+			length = std::min(length, m_size - offset);
+			m_stream->ReadStreamPartialAsync(m_offset + offset, buf, length, std::move(callback));
+		}
+
 		std::string DescribeState() const override {
 			return std::format("RandomAccessStreamPartialView({}, {}, {})", m_stream->DescribeState(), m_offset, m_size);
 		}
@@ -204,6 +302,20 @@ namespace Sqex {
 		const uint64_t m_offset;
 		const uint64_t m_size;
 
+		struct AsyncReadOverlapped : OVERLAPPED {
+			std::shared_ptr<const RandomAccessStream> KeepAlive;
+			ReadCompletionCallback Callback;
+		};
+
+		// Overlapped handle to the same file, bound to the process default thread pool; opened on first asynchronous read.
+		mutable std::mutex m_asyncMtx;
+		mutable bool m_asyncInitialized = false;
+		mutable Win32::Handle m_asyncFile;
+		mutable PTP_IO m_asyncIo = nullptr;
+
+		void EnsureOpened() const;
+		[[nodiscard]] PTP_IO EnsureAsyncOpened() const;
+
 	public:
 		FileRandomAccessStream(Win32::Handle file, uint64_t offset = 0, uint64_t length = UINT64_MAX);
 		FileRandomAccessStream(std::filesystem::path path, uint64_t offset = 0, uint64_t length = UINT64_MAX, bool openImmediately = true);
@@ -212,6 +324,12 @@ namespace Sqex {
 		[[nodiscard]] uint64_t StreamSize() const override;
 		uint64_t ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const override;
 
+		// Adjacent ranges are read with a single ReadFile call.
+		void ReadStreamPartialVectored(std::span<ReadRequest> requests) const override;
+
+		// Uses overlapped I/O if the file can be reopened for it; otherwise, falls back to the default implementation.
+		void ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const override;
+
 		std::string DescribeState() const override {
 			return std::format("FileRandomAccessStream({}, {}, {})", m_file.GetPathName(), m_offset, m_size);
 		}
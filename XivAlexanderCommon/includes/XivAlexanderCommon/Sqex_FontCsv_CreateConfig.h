@@ -147,6 +147,7 @@ namespace Sqex::FontCsv::CreateConfig {
 	struct FontCreateConfig {
 		uint16_t glyphGap{};
 		bool compactLayout{};
+		bool skylinePacking{};
 		uint16_t textureWidth{};
 		uint16_t textureHeight{};
 		Texture::Format textureFormat{};
@@ -70,7 +70,24 @@ namespace Sqex::FontCsv {
 			const std::unique_ptr<Implementation> m_pImpl;
 
 		public:
-			RenderTarget(uint16_t textureWidth, uint16_t textureHeight, uint16_t glyphGap);
+			enum class PackingMode {
+				// Fills rows from left to right in the order glyphs are queued.
+				Shelf,
+				// Puts each glyph at the lowest position along the top edge of what is already placed, in any mipmap with room left.
+				Skyline,
+			};
+
+			struct PackingStatistics {
+				size_t GlyphCount;
+				size_t PlaneCount;  // Single channel mipmaps; Finalize merges every 4 into one texture.
+				uint64_t UsedArea;  // Area covered by glyph bounding boxes, in pixels.
+				uint64_t TotalArea;
+
+				[[nodiscard]] size_t TextureCount() const { return (PlaneCount + 3) / 4; }
+				[[nodiscard]] double FillRatio() const { return TotalArea ? static_cast<double>(UsedArea) / static_cast<double>(TotalArea) : 0; }
+			};
+
+			RenderTarget(uint16_t textureWidth, uint16_t textureHeight, uint16_t glyphGap, PackingMode packing = PackingMode::Shelf);
 			~RenderTarget();
 
 			void Finalize(Texture::Format textureFormat = Texture::Format::RGBA4444);
@@ -80,6 +97,12 @@ namespace Sqex::FontCsv {
 
 			[[nodiscard]] uint16_t TextureWidth() const;
 			[[nodiscard]] uint16_t TextureHeight() const;
+			[[nodiscard]] PackingMode Packing() const;
+			[[nodiscard]] PackingStatistics GetPackingStatistics() const;
+
+			// Draws c at (x, y) into an L8 mipmap, surrounded by a border of borderThickness pixels drawn at borderOpacity.
+			// With a border, the glyph itself is drawn at (x + borderThickness, y + borderThickness).
+			static void DrawGlyph(Texture::MemoryBackedMipmap* to, SSIZE_T x, SSIZE_T y, char32_t c, const SeCompatibleDrawableFont<uint8_t>* font, uint8_t borderThickness, uint8_t borderOpacity);
 
 		protected:
 			struct AllocatedSpace {
@@ -114,6 +137,7 @@ namespace Sqex::FontCsv {
 		struct ResultFontSet {
 			std::map<std::string, std::shared_ptr<ModifiableFontCsvStream>> Fonts;
 			std::vector<std::shared_ptr<Texture::ModifiableTextureStream>> Textures;
+			FontCsvCreator::RenderTarget::PackingStatistics Statistics{};
 		};
 
 		struct ResultFontSets {
@@ -7,6 +7,36 @@
 namespace Sqex::FontCsv {
 
 	class FreeTypeFont : public virtual SeCompatibleFont {
+	public:
+		// Rendered glyphs, shared between fonts that load the same face at the same size with the same flags.
+		// Lookups take no locks. Glyphs stay until the cache is destroyed, and once maxBytes worth of glyphs are held,
+		// further glyphs are rendered every time they are asked for.
+		class GlyphBitmapCache {
+		public:
+			struct Glyph {
+				GlyphMeasurement Bbox;  // At (0, 0), without advance width delta applied.
+				uint32_t Levels = 0;
+				std::vector<uint8_t> Bitmap;  // Bbox.Width() * Bbox.Height() pixels.
+			};
+
+		private:
+			struct Implementation;
+			const std::unique_ptr<Implementation> m_pImpl;
+
+		public:
+			GlyphBitmapCache(size_t maxBytes = 256 * 1048576);
+			~GlyphBitmapCache();
+
+			[[nodiscard]] uint32_t GetFontId(const std::filesystem::path& path, int faceIndex, float size, FT_Int32 loadFlags);
+			[[nodiscard]] std::shared_ptr<const Glyph> Find(uint32_t fontId, char32_t c) const;
+
+			// Returns the glyph already in the cache under the same key if another thread got there first, or glyph otherwise.
+			std::shared_ptr<const Glyph> Insert(uint32_t fontId, char32_t c, std::shared_ptr<const Glyph> glyph);
+
+			[[nodiscard]] size_t GlyphCount() const;
+			[[nodiscard]] size_t ByteCount() const;
+		};
+
 	protected:
 		const FT_Int32 m_loadFlags;
 
@@ -45,7 +75,12 @@ namespace Sqex::FontCsv {
 		[[nodiscard]] const std::map<std::pair<char32_t, char32_t>, SSIZE_T>& GetKerningTable() const override;
 		[[nodiscard]] GlyphMeasurement Measure(SSIZE_T x, SSIZE_T y, char32_t c) const override;
 
+		// Must be called before the font gets used from multiple threads.
+		void SetGlyphBitmapCache(std::shared_ptr<GlyphBitmapCache> cache);
+
 	protected:
+		[[nodiscard]] std::shared_ptr<const GlyphBitmapCache::Glyph> RenderGlyph(char32_t c) const;
+
 		class FtFaceCtxMgr {
 			const FreeTypeFont* m_owner;
 			Implementation* m_impl;
@@ -139,31 +174,20 @@ namespace Sqex::FontCsv {
 		using SeCompatibleDrawableFont<DestPixFmt, OpacityType>::Draw;
 
 		GlyphMeasurement Draw(Texture::MemoryBackedMipmap* to, SSIZE_T x, SSIZE_T y, char32_t c, const DestPixFmt& fgColor, const DestPixFmt& bgColor, OpacityType fgOpacity, OpacityType bgOpacity) const override {
-			const auto face = GetFace(c, FT_LOAD_RENDER);
-			const auto bbox = face.ToMeasurement(x, y);
-			if (bbox.empty)
-				return bbox;
-
-			FT_Bitmap target;
-			auto temporaryTarget = false;
-			const auto targetCleanup = CallOnDestruction([&face, &target, &temporaryTarget]() {
-				if (temporaryTarget)
-					Succ(FT_Bitmap_Done(face.GetLibraryUnprotected(), &target));
-			});
-			if (face->glyph->bitmap.width != face->glyph->bitmap.pitch) {
-				FT_Bitmap_Init(&target);
-				Succ(FT_Bitmap_Convert(face.GetLibraryUnprotected(), &face->glyph->bitmap, &target, 1));
-				temporaryTarget = true;
-			} else
-				target = face->glyph->bitmap;
-
-			const auto srcBuf = std::span(target.buffer, bbox.Area());
-
-			if (!srcBuf.empty()) {
+			const auto glyph = RenderGlyph(c);
+			if (glyph->Bbox.empty)
+				return glyph->Bbox;
+
+			auto bbox = glyph->Bbox;
+			bbox.advanceX += m_advanceWidthDelta;
+			bbox.Translate(x, y);
+
+			if (!glyph->Bitmap.empty()) {
 				const auto destWidth = static_cast<SSIZE_T>(to->Width());
 				const auto destHeight = static_cast<SSIZE_T>(to->Height());
 				const auto srcWidth = bbox.Width();
 				const auto srcHeight = bbox.Height();
+				const auto srcBuf = glyph->Bitmap.data();
 
 				GlyphMeasurement src = {false, 0, 0, srcWidth, srcHeight};
 				auto dest = bbox;
@@ -171,18 +195,18 @@ namespace Sqex::FontCsv {
 
 				if (!src.EffectivelyEmpty() && !dest.EffectivelyEmpty()) {
 					auto destBuf = to->View<DestPixFmt>();
-					switch (target.num_grays) {
+					switch (glyph->Levels) {
 						case 2:
-							RgbBitmapCopy<uint8_t, FreeTypeDrawingFont_GetEffectiveOpacity<2>, DestPixFmt, OpacityType>::CopyTo(src, dest, &srcBuf[0], &destBuf[0], srcWidth, srcHeight, destWidth, fgColor, bgColor, fgOpacity, bgOpacity);
+							RgbBitmapCopy<uint8_t, FreeTypeDrawingFont_GetEffectiveOpacity<2>, DestPixFmt, OpacityType>::CopyTo(src, dest, srcBuf, &destBuf[0], srcWidth, srcHeight, destWidth, fgColor, bgColor, fgOpacity, bgOpacity);
 							break;
 						case 4:
-							RgbBitmapCopy<uint8_t, FreeTypeDrawingFont_GetEffectiveOpacity<4>, DestPixFmt, OpacityType>::CopyTo(src, dest, &srcBuf[0], &destBuf[0], srcWidth, srcHeight, destWidth, fgColor, bgColor, fgOpacity, bgOpacity);
+							RgbBitmapCopy<uint8_t, FreeTypeDrawingFont_GetEffectiveOpacity<4>, DestPixFmt, OpacityType>::CopyTo(src, dest, srcBuf, &destBuf[0], srcWidth, srcHeight, destWidth, fgColor, bgColor, fgOpacity, bgOpacity);
 							break;
 						case 16:
-							RgbBitmapCopy<uint8_t, FreeTypeDrawingFont_GetEffectiveOpacity<16>, DestPixFmt, OpacityType>::CopyTo(src, dest, &srcBuf[0], &destBuf[0], srcWidth, srcHeight, destWidth, fgColor, bgColor, fgOpacity, bgOpacity);
+							RgbBitmapCopy<uint8_t, FreeTypeDrawingFont_GetEffectiveOpacity<16>, DestPixFmt, OpacityType>::CopyTo(src, dest, srcBuf, &destBuf[0], srcWidth, srcHeight, destWidth, fgColor, bgColor, fgOpacity, bgOpacity);
 							break;
 						case 256:
-							RgbBitmapCopy<uint8_t, FreeTypeDrawingFont_GetEffectiveOpacity<256>, DestPixFmt, OpacityType>::CopyTo(src, dest, &srcBuf[0], &destBuf[0], srcWidth, srcHeight, destWidth, fgColor, bgColor, fgOpacity, bgOpacity);
+							RgbBitmapCopy<uint8_t, FreeTypeDrawingFont_GetEffectiveOpacity<256>, DestPixFmt, OpacityType>::CopyTo(src, dest, srcBuf, &destBuf[0], srcWidth, srcHeight, destWidth, fgColor, bgColor, fgOpacity, bgOpacity);
 							break;
 						default:
 							throw std::invalid_argument("invalid num_grays");
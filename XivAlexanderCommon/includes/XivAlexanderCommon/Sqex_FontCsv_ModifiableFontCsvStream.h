@@ -10,10 +10,19 @@ namespace Sqex::FontCsv {
 		KerningHeader m_knhd;
 		std::vector<KerningEntry> m_kerningEntries;
 
+		// Built on first lookup after a modification; lookups may happen from multiple threads, modifications may not.
+		struct LookupTable;
+		mutable std::unique_ptr<LookupTable> m_lookup;
+		mutable std::atomic_bool m_lookupValid = false;
+		mutable std::mutex m_lookupMtx;
+
+		const LookupTable& GetLookupTable() const;
+
 	public:
 		ModifiableFontCsvStream();
 		ModifiableFontCsvStream(const RandomAccessStream& stream, bool strict = false);
-		
+		~ModifiableFontCsvStream() override;
+
 		[[nodiscard]] uint64_t StreamSize() const override;
 		uint64_t ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const override;
 
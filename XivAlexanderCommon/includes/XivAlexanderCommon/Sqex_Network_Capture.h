@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+
+#include "Utils_Win32_Handle.h"
+
+namespace Sqex::Network {
+	namespace Structures {
+		struct FFXIVMessage;
+	}
+}
+
+namespace Sqex::Network::Capture {
+	// Bytes of a connection as they came out of recv and went into send, with when they did so.
+	//
+	// File layout: FileHeader, then for each recv or send call, RecordHeader followed by RecordHeader::Length bytes.
+
+	enum class Direction : uint8_t {
+		Recv = 0,
+		Send = 1,
+	};
+
+	struct FileHeader {
+		static constexpr char SignatureValue[8]{'X', 'A', 'C', 'A', 'P', 0, 0, 1};
+
+		char Signature[8];
+		int64_t StartEpochMilliseconds;
+	};
+
+	struct RecordHeader {
+		uint64_t TimestampMicroseconds;  // Since the capture started.
+		uint32_t Length;
+		Direction Direction;
+		uint8_t Padding[3];
+	};
+
+	class Writer {
+		static constexpr size_t FlushThreshold = 65536;
+
+		const Utils::Win32::Handle m_file;
+		const std::chrono::steady_clock::time_point m_start;
+		uint64_t m_fileOffset = 0;
+		std::vector<uint8_t> m_buffer;
+
+	public:
+		explicit Writer(const std::filesystem::path& path);
+		~Writer();
+
+		void Write(Direction direction, std::span<const uint8_t> data);
+		void Flush();
+	};
+
+	class Reader {
+	public:
+		struct Record {
+			uint64_t TimestampMicroseconds;
+			Direction Direction;
+			std::span<const uint8_t> Data;
+		};
+
+	private:
+		std::vector<uint8_t> m_data;
+		std::vector<Record> m_records;  // Refers to m_data.
+
+	public:
+		explicit Reader(const std::filesystem::path& path);
+		Reader(const Reader&) = delete;
+		Reader& operator=(const Reader&) = delete;
+
+		[[nodiscard]] int64_t StartEpochMilliseconds() const;
+		[[nodiscard]] const std::vector<Record>& Records() const { return m_records; }
+	};
+
+	struct ReplayStatistics {
+		size_t RecordCount = 0;
+		size_t ByteCount = 0;
+		std::vector<uint64_t> MessageLatencyNanoseconds;  // Sorted.
+
+		// p is in [0, 1].
+		[[nodiscard]] uint64_t Percentile(double p) const;
+	};
+
+	struct ReplayResult {
+		ReplayStatistics Recv;
+		ReplayStatistics Send;
+		std::chrono::steady_clock::duration Elapsed{};
+	};
+
+	using MessageHandler = std::function<bool(Structures::FFXIVMessage*)>;
+
+	// Feeds the records through SingleStream the way SingleConnection does, without any socket.
+	// A message's latency is from when the record completing its bundle is fed, to when the handler is done with it.
+	// If originalTiming is set, each record is fed when it is due since the first one; otherwise, right after the previous one.
+	[[nodiscard]] ReplayResult Replay(const Reader& reader, bool originalTiming, const MessageHandler& incomingHandler, const MessageHandler& outgoingHandler);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Sqex::Network {
+	namespace Structures {
+		struct FFXIVMessage;
+	}
+
+	// Tells what an IPC message of the interested type may be, judging only from its length and contents,
+	// so that opcodes can be found again after a game update.
+	namespace IpcTypeFinder {
+		// Called for each type a message may be of; dump is set if the message itself is worth looking at as well.
+		using CandidateCallback = std::function<void(const std::string& description, bool dump)>;
+
+		void FindIncoming(const Structures::FFXIVMessage& message, const CandidateCallback& onCandidate);
+		void FindOutgoing(const Structures::FFXIVMessage& message, const CandidateCallback& onCandidate);
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "XaZlib.h"
+
+namespace Sqex::Network {
+	namespace Structures {
+		struct FFXIVBundle;
+		struct FFXIVMessage;
+	}
+
+	// Pending data of one direction of a connection, kept in a ring buffer.
+	// The buffer grows only when asked to hold more than its capacity at once.
+	class SingleStream {
+		std::vector<uint8_t> m_buffer;  // Size is always a power of two.
+		size_t m_readPos = 0;
+		size_t m_writePos = 0;  // m_writePos - m_readPos bytes are pending; both are reset to 0 when drained.
+
+		std::vector<std::span<uint8_t>> m_keptMessages;  // Reused between bundles in TunnelXivStream.
+		std::vector<uint8_t> m_messageBackup;  // Reused between messages in TunnelXivStream.
+
+		[[nodiscard]] size_t Mask() const { return m_buffer.size() - 1; }
+		void Grow(size_t minCapacity);
+
+	public:
+		static constexpr size_t DefaultCapacity = 262144;
+
+		bool m_ending = false;
+		bool m_closed = false;
+
+		Utils::ZlibReusableInflater m_inflater;
+
+		explicit SingleStream(size_t capacity = DefaultCapacity);
+
+		class SingleStreamWriter {
+			SingleStream& m_stream;
+
+		public:
+			SingleStreamWriter(SingleStream& stream)
+				: m_stream(stream) {
+			}
+
+			// Returns contiguous free space of at most count items, which may be shorter than asked.
+			template<typename T>
+			std::span<T> Allocate(size_t count) {
+				if (m_stream.Free() < sizeof(T))
+					m_stream.Grow(m_stream.m_buffer.size() * 2);
+				const auto pos = m_stream.m_writePos & m_stream.Mask();
+				const auto contiguous = std::min(m_stream.Free(), m_stream.m_buffer.size() - pos);
+				return {reinterpret_cast<T*>(&m_stream.m_buffer[pos]), std::min(count, contiguous / sizeof(T))};
+			}
+
+			// Commits count items of what has been returned from the last call to Allocate.
+			template<typename T = uint8_t>
+			size_t Write(size_t count) {
+				m_stream.m_writePos += count * sizeof(T);
+				return count;
+			}
+		};
+
+		SingleStreamWriter Write() {
+			return {*this};
+		}
+
+		void Write(const void* buf, size_t length);
+
+		template<typename T, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
+		void Write(const T& data) {
+			Write(&data, sizeof data);
+		}
+
+		template<typename T = uint8_t, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
+		void Write(const std::span<T>& data) {
+			Write(data.data(), data.size_bytes());
+		}
+
+		// Returns the pending data up to where the buffer wraps around, which may be less than Available.
+		// Consume what has been used and call again to get the rest, or use PeekAll to get everything at once.
+		template<typename T = uint8_t, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
+		[[nodiscard]] std::span<const T> PeekContiguous(size_t count = SIZE_MAX) const {
+			if (m_readPos == m_writePos)
+				return {};
+			const auto pos = m_readPos & Mask();
+			const auto contiguous = std::min(m_writePos - m_readPos, m_buffer.size() - pos);
+			return {reinterpret_cast<const T*>(&m_buffer[pos]), std::min(count, contiguous / sizeof(T))};
+		}
+
+		// Returns all the pending data, after moving it to the beginning of the buffer if it wraps around.
+		[[nodiscard]] std::span<uint8_t> PeekAll();
+
+		template<typename T = uint8_t, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
+		void Consume(size_t count) {
+			m_readPos += count * sizeof(T);
+			if (m_readPos == m_writePos)
+				m_readPos = m_writePos = 0;
+			else if (m_readPos > m_writePos)
+				__debugbreak();
+		}
+
+		template<typename T, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
+		size_t Read(T* buf, size_t count) {
+			count = std::min(count, Available<T>());
+			const auto bytes = count * sizeof(T);
+			const auto pos = m_readPos & Mask();
+			const auto first = std::min(bytes, m_buffer.size() - pos);
+			memcpy(buf, &m_buffer[pos], first);
+			memcpy(reinterpret_cast<uint8_t*>(buf) + first, &m_buffer[0], bytes - first);
+			Consume<T>(count);
+			return count;
+		}
+
+		template<typename T = uint8_t, typename = std::enable_if_t<std::is_standard_layout_v<T>>>
+		[[nodiscard]] size_t Available() const {
+			return (m_writePos - m_readPos) / sizeof(T);
+		}
+
+		[[nodiscard]] size_t Free() const {
+			return m_buffer.size() - (m_writePos - m_readPos);
+		}
+
+		[[nodiscard]] size_t Capacity() const {
+			return m_buffer.size();
+		}
+
+		// Moves complete bundles into target, letting messageMangler modify each message in place or drop it by returning false.
+		// A bundle that cannot be parsed is passed through as-is, and a message for which messageMangler throws is kept as it was;
+		// either is reported to onError if given.
+		void TunnelXivStream(SingleStream& target,
+			const std::function<bool(Structures::FFXIVMessage*)>& messageMangler,
+			const std::function<void(const Structures::FFXIVBundle&, const std::exception&)>& onError = {});
+	};
+}
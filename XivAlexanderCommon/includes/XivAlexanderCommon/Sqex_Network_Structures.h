@@ -4,11 +4,8 @@ namespace Utils {
 	class ZlibReusableInflater;
 }
 
-namespace App {
-	enum class LogCategory;
-}
-
-namespace App::Network::Structures {
+namespace Sqex::Network::Structures {
+	class FFXIVMessageRange;
 
 	struct FFXIVBundle {
 		uint8_t Magic[16];
@@ -26,10 +23,10 @@ namespace App::Network::Structures {
 		static const uint8_t MagicConstant2[sizeof Magic];
 		[[nodiscard]] static std::span<const uint8_t> ExtractFrontTrash(const std::span<const uint8_t>& buf);
 
-		void DebugPrint(LogCategory logCategory, const char* head) const;
+		[[nodiscard]] std::string Describe(const char* head) const;
 
-		[[nodiscard]] static std::vector<std::vector<uint8_t>> SplitMessages(uint16_t expectedMessageCount, const std::span<const uint8_t>& buf);
-		[[nodiscard]] std::vector<std::vector<uint8_t>> GetMessages(Utils::ZlibReusableInflater&) const;
+		// Messages are in this bundle if it is not compressed, or in the buffer of the inflater otherwise.
+		[[nodiscard]] FFXIVMessageRange GetMessages(Utils::ZlibReusableInflater&);
 	};
 
 	constexpr size_t GamePacketHeaderSize = offsetof(FFXIVBundle, Data);
@@ -251,6 +248,45 @@ namespace App::Network::Structures {
 			IPCMessageData IPC;
 		} Data;
 
-		void DebugPrint(LogCategory logCategory, const char* head, bool dump = false) const;
+		[[nodiscard]] std::string Describe(const char* head, bool dump = false) const;
+	};
+
+	// Messages laid out back to back in a buffer, referred to without being copied.
+	class FFXIVMessageRange {
+		std::span<uint8_t> m_data;
+
+	public:
+		class Iterator {
+			uint8_t* m_ptr;
+			uint8_t* m_end;
+			size_t m_length;  // Taken before the message is handed out, so that the message may be modified in place.
+
+		public:
+			Iterator(uint8_t* ptr, uint8_t* end)
+				: m_ptr(ptr)
+				, m_end(end)
+				, m_length(ptr == end ? 0 : reinterpret_cast<const FFXIVMessage*>(ptr)->Length) {
+			}
+
+			FFXIVMessage& operator*() const { return *reinterpret_cast<FFXIVMessage*>(m_ptr); }
+			FFXIVMessage* operator->() const { return reinterpret_cast<FFXIVMessage*>(m_ptr); }
+
+			// The whole message, by the length it had before being handed out.
+			[[nodiscard]] std::span<uint8_t> Span() const { return {m_ptr, m_length}; }
+
+			Iterator& operator++() {
+				m_ptr += m_length;
+				m_length = m_ptr == m_end ? 0 : reinterpret_cast<const FFXIVMessage*>(m_ptr)->Length;
+				return *this;
+			}
+
+			bool operator==(const Iterator& r) const { return m_ptr == r.m_ptr; }
+		};
+
+		// Throws if any message is empty or runs past the end of data.
+		explicit FFXIVMessageRange(std::span<uint8_t> data);
+
+		[[nodiscard]] Iterator begin() const { return {m_data.data(), m_data.data() + m_data.size()}; }
+		[[nodiscard]] Iterator end() const { return {m_data.data() + m_data.size(), m_data.data() + m_data.size()}; }
 	};
 }
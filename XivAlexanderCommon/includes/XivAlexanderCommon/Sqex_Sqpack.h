@@ -355,6 +355,22 @@ namespace Sqex::Sqpack {
 	uint32_t SqexHash(const std::string_view& text);
 	uint32_t SqexHash(const std::filesystem::path& path);
 
+	struct SqexPathHashes {
+		uint32_t PathHash;
+		uint32_t NameHash;
+		uint32_t FullPathHash;
+	};
+
+	// Same as hashing parent_path(), filename() and the whole of the lexically normalized path separately,
+	// but done in one pass without allocating for relative paths that are already normalized, as game paths are.
+	SqexPathHashes SqexHashPath(std::string_view path);
+
+	// Same as above, for a path that is already lexically normal.
+	SqexPathHashes SqexHashPath(const std::filesystem::path& path);
+
+	// Calls SqexHashPath on each of paths, in parallel if there are many.
+	void SqexHashPaths(std::span<const std::string_view> paths, std::span<SqexPathHashes> result);
+
 	struct EntryPathSpec {
 		static constexpr auto EmptyHashValue = 0xFFFFFFFF;
 
@@ -409,39 +425,31 @@ namespace Sqex::Sqpack {
 			, FullPathHash(fullPathHash) {
 		}
 
+		EntryPathSpec(const SqexPathHashes& hashes, const std::string& fullPath)
+			: EntryPathSpec(hashes.PathHash, hashes.NameHash, hashes.FullPathHash, fullPath) {
+		}
+
 		EntryPathSpec(const std::filesystem::path& fullPath)
-			: FullPath(fullPath.lexically_normal())
-			, PathHash(SqexHash(FullPath.parent_path()))
-			, NameHash(SqexHash(FullPath.filename()))
-			, FullPathHash(SqexHash(FullPath)) {
+			: FullPath(fullPath.lexically_normal()) {
+			SetHashes(SqexHashPath(FullPath));
 		}
 
 		EntryPathSpec(const std::string& fullPath)
-			: FullPath(std::filesystem::path(Utils::FromUtf8(fullPath)).lexically_normal())
-			, PathHash(SqexHash(FullPath.parent_path()))
-			, NameHash(SqexHash(FullPath.filename()))
-			, FullPathHash(SqexHash(FullPath)) {
+			: EntryPathSpec(SqexHashPath(std::string_view(fullPath)), fullPath) {
 		}
 
 		EntryPathSpec(const std::wstring& fullPath)
-			: FullPath(std::filesystem::path(fullPath).lexically_normal())
-			, PathHash(SqexHash(FullPath.parent_path()))
-			, NameHash(SqexHash(FullPath.filename()))
-			, FullPathHash(SqexHash(FullPath)) {
+			: FullPath(std::filesystem::path(fullPath).lexically_normal()) {
+			SetHashes(SqexHashPath(FullPath));
 		}
 
 		EntryPathSpec(const char* fullPath)
-			: FullPath(std::filesystem::path(Utils::FromUtf8(fullPath)).lexically_normal())
-			, PathHash(SqexHash(FullPath.parent_path()))
-			, NameHash(SqexHash(FullPath.filename()))
-			, FullPathHash(SqexHash(FullPath)) {
+			: EntryPathSpec(std::string(fullPath)) {
 		}
 
 		EntryPathSpec(const wchar_t* fullPath)
-			: FullPath(std::filesystem::path(fullPath).lexically_normal())
-			, PathHash(SqexHash(FullPath.parent_path()))
-			, NameHash(SqexHash(FullPath.filename()))
-			, FullPathHash(SqexHash(FullPath)) {
+			: FullPath(std::filesystem::path(fullPath).lexically_normal()) {
+			SetHashes(SqexHashPath(FullPath));
 		}
 
 		EntryPathSpec(const std::filesystem::path& path, const std::filesystem::path& name)
@@ -453,21 +461,23 @@ namespace Sqex::Sqpack {
 
 		EntryPathSpec& operator=(const std::filesystem::path& fullPath) {
 			FullPath = fullPath.lexically_normal();
-			PathHash = SqexHash(FullPath.parent_path());
-			NameHash = SqexHash(FullPath.filename());
-			FullPathHash = SqexHash(FullPath);
+			SetHashes(SqexHashPath(FullPath));
 			return *this;
 		}
 
 		template<class Elem, class Traits = std::char_traits<Elem>, class Alloc = std::allocator<Elem>>
 		EntryPathSpec& operator=(const std::basic_string<Elem, Traits, Alloc>& fullPath) {
 			FullPath = std::filesystem::path(fullPath).lexically_normal();
-			PathHash = SqexHash(FullPath.parent_path());
-			NameHash = SqexHash(FullPath.filename());
-			FullPathHash = SqexHash(FullPath);
+			SetHashes(SqexHashPath(FullPath));
 			return *this;
 		}
 
+		void SetHashes(const SqexPathHashes& hashes) {
+			PathHash = hashes.PathHash;
+			NameHash = hashes.NameHash;
+			FullPathHash = hashes.FullPathHash;
+		}
+
 		EntryPathSpec& operator=(uint32_t fullPathHash) {
 			FullPath.clear();
 			PathHash = EmptyHashValue;
@@ -2,6 +2,7 @@
 
 #include "Sqex_Sqpack.h"
 #include "Sqex_Sqpack_EntryProvider.h"
+#include "Sqex_Sqpack_EntryTable.h"
 #include "Utils_ListenerManager.h"
 #include "Utils_Win32_Handle.h"
 
@@ -12,6 +13,7 @@ namespace Sqex::ThirdParty::TexTools {
 namespace Sqex::Sqpack {
 	class Creator {
 		const uint64_t m_maxFileSize;
+		CompressionPolicy m_compressionPolicy = CompressionPolicy::Stored;
 		
 	public:
 		const std::string DatExpac;
@@ -27,6 +29,10 @@ namespace Sqex::Sqpack {
 
 		ListenerManager<Implementation, void, const std::string&> Log;
 
+		// How entries added from loose files are compressed. Stored entries are served directly from the files on read.
+		[[nodiscard]] CompressionPolicy EntryCompressionPolicy() const { return m_compressionPolicy; }
+		void EntryCompressionPolicy(CompressionPolicy policy) { m_compressionPolicy = policy; }
+
 		struct AddEntryResult {
 			std::vector<EntryProvider*> Added;
 			std::vector<EntryProvider*> Replaced;
@@ -72,8 +78,7 @@ namespace Sqex::Sqpack {
 			std::shared_ptr<RandomAccessStream> Index2;
 			std::vector<std::shared_ptr<RandomAccessStream>> Data;
 			std::vector<Entry*> Entries;
-			std::map<EntryPathSpec, std::unique_ptr<Entry>, EntryPathSpec::AllHashComparator> HashOnlyEntries;
-			std::map<EntryPathSpec, std::unique_ptr<Entry>, EntryPathSpec::FullPathComparator> FullPathEntries;
+			EntryTable<std::unique_ptr<Entry>> EntriesByPath;
 		};
 		SqpackViews AsViews(bool strict);
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <mutex>
+
+#include "Sqex.h"
+
+namespace Sqex::Sqpack {
+	// Content-addressed directory of packed sqpack entries, so that entries that are expensive to build are built only once across launches.
+	class EntryCache {
+		struct FileHeader {
+			static constexpr char Signature_Value[8]{'X', 'a', 'E', 'n', 't', 'C', '0', '1'};
+
+			char Signature[8];
+			LE<uint64_t> EntrySize;
+		};
+
+		mutable std::mutex m_mtx;
+		std::filesystem::path m_dir;
+		uint64_t m_maxSize = 0;
+		uint64_t m_totalSize = 0;
+
+		void EvictUntil(uint64_t size);
+
+	public:
+		static constexpr uint64_t DefaultMaxSize = 1024ULL * 1048576;
+
+		static EntryCache& Instance();
+
+		// Sets where cached entries are stored. An empty path disables caching.
+		void Configure(std::filesystem::path dir, uint64_t maxSize = DefaultMaxSize);
+
+		[[nodiscard]] bool Enabled() const;
+
+		// Key for an entry built from a file, identified by its path, size and last modification time.
+		[[nodiscard]] static std::string MakeKey(std::string_view tag, const std::filesystem::path& source);
+
+		// Key for an entry built from a stream without a backing file, identified by its size and content.
+		[[nodiscard]] static std::string MakeKey(std::string_view tag, const RandomAccessStream& source);
+
+		// Returns a stream of the cached entry, or nullptr if there is none.
+		[[nodiscard]] std::shared_ptr<const RandomAccessStream> Find(const std::string& key);
+
+		// Stores an entry; failures are ignored, as the entry can always be built again.
+		void Put(const std::string& key, const RandomAccessStream& entry);
+	};
+}
@@ -12,6 +12,14 @@ namespace Sqex::Sqpack {
 	static constexpr uint16_t BlockPadSize = (EntryAlignment - BlockValidSize) % EntryAlignment;
 	static constexpr uint16_t BlockSize = BlockValidSize + BlockPadSize;
 
+	// How blocks are compressed when building entries from uncompressed data.
+	enum class CompressionPolicy {
+		Best,  // Z_BEST_COMPRESSION
+		Fast,  // Z_BEST_SPEED
+		Stored,  // blocks are stored uncompressed
+		Adaptive,  // blocks that look incompressible from their byte entropy are stored, and the rest use the default level
+	};
+
 	class EntryProvider : public RandomAccessStream {
 		EntryPathSpec m_pathSpec;
 
@@ -40,6 +48,15 @@ namespace Sqex::Sqpack {
 
 		[[nodiscard]] virtual SqData::FileEntryType EntryType() const = 0;
 
+		struct SharedStorageRange {
+			std::shared_ptr<const RandomAccessStream> Stream;
+			uint64_t Offset = 0;
+			uint64_t Size = 0;  // This entry reads as zeros past this many bytes, instead of whatever follows in Stream.
+		};
+
+		// If this entry is a read-only view into a stream shared with other entries, returns the stream and where this entry is in it.
+		[[nodiscard]] virtual SharedStorageRange SharedStorage() const { return {}; }
+
 		std::string DescribeState() const override { return std::format("EntryProvider({})", m_pathSpec); }
 	};
 
@@ -63,6 +80,7 @@ namespace Sqex::Sqpack {
 	class LazyFileOpeningEntryProvider : public EntryProvider {
 		const std::filesystem::path m_path;
 		const std::shared_ptr<const RandomAccessStream> m_stream;
+		std::shared_ptr<const RandomAccessStream> m_cached;
 		mutable std::shared_ptr<std::mutex> m_initializationMutex;
 
 	protected:
@@ -82,6 +100,9 @@ namespace Sqex::Sqpack {
 		virtual uint64_t MaxPossibleStreamSize() const { return UINT64_MAX; }
 		virtual [[nodiscard]] uint64_t StreamSize(const RandomAccessStream& stream) const = 0;
 		virtual uint64_t ReadStreamPartial(const RandomAccessStream& stream, uint64_t offset, void* buf, uint64_t length) const = 0;
+
+		// Tag to store built entries in EntryCache with; empty if building is cheap enough to not bother.
+		[[nodiscard]] virtual std::string EntryCacheTag() const { return {}; }
 	};
 
 	class OnTheFlyBinaryEntryProvider : public LazyFileOpeningEntryProvider {
@@ -106,10 +127,20 @@ namespace Sqex::Sqpack {
 	};
 
 	class MemoryBinaryEntryProvider : public LazyFileOpeningEntryProvider {
+		const CompressionPolicy m_compressionPolicy;
 		std::vector<char> m_data;
 
 	public:
-		using LazyFileOpeningEntryProvider::LazyFileOpeningEntryProvider;
+		MemoryBinaryEntryProvider(EntryPathSpec pathSpec, std::filesystem::path path, bool openImmediately = false, CompressionPolicy compressionPolicy = CompressionPolicy::Best)
+			: LazyFileOpeningEntryProvider(std::move(pathSpec), std::move(path), openImmediately)
+			, m_compressionPolicy(compressionPolicy) {
+		}
+
+		MemoryBinaryEntryProvider(EntryPathSpec pathSpec, std::shared_ptr<const RandomAccessStream> stream, CompressionPolicy compressionPolicy = CompressionPolicy::Best)
+			: LazyFileOpeningEntryProvider(std::move(pathSpec), std::move(stream))
+			, m_compressionPolicy(compressionPolicy) {
+		}
+
 		using LazyFileOpeningEntryProvider::StreamSize;
 		using LazyFileOpeningEntryProvider::ReadStreamPartial;
 
@@ -119,6 +150,7 @@ namespace Sqex::Sqpack {
 
 	protected:
 		void Initialize(const RandomAccessStream& stream) override;
+		[[nodiscard]] std::string EntryCacheTag() const override { return std::format("MemoryBinaryEntryProvider/1/{}", static_cast<int>(m_compressionPolicy)); }
 		[[nodiscard]] uint64_t StreamSize(const RandomAccessStream& stream) const override { return static_cast<uint32_t>(m_data.size()); }
 		uint64_t ReadStreamPartial(const RandomAccessStream& stream, uint64_t offset, void* buf, uint64_t length) const override;
 	};
@@ -196,10 +228,20 @@ namespace Sqex::Sqpack {
 	};
 
 	class MemoryTextureEntryProvider : public LazyFileOpeningEntryProvider {
+		const CompressionPolicy m_compressionPolicy;
 		std::vector<uint8_t> m_data;
 
 	public:
-		using LazyFileOpeningEntryProvider::LazyFileOpeningEntryProvider;
+		MemoryTextureEntryProvider(EntryPathSpec pathSpec, std::filesystem::path path, bool openImmediately = false, CompressionPolicy compressionPolicy = CompressionPolicy::Best)
+			: LazyFileOpeningEntryProvider(std::move(pathSpec), std::move(path), openImmediately)
+			, m_compressionPolicy(compressionPolicy) {
+		}
+
+		MemoryTextureEntryProvider(EntryPathSpec pathSpec, std::shared_ptr<const RandomAccessStream> stream, CompressionPolicy compressionPolicy = CompressionPolicy::Best)
+			: LazyFileOpeningEntryProvider(std::move(pathSpec), std::move(stream))
+			, m_compressionPolicy(compressionPolicy) {
+		}
+
 		using LazyFileOpeningEntryProvider::StreamSize;
 		using LazyFileOpeningEntryProvider::ReadStreamPartial;
 
@@ -209,6 +251,7 @@ namespace Sqex::Sqpack {
 
 	protected:
 		void Initialize(const RandomAccessStream& stream) override;
+		[[nodiscard]] std::string EntryCacheTag() const override { return std::format("MemoryTextureEntryProvider/1/{}", static_cast<int>(m_compressionPolicy)); }
 		[[nodiscard]] uint64_t StreamSize(const RandomAccessStream& stream) const override { return static_cast<uint32_t>(m_data.size()); }
 		uint64_t ReadStreamPartial(const RandomAccessStream& stream, uint64_t offset, void* buf, uint64_t length) const override;
 	};
@@ -242,6 +285,15 @@ namespace Sqex::Sqpack {
 			return m_stream->ReadStreamPartial(m_offset + offset, buf, static_cast<size_t>(std::min(length, m_size - offset)));
 		}
 
+		void ReadStreamPartialVectored(std::span<ReadRequest> requests) const override;
+
+		void ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const override {
+			if (offset >= m_size)
+				return callback(0, nullptr);
+
+			m_stream->ReadStreamPartialAsync(m_offset + offset, buf, std::min(length, m_size - offset), std::move(callback));
+		}
+
 		[[nodiscard]] SqData::FileEntryType EntryType() const override {
 			if (!m_entryTypeFetched) {
 				// operation that should be lightweight enough that lock should not be needed
@@ -251,6 +303,10 @@ namespace Sqex::Sqpack {
 			return m_entryType;
 		}
 
+		[[nodiscard]] SharedStorageRange SharedStorage() const override {
+			return {m_stream, m_offset, m_size};
+		}
+
 		std::string DescribeState() const override {
 			return std::format("RandomAccessStreamAsEntryProviderView({}, {}, {})", m_stream->DescribeState(), m_offset, m_size);
 		}
@@ -288,6 +344,15 @@ namespace Sqex::Sqpack {
 
 		uint64_t ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const override;
 
+		void ReadStreamPartialVectored(std::span<ReadRequest> requests) const override;
+
+		void ReadStreamPartialAsync(uint64_t offset, void* buf, uint64_t length, ReadCompletionCallback callback) const override;
+
+		// Only the base stream is shared; an override stream may be swapped in at any time.
+		[[nodiscard]] SharedStorageRange SharedStorage() const override {
+			return m_stream || !m_baseStream ? SharedStorageRange() : m_baseStream->SharedStorage();
+		}
+
 		[[nodiscard]] SqData::FileEntryType EntryType() const override {
 			return m_stream ? m_stream->EntryType() : (m_baseStream ? m_baseStream->EntryType() : EmptyEntryProvider::EntryType());
 		}
@@ -1,9 +1,78 @@
 #pragma once
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
 #include "Sqex_Model.h"
 #include "Sqex_Sqpack.h"
 #include "Sqex_Sqpack_EntryProvider.h"
 
 namespace Sqex::Sqpack {
+	// Process-wide LRU cache of decoded blocks, keyed by the stream containing the block and the offset of the block in it.
+	class DecodedBlockCache {
+	public:
+		struct Statistics {
+			uint64_t Hits;
+			uint64_t Misses;
+			uint64_t Evictions;
+			size_t Entries;
+			size_t Bytes;
+			size_t Capacity;
+		};
+
+	private:
+		struct Key {
+			const RandomAccessStream* Stream;
+			uint64_t Offset;
+
+			bool operator==(const Key&) const = default;
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const {
+				return std::hash<const void*>()(key.Stream) ^ std::hash<uint64_t>()(key.Offset * 0x9E3779B97F4A7C15ULL);
+			}
+		};
+
+		struct Item {
+			Key Id;
+			std::weak_ptr<const RandomAccessStream> Stream;  // to tell apart a new stream allocated at the address of a released one
+			std::shared_ptr<const std::vector<uint8_t>> Data;
+		};
+
+		mutable std::mutex m_mtx;
+		std::list<Item> m_items;  // most recently used first
+		std::unordered_map<Key, std::list<Item>::iterator, KeyHash> m_index;
+		size_t m_bytes = 0;
+		size_t m_capacity;
+		uint64_t m_hits = 0;
+		uint64_t m_misses = 0;
+		uint64_t m_evictions = 0;
+
+		void EvictUntil(size_t bytes);
+		void Erase(std::list<Item>::iterator it);
+
+	public:
+		static constexpr size_t DefaultCapacity = 32 * 1048576;
+
+		DecodedBlockCache(size_t capacity = DefaultCapacity);
+
+		static DecodedBlockCache& Instance();
+
+		[[nodiscard]] size_t Capacity() const;
+
+		// Setting capacity to 0 disables caching and releases everything cached.
+		void Capacity(size_t capacity);
+
+		[[nodiscard]] Statistics GetStatistics() const;
+
+		[[nodiscard]] std::shared_ptr<const std::vector<uint8_t>> Find(const std::shared_ptr<const RandomAccessStream>& stream, uint64_t offset);
+
+		void Put(const std::shared_ptr<const RandomAccessStream>& stream, uint64_t offset, std::shared_ptr<const std::vector<uint8_t>> data);
+
+		void Clear();
+	};
+
 	class EntryRawStream : public RandomAccessStream {
 		struct StreamDecoder {
 		private:
@@ -26,6 +95,7 @@ namespace Sqex::Sqpack {
 		protected:
 			[[nodiscard]] const auto& Underlying() const { return *m_stream->m_provider; }
 			[[nodiscard]] const auto& EntryHeader() const { return m_stream->m_entryHeader; }
+			[[nodiscard]] bool ParallelDecompression() const { return m_stream->m_parallelDecompression; }
 		};
 		friend struct StreamDecoder;
 
@@ -72,12 +142,16 @@ namespace Sqex::Sqpack {
 
 		const std::shared_ptr<const EntryProvider> m_providerShared;
 		const EntryProvider* m_provider;
+		const bool m_parallelDecompression;
 		const SqData::FileEntryHeader m_entryHeader;
 		const std::unique_ptr<StreamDecoder> m_decoder;
 
 	public:
-		EntryRawStream(const EntryProvider* provider);
-		EntryRawStream(std::shared_ptr<const EntryProvider> provider);
+		// Reads at least this long inflate their blocks in parallel, if enabled.
+		static constexpr uint64_t ParallelDecompressionMinLength = 8 * BlockDataSize;
+
+		EntryRawStream(const EntryProvider* provider, bool parallelDecompression = false);
+		EntryRawStream(std::shared_ptr<const EntryProvider> provider, bool parallelDecompression = false);
 
 		[[nodiscard]] uint64_t StreamSize() const override {
 			return m_decoder ? m_entryHeader.DecompressedSize.Value() : 0;
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Sqex_Sqpack.h"
+
+namespace Sqex::Sqpack {
+	// Stores each distinct entry path once, as lowercased UTF-8 with forward slashes, and refers to it by a 32-bit id.
+	class PathArena {
+	public:
+		using Id = uint32_t;
+		static constexpr Id NoPath = 0;
+
+	private:
+		static constexpr size_t ChunkSize = 65536;
+
+		std::vector<std::unique_ptr<char[]>> m_chunks;
+		size_t m_chunkUsed = ChunkSize;
+		size_t m_chunkBytes = 0;
+		std::vector<std::string_view> m_paths;  // Indexed by id - 1.
+		std::vector<Id> m_slots;
+		size_t m_mask = 0;
+
+		[[nodiscard]] static std::string Normalize(const EntryPathSpec& pathSpec);
+		[[nodiscard]] size_t FindSlot(std::string_view normalizedPath) const;
+
+	public:
+		PathArena();
+		PathArena(PathArena&&) noexcept;
+		PathArena& operator=(PathArena&&) noexcept;
+		~PathArena();
+
+		// Returns NoPath if pathSpec does not come with its original path.
+		Id Intern(const EntryPathSpec& pathSpec);
+
+		// Returns NoPath if pathSpec does not come with its original path, or if the path has not been interned.
+		[[nodiscard]] Id Find(const EntryPathSpec& pathSpec) const;
+
+		[[nodiscard]] std::string_view operator[](Id id) const { return m_paths[id - 1]; }
+		[[nodiscard]] size_t Count() const { return m_paths.size(); }
+		[[nodiscard]] size_t ByteCount() const;
+	};
+
+	// Keys of a flat entry table. An entry is found by its path if it has one, or by all three of its hashes otherwise.
+	class EntryKeyTable {
+	public:
+		struct Key {
+			uint32_t PathHash;
+			uint32_t NameHash;
+			uint32_t FullPathHash;
+			PathArena::Id PathId;
+		};
+
+		static constexpr size_t NotFound = SIZE_MAX;
+
+	private:
+		PathArena m_arena;
+		std::vector<Key> m_keys;
+		std::vector<uint32_t> m_pathIndex;  // Indexed by path id - 1; entry index + 1, or 0 if none.
+		std::vector<uint32_t> m_hashSlots;  // Entry index + 1, or 0 if empty; may point to entries that got a path later.
+		size_t m_hashSlotUsed = 0;
+		size_t m_mask = 0;
+
+		[[nodiscard]] static size_t Hash(const Key& key);
+		void InsertHashSlot(size_t index);
+		void RebuildHashSlots();
+
+	protected:
+		size_t InsertKey(const EntryPathSpec& pathSpec);
+		void ReserveKeys(size_t count);
+		void ReorderKeys(std::span<const uint32_t> order);
+		[[nodiscard]] std::vector<uint32_t> SortedOrder() const;
+
+	public:
+		EntryKeyTable();
+		EntryKeyTable(EntryKeyTable&&) noexcept;
+		EntryKeyTable& operator=(EntryKeyTable&&) noexcept;
+		~EntryKeyTable();
+
+		[[nodiscard]] size_t FindIndex(const EntryPathSpec& pathSpec) const;
+
+		// Gives the entry at index, found by its hashes so far, the path in pathSpec.
+		void SetPath(size_t index, const EntryPathSpec& pathSpec);
+
+		[[nodiscard]] const Key& KeyAt(size_t index) const { return m_keys[index]; }
+		[[nodiscard]] std::string_view PathAt(size_t index) const;
+		[[nodiscard]] const PathArena& Paths() const { return m_arena; }
+		[[nodiscard]] size_t size() const { return m_keys.size(); }
+		[[nodiscard]] bool empty() const { return m_keys.empty(); }
+		[[nodiscard]] size_t ByteCount() const;
+	};
+
+	template<typename T>
+	class EntryTable : public EntryKeyTable {
+		std::vector<T> m_values;
+
+	public:
+		[[nodiscard]] T* Find(const EntryPathSpec& pathSpec) {
+			const auto index = FindIndex(pathSpec);
+			return index == NotFound ? nullptr : &m_values[index];
+		}
+
+		[[nodiscard]] const T* Find(const EntryPathSpec& pathSpec) const {
+			const auto index = FindIndex(pathSpec);
+			return index == NotFound ? nullptr : &m_values[index];
+		}
+
+		// pathSpec must not be in the table yet.
+		T& Emplace(const EntryPathSpec& pathSpec, T value) {
+			m_values.emplace_back(std::move(value));
+			try {
+				InsertKey(pathSpec);
+			} catch (...) {
+				m_values.pop_back();
+				throw;
+			}
+			return m_values.back();
+		}
+
+		void Reserve(size_t count) {
+			m_values.reserve(count);
+			ReserveKeys(count);
+		}
+
+		// Puts entries without paths first in the order of their hashes, and then the rest in the order of their paths.
+		void Sort() {
+			const auto order = SortedOrder();
+			std::vector<T> values;
+			values.reserve(m_values.size());
+			for (const auto i : order)
+				values.emplace_back(std::move(m_values[i]));
+			m_values = std::move(values);
+			ReorderKeys(order);
+		}
+
+		[[nodiscard]] T& operator[](size_t index) { return m_values[index]; }
+		[[nodiscard]] const T& operator[](size_t index) const { return m_values[index]; }
+		[[nodiscard]] std::span<T> Values() { return m_values; }
+		[[nodiscard]] std::span<const T> Values() const { return m_values; }
+
+		[[nodiscard]] size_t ByteCount() const {
+			return EntryKeyTable::ByteCount() + m_values.capacity() * sizeof(T);
+		}
+	};
+}
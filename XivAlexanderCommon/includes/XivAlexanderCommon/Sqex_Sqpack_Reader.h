@@ -1,14 +1,41 @@
 #pragma once
 
+#include <mutex>
+
 #include "Sqex_Sqpack.h"
 #include "Utils_Win32_Handle.h"
 #include "Sqex_Sqpack_EntryProvider.h"
+#include "Sqex_Sqpack_EntryTable.h"
 
 namespace Sqex::Sqpack {
 	struct Reader {
+		// Open addressing hash table mapping hash values to locators, to avoid binary searches on frequent lookups.
+		class LocatorLookupTable {
+			struct Slot {
+				uint64_t Key;
+				const SqIndex::LEDataLocator* Locator;
+			};
+
+			std::vector<Slot> m_slots;
+			size_t m_mask = 0;
+
+			[[nodiscard]] static size_t Hash(uint64_t key);
+
+		public:
+			LocatorLookupTable() = default;
+			explicit LocatorLookupTable(size_t count);
+
+			void Insert(uint64_t key, const SqIndex::LEDataLocator& locator);
+			[[nodiscard]] const SqIndex::LEDataLocator* Find(uint64_t key) const;
+			[[nodiscard]] bool Empty() const { return m_slots.empty(); }
+		};
+
 		template<typename HashLocatorT, typename TextLocatorT> 
 		struct SqIndexType {
-			const std::vector<uint8_t> Data;
+			// Only one of DataView and DataBuffer holds the index file content; Data points to whichever is in use.
+			const Win32::FileMapping::View DataView;
+			const std::vector<uint8_t> DataBuffer;
+			const std::span<const uint8_t> Data;
 			const SqpackHeader& Header{};
 			const SqIndex::Header& IndexHeader{};
 			const std::span<const HashLocatorT> HashLocators;
@@ -22,28 +49,36 @@ namespace Sqex::Sqpack {
 				return it->Locator;
 			}
 
+			[[nodiscard]] bool IsMemoryMapped() const { return !!DataView; }
+
 		protected:
 			friend struct Reader;
-			SqIndexType(const Win32::Handle& hFile, bool strictVerify);
+			SqIndexType(const Win32::Handle& hFile, bool strictVerify, bool memoryMapped);
 		};
 
 		struct SqIndex1Type : SqIndexType<SqIndex::PairHashLocator, SqIndex::PairHashWithTextLocator> {
 			const std::span<const SqIndex::PathHashLocator> PathHashLocators;
 
+			// Keyed by (PathHash << 32 | NameHash); empty unless requested on construction.
+			const LocatorLookupTable LookupTable;
+
 			std::span<const SqIndex::PairHashLocator> GetPairHashLocators(uint32_t pathHash) const;
 			const SqIndex::LEDataLocator& GetLocator(uint32_t pathHash, uint32_t nameHash) const;
 
 		protected:
 			friend struct Reader;
-			SqIndex1Type(const Win32::Handle& hFile, bool strictVerify);
+			SqIndex1Type(const Win32::Handle& hFile, bool strictVerify, bool memoryMapped, bool buildLookupTable);
 		};
 
 		struct SqIndex2Type : SqIndexType<SqIndex::FullHashLocator, SqIndex::FullHashWithTextLocator> {
+			// Keyed by FullPathHash; empty unless requested on construction.
+			const LocatorLookupTable LookupTable;
+
 			const SqIndex::LEDataLocator& GetLocator(uint32_t fullPathHash) const;
 
 		protected:
 			friend struct Reader;
-			SqIndex2Type(const Win32::Handle& hFile, bool strictVerify);
+			SqIndex2Type(const Win32::Handle& hFile, bool strictVerify, bool memoryMapped, bool buildLookupTable);
 		};
 
 		struct SqDataType {
@@ -56,17 +91,38 @@ namespace Sqex::Sqpack {
 			SqDataType(Win32::Handle hFile, uint32_t datIndex, bool strictVerify);
 		};
 
+		// Paths of entries that come with one are kept in the reader's PathArena; see PathSpecOf.
 		struct EntryInfoType {
-			EntryPathSpec PathSpec;
+			uint32_t PathHash;
+			uint32_t NameHash;
+			uint32_t FullPathHash;
+			PathArena::Id PathId;
 			uint64_t Allocation;
 		};
 
 		SqIndex1Type Index1;
 		SqIndex2Type Index2;
 		std::vector<SqDataType> Data;
-		std::vector<std::pair<SqIndex::LEDataLocator, EntryInfoType>> EntryInfo;
 
-		Reader(const std::filesystem::path& indexFile, bool strictVerify = false);
+	private:
+		// Non-synonym locators and the end of every data file, sorted by position; used to derive allocation sizes.
+		std::vector<SqIndex::LEDataLocator> m_sortedLocators;
+
+		mutable std::once_flag m_entryInfoOnce;
+		mutable std::vector<std::pair<SqIndex::LEDataLocator, EntryInfoType>> m_entryInfo;
+		mutable PathArena m_entryPaths;
+
+	public:
+
+		// If memoryMappedIndex is set, .index and .index2 are mapped read-only instead of being read into private memory.
+		// Falls back to reading into a buffer if the file cannot be mapped.
+		// If buildLookupTables is set, GetLocator uses hash tables instead of binary searches.
+		Reader(const std::filesystem::path& indexFile, bool strictVerify = false, bool memoryMappedIndex = true, bool buildLookupTables = false);
+
+		// Builds the list on first call; path specs are not kept around unless something enumerates the entries.
+		[[nodiscard]] const std::vector<std::pair<SqIndex::LEDataLocator, EntryInfoType>>& GetEntryInfo() const;
+		[[nodiscard]] EntryPathSpec PathSpecOf(const EntryInfoType& entryInfo) const;
+		[[nodiscard]] uint64_t GetAllocation(SqIndex::LEDataLocator locator) const;
 
 		[[nodiscard]] const SqIndex::LEDataLocator& GetLocator(const EntryPathSpec& pathSpec) const;
 		[[nodiscard]] std::shared_ptr<EntryProvider> GetEntryProvider(const EntryPathSpec& pathSpec, SqIndex::LEDataLocator locator, uint64_t allocation) const;
@@ -56,31 +56,31 @@ namespace Sqex::Texture {
 
 	struct RGBA5551 {
 		static constexpr size_t ChannelCount = 4;
-		static constexpr uint8_t MaxR = 31;
-		static constexpr uint8_t MaxG = 31;
-		static constexpr uint8_t MaxB = 31;
-		static constexpr uint8_t MaxA = 1;
+		static constexpr uint16_t MaxR = 31;
+		static constexpr uint16_t MaxG = 31;
+		static constexpr uint16_t MaxB = 31;
+		static constexpr uint16_t MaxA = 1;
 
-		uint8_t R : 5;
-		uint8_t G : 5;
-		uint8_t B : 5;
-		uint8_t A : 1;  // Actually opacity
+		uint16_t R : 5;
+		uint16_t G : 5;
+		uint16_t B : 5;
+		uint16_t A : 1;  // Actually opacity
 
 		void SetFrom(uint32_t r, uint32_t g, uint32_t b) {
-			R = static_cast<uint8_t>(r);
-			G = static_cast<uint8_t>(g);
-			B = static_cast<uint8_t>(b);
+			R = static_cast<uint16_t>(r);
+			G = static_cast<uint16_t>(g);
+			B = static_cast<uint16_t>(b);
 		}
 
 		void SetFrom(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
-			R = static_cast<uint8_t>(r);
-			G = static_cast<uint8_t>(g);
-			B = static_cast<uint8_t>(b);
-			A = static_cast<uint8_t>(a);
+			R = static_cast<uint16_t>(r);
+			G = static_cast<uint16_t>(g);
+			B = static_cast<uint16_t>(b);
+			A = static_cast<uint16_t>(a);
 		}
 	};
 
-	union RGBAHHHH {
+	struct RGBAHHHH {
 		union Float {
 			float Value;
 			uint32_t UintValue;
@@ -106,13 +106,13 @@ namespace Sqex::Texture {
 			} Bits;
 
 			operator float() const {
-				const auto v1 = Float{ .UintValue = (((UintValue & 0x8000U) << 16)
-							| (((UintValue & 0x7c00U) + 0x1C000U) << 13)
-							| ((UintValue & 0x03FFU) << 13)) }.Value;
-				const auto v2 = Float{ .HalfCompatibleBits = {Bits.Sign, Bits.Exponent - 15U + 127U, Bits.Mantissa, 0} }.Value;
-				if (v1 != v2)
-					throw std::runtime_error("test");
-				return v2;
+				// Moving exponent and mantissa into place and scaling by 2^(127-15) rebiases the exponent; subnormal halves become normal floats.
+				auto res = Float{.UintValue = (UintValue & 0x7FFFU) << 13};
+				res.Value *= Float{.UintValue = (254U - 15U) << 23}.Value;
+				if ((UintValue & 0x7FFFU) >= 0x7C00U)
+					res.UintValue |= 0xFFU << 23;  // infinity or NaN
+				res.UintValue |= (UintValue & 0x8000U) << 16;
+				return res.Value;
 			}
 		};
 
@@ -173,6 +173,34 @@ namespace Sqex::Texture {
 
 	size_t RawDataLength(Format type, size_t width, size_t height);
 
+	// Converts pixels stored in an uncompressed format into RGBA8888, using SIMD where possible.
+	void ConvertToRGBA8888(Format type, std::span<const uint8_t> source, std::span<RGBA8888> target);
+
+	// Converts RGBA8888 pixels into an uncompressed format, rounding to the nearest representable value, using SIMD where possible.
+	void ConvertFromRGBA8888(Format type, std::span<const RGBA8888> source, std::span<uint8_t> target);
+
+	// Packs four L8 planes of the same size into RGBA4444 or RGBA8888 pixels, using SIMD where possible.
+	// Each channel is scaled as v * max / 255, rounded down.
+	void InterleaveL8Channels(Format type, std::span<const uint8_t> r, std::span<const uint8_t> g, std::span<const uint8_t> b, std::span<const uint8_t> a, std::span<uint8_t> target);
+
+	enum class MipmapFilter {
+		Box,  // average of each 2x2 block
+		Kaiser,  // Kaiser windowed sinc over 8x8 pixels; sharper than box
+	};
+
+	// Halves RGBA8888 pixels in each direction, in parallel over tiles of rows.
+	// The last column or row of images of odd width or height is dropped, as mipmap sizes are rounded down.
+	std::vector<RGBA8888> HalveRGBA8888(std::span<const RGBA8888> source, size_t width, size_t height, MipmapFilter filter = MipmapFilter::Box);
+
+	enum class DxtEncodeQuality {
+		Fast,  // endpoints from the bounding box of colors
+		High,  // endpoints from the principal axis of colors, refined by least squares
+	};
+
+	// Compresses RGBA8888 pixels into DXT1, DXT3 or DXT5 blocks, in parallel over rows of blocks.
+	// DXT1 blocks are always opaque.
+	std::vector<uint8_t> CompressDXT(Format type, size_t width, size_t height, std::span<const RGBA8888> pixels, DxtEncodeQuality quality = DxtEncodeQuality::High);
+
 	struct Header {
 		LE<uint16_t> Unknown1;
 		LE<uint16_t> HeaderSize;
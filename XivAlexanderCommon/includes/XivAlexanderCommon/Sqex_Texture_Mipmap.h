@@ -50,6 +50,9 @@ namespace Sqex::Texture {
 
 		static std::shared_ptr<MemoryBackedMipmap> NewARGB8888From(const MipmapStream* stream, Format type = Format::RGBA_1);
 
+		// Encodes RGBA8888 pixels into RGBA4444, RGBA5551, RGBA8888 or one of the DXT formats.
+		static std::shared_ptr<MemoryBackedMipmap> NewFromARGB8888(uint16_t width, uint16_t height, std::span<const RGBA8888> pixels, Format type, DxtEncodeQuality quality = DxtEncodeQuality::High);
+
 		[[nodiscard]] uint64_t StreamSize() const override { return static_cast<uint32_t>(m_data.size());  }
 		uint64_t ReadStreamPartial(uint64_t offset, void* buf, uint64_t length) const override;
 
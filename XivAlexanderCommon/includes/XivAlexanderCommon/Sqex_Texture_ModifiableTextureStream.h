@@ -9,11 +9,21 @@ namespace Sqex::Texture {
 		std::vector<std::shared_ptr<MemoryBackedMipmap>> m_mipmaps;
 		std::vector<uint32_t> m_mipmapOffsets;
 
+		void UpdateMipmapOffsets();
+		void AppendHalvedMipmaps(std::vector<RGBA8888> pixels, size_t width, size_t height, MipmapFilter filter, size_t maxCount, DxtEncodeQuality quality);
+
 	public:
 		ModifiableTextureStream(Format type, uint16_t width, uint16_t height, uint16_t depth = 1);
 		~ModifiableTextureStream() override;
 
 		void AppendMipmap(std::shared_ptr<MemoryBackedMipmap> mipmap);
+
+		// Appends source as the next mipmap, followed by successively halved copies of it until either side would become zero,
+		// up to maxCount mipmaps in total. Each mipmap is encoded in the type of this texture.
+		void AppendMipmapChain(const MipmapStream& source, MipmapFilter filter = MipmapFilter::Box, size_t maxCount = SIZE_MAX, DxtEncodeQuality quality = DxtEncodeQuality::High);
+
+		// Replaces all mipmaps but the first with ones generated from it, as with AppendMipmapChain.
+		void GenerateMipmaps(MipmapFilter filter = MipmapFilter::Box, size_t maxCount = SIZE_MAX, DxtEncodeQuality quality = DxtEncodeQuality::High);
 		void TruncateMipmap(size_t count);
 
 		[[nodiscard]] uint64_t StreamSize() const override;
@@ -25,4 +25,8 @@ namespace Utils::Win32 {
 		void WaitOutstanding();
 		void Cancel();
 	};
+
+	// Calls fn(i) for every i in [0, count) using the calling thread and the process default thread pool, and returns once all calls are done.
+	// The first exception thrown from fn is rethrown after all calls are done.
+	void ParallelFor(size_t count, const std::function<void(size_t)>& fn);
 }
\ No newline at end of file
@@ -7,4 +7,18 @@ namespace Utils {
 	void BlockDecompressImageDXT1(uint32_t width, uint32_t height, const uint8_t* blockStorage, uint32_t* image);
 	void DecompressBlockDXT5(uint32_t x, uint32_t y, uint32_t width, const uint8_t* blockStorage, uint32_t* image);
 	void BlockDecompressImageDXT5(uint32_t width, uint32_t height, const uint8_t* blockStorage, uint32_t* image);
+
+	enum class DxtDecoderInstructionSet {
+		Scalar,
+		Sse41,
+		Avx2,
+	};
+
+	[[nodiscard]] DxtDecoderInstructionSet DxtDecoderBestInstructionSet();
+
+	// Decodes a row of blocks into the top "rows" (up to 4) rows of pixels at image, which is "width" pixels wide.
+	// Results are identical to decoding each block with DecompressBlockDXT1 or DecompressBlockDXT5.
+	void DecompressBlockRowDXT1(uint32_t width, uint32_t rows, const uint8_t* blockStorage, uint32_t* image, DxtDecoderInstructionSet instructionSet = DxtDecoderBestInstructionSet());
+	void DecompressBlockRowDXT3(uint32_t width, uint32_t rows, const uint8_t* blockStorage, uint32_t* image, DxtDecoderInstructionSet instructionSet = DxtDecoderBestInstructionSet());
+	void DecompressBlockRowDXT5(uint32_t width, uint32_t rows, const uint8_t* blockStorage, uint32_t* image, DxtDecoderInstructionSet instructionSet = DxtDecoderBestInstructionSet());
 }
@@ -4,7 +4,26 @@
 #include <vector>
 #include <zlib.h>
 
+struct libdeflate_compressor;
+struct libdeflate_decompressor;
+
 namespace Utils {
+	enum class DeflateBackend {
+		// zlib, or zlib-ng if it is built in zlib compatible mode in place of zlib.
+		Zlib,
+
+		// libdeflate, for raw deflate streams (windowBits of -15) handled as a whole buffer.
+		// Anything it does not handle, including data it fails to decode, is left to zlib.
+		Libdeflate,
+	};
+
+	// Whether the backend has been compiled in.
+	[[nodiscard]] bool IsDeflateBackendAvailable(DeflateBackend backend);
+
+	// Defaults to libdeflate if it has been compiled in. Takes effect on the next operation of every inflater and deflater.
+	[[nodiscard]] DeflateBackend GetDeflateBackend();
+	void SetDeflateBackend(DeflateBackend backend);
+
 	class ZlibError : public std::runtime_error {
 	public:
 		static std::string DescribeReturnCode(int code);
@@ -17,8 +36,10 @@ namespace Utils {
 		z_stream m_zstream{};
 		bool m_initialized = false;
 		std::vector<uint8_t> m_buffer;
+		libdeflate_decompressor* m_libdeflate = nullptr;
 
 		void Initialize();
+		[[nodiscard]] libdeflate_decompressor* Libdeflate();
 
 	public:
 		explicit ZlibReusableInflater(int windowBits = 15, int defaultBufferSize = 16384);
@@ -42,8 +63,10 @@ namespace Utils {
 		z_stream m_zstream{};
 		bool m_initialized = false;
 		std::vector<uint8_t> m_buffer;
+		libdeflate_compressor* m_libdeflate = nullptr;
 
 		void Initialize();
+		[[nodiscard]] libdeflate_compressor* Libdeflate();
 
 	public:
 		explicit ZlibReusableDeflater(